@@ -0,0 +1,137 @@
+#include "FrameUniforms.hpp"
+#include "GLStateCache.hpp"
+#include <algorithm>
+using namespace RichWerks;
+
+namespace {
+    GLsizeiptr alignUp(GLsizeiptr t_value, GLsizeiptr t_alignment) {
+        return (t_value + t_alignment - 1) / t_alignment * t_alignment;
+    }
+}
+
+glm::mat4 FrameUniforms::NormalMatrix(const glm::mat4& t_model) {
+    return glm::mat4(glm::transpose(glm::inverse(glm::mat3(t_model))));
+}
+
+FrameUniforms::FrameUniforms(GLuint t_objectCapacity)
+    : objectCapacity(std::max(t_objectCapacity, 1u)) {
+}
+
+FrameUniforms::~FrameUniforms() {
+    release();
+}
+
+void FrameUniforms::Begin(const Camera& t_camera, const glm::mat4& t_projection, GLint t_numLights, const glm::ivec4& t_viewport) {
+    if (buffer == 0) {
+        allocate(objectCapacity);
+    }
+    part = (part + 1) % FRAMES_IN_FLIGHT;
+    if (fences[part] != nullptr) {
+        while (glClientWaitSync(fences[part], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+        }
+        glDeleteSync(fences[part]);
+        fences[part] = nullptr;
+    }
+
+    frameData.view = t_camera.GetViewMatrix();
+    frameData.projection = t_projection;
+    frameData.viewProjection = t_projection * frameData.view;
+    frameData.cameraPosition = t_camera.Position;
+    frameData.numLights = t_numLights;
+    frameData.viewportSize = glm::vec2(t_viewport.z, t_viewport.w);
+    objectCount = 0;
+    bindFrame();
+}
+
+GLint FrameUniforms::AddObject(const glm::mat4& t_model, const glm::mat4& t_normalMatrix) {
+    if (objectCount == objectCapacity) {
+        grow();
+    }
+    ObjectData* object = reinterpret_cast<ObjectData*>(mapped + part * partSize + objectsOffset) + objectCount;
+    object->model = t_model;
+    object->modelViewProjection = frameData.viewProjection * t_model;
+    object->normalMatrix = t_normalMatrix;
+    return static_cast<GLint>(objectCount++);
+}
+
+void FrameUniforms::End() {
+    if (buffer != 0) {
+        fences[part] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+const FrameData& FrameUniforms::GetFrameData() const {
+    return frameData;
+}
+
+GLuint FrameUniforms::GetObjectCount() const {
+    return objectCount;
+}
+
+GLuint FrameUniforms::GetObjectCapacity() const {
+    return objectCapacity;
+}
+
+// Create the buffer with room for t_objectCapacity objects per frame, replacing any old one
+void FrameUniforms::allocate(GLuint t_objectCapacity) {
+    release();
+    GLint uniformAlignment = 256;
+    GLint storageAlignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+    const GLsizeiptr alignment = std::max(uniformAlignment, storageAlignment);
+
+    objectCapacity = t_objectCapacity;
+    objectsOffset = alignUp(sizeof(FrameData), alignment);
+    partSize = alignUp(objectsOffset + static_cast<GLsizeiptr>(objectCapacity) * sizeof(ObjectData), alignment);
+    part = 0;
+
+    const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    GLStateCache::Current().BindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferStorage(GL_UNIFORM_BUFFER, partSize * FRAMES_IN_FLIGHT, nullptr, mapFlags);
+    mapped = static_cast<GLubyte*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, partSize * FRAMES_IN_FLIGHT, mapFlags));
+}
+
+// Move to a buffer with twice the room. Draws already issued keep reading the old buffer, which
+// GL frees once they are done; the objects written so far are copied for draws not issued yet
+// (IndirectRenderer adds every object before its one draw).
+void FrameUniforms::grow() {
+    const GLuint oldBuffer = buffer;
+    const GLintptr oldObjects = part * partSize + objectsOffset;
+    buffer = 0;
+    allocate(objectCapacity * 2);
+
+    GLStateCache& state = GLStateCache::Current();
+    state.BindBuffer(GL_COPY_READ_BUFFER, oldBuffer);
+    state.BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, oldObjects, part * partSize + objectsOffset,
+        static_cast<GLsizeiptr>(objectCount) * sizeof(ObjectData));
+    state.DeleteBuffers(1, &oldBuffer);
+    bindFrame();
+}
+
+// Deleting the buffer also unmaps it
+void FrameUniforms::release() {
+    for (GLsync& fence : fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (buffer != 0) {
+        GLStateCache::Current().DeleteBuffers(1, &buffer);
+        buffer = 0;
+        mapped = nullptr;
+    }
+}
+
+// Write the frame block into this frame's part and point both bindings at the part
+void FrameUniforms::bindFrame() {
+    const GLintptr partOffset = part * partSize;
+    *reinterpret_cast<FrameData*>(mapped + partOffset) = frameData;
+    GLStateCache& state = GLStateCache::Current();
+    state.BindBufferRange(GL_UNIFORM_BUFFER, FRAME_BINDING, buffer, partOffset, sizeof(FrameData));
+    state.BindBufferRange(GL_SHADER_STORAGE_BUFFER, OBJECT_BINDING, buffer, partOffset + objectsOffset,
+        static_cast<GLsizeiptr>(objectCapacity) * sizeof(ObjectData));
+}
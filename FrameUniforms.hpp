@@ -0,0 +1,101 @@
+/*
+ * File:          FrameUniforms.hpp
+ * Description:   Shader inputs shared by every draw of a frame, written once instead of
+ *                being uploaded as uniforms by each prop. The FrameData uniform block holds
+ *                the camera (view, projection, their product, position), the light count
+ *                and the viewport size. The ObjectBuffer storage block holds one entry per
+ *                object drawn this frame: its model, model-view-projection and normal
+ *                matrices, so the vertex shaders neither multiply the camera in nor invert
+ *                anything. A draw only sets objectIndex, the entry it reads.
+ *
+ *                Both live in one persistently mapped buffer split into FRAMES_IN_FLIGHT
+ *                parts used in turn, each fenced when its frame ends, so writing a frame
+ *                never stalls on the GPU reading an earlier one. The object part grows
+ *                (into a new buffer, keeping the frame's objects) when a frame draws more
+ *                objects than it holds.
+ */
+
+#ifndef __OPEN_GL_LIBRARY__
+#define __OPEN_GL_LIBRARY__
+
+#include <GL/glew.h>               // GLEW library
+#include <GLFW/glfw3.h>            // GLFW library
+#include <glm/glm.hpp>             // glm library
+#include <glm/gtx/transform.hpp>   // glm library
+#include <glm/gtc/type_ptr.hpp>    // glm library
+
+#endif
+
+#include <learnOpengl/camera.h>
+
+#ifndef _FrameUniforms_
+#define _FrameUniforms_
+
+#pragma once
+namespace RichWerks {
+    // std140 layout of the FrameData uniform block in the shaders.
+    struct FrameData {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::mat4 viewProjection;
+        glm::vec3 cameraPosition;
+        GLint numLights;
+        glm::vec2 viewportSize;     // Pixels
+        glm::vec2 padding;
+    };
+
+    // std430 layout of an ObjectData entry of the ObjectBuffer storage block in the shaders.
+    struct ObjectData {
+        glm::mat4 model;
+        glm::mat4 modelViewProjection;
+        glm::mat4 normalMatrix;     // Inverse transpose of the model's upper 3x3, as a mat4 for alignment
+    };
+
+    class FrameUniforms
+    {
+    public:
+        static constexpr GLuint FRAME_BINDING = 0;      // Uniform buffer binding of FrameData
+        static constexpr GLuint OBJECT_BINDING = 2;     // Storage binding of ObjectBuffer (0: lights, 1: instances)
+        static constexpr GLuint FRAMES_IN_FLIGHT = 3;
+
+        // Inverse transpose of the upper 3x3, for transforming normals; compute it when the model changes.
+        static glm::mat4 NormalMatrix(const glm::mat4& t_model);
+
+        // The buffer is created on the first Begin, so this can run before the context exists.
+        explicit FrameUniforms(GLuint t_objectCapacity = 256);
+        FrameUniforms(const FrameUniforms&) = delete;
+        FrameUniforms& operator=(const FrameUniforms&) = delete;
+        ~FrameUniforms();
+
+        // Write the frame block and bind this frame's part of the buffer. Waits only when the
+        // GPU is still reading the frame FRAMES_IN_FLIGHT ago.
+        void Begin(const Camera& t_camera, const glm::mat4& t_projection, GLint t_numLights, const glm::ivec4& t_viewport);
+        // Write an object's matrices for this frame and return the objectIndex the shaders read them at.
+        GLint AddObject(const glm::mat4& t_model, const glm::mat4& t_normalMatrix);
+        // Fence this frame's part so it is not written again before the GPU is done with it.
+        void End();
+
+        const FrameData& GetFrameData() const;
+        // Objects written since Begin, and how many fit before the buffer grows.
+        GLuint GetObjectCount() const;
+        GLuint GetObjectCapacity() const;
+
+    protected:
+        void allocate(GLuint t_objectCapacity);
+        void grow();
+        void release();
+        void bindFrame();
+
+        FrameData frameData;
+        GLuint objectCapacity;
+        GLuint objectCount = 0;
+        GLuint buffer = 0;
+        GLubyte* mapped = nullptr;
+        GLsizeiptr objectsOffset = 0;   // Start of the objects within a frame's part
+        GLsizeiptr partSize = 0;        // Bytes per frame, a multiple of the binding offset alignments
+        GLuint part = 0;                // Part written this frame
+        GLsync fences[FRAMES_IN_FLIGHT] = {};
+    };
+
+}
+#endif // !_FrameUniforms_
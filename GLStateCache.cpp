@@ -0,0 +1,331 @@
+#include "GLStateCache.hpp"
+#include <algorithm>
+using namespace RichWerks;
+
+GLStateCounter GLStateCounters::Total() const {
+    GLStateCounter total;
+    for (const GLStateCounter* counter : { &program, &vertexArray, &texture, &buffer, &framebuffer, &capability }) {
+        total.issued += counter->issued;
+        total.filtered += counter->filtered;
+    }
+    return total;
+}
+
+// Never destroyed: globals that own GL objects (props, batches) release them through the
+// cache from their own destructors, which may run after a function-local static's.
+GLStateCache& GLStateCache::Current() {
+    static GLStateCache* cache = new GLStateCache();
+    return *cache;
+}
+
+GLStateCache::GLStateCache() {
+    Invalidate();
+}
+
+void GLStateCache::UseProgram(GLuint t_program) {
+    if (count(frameCounters.program, program == t_program)) {
+        return;
+    }
+    glUseProgram(t_program);
+    program = t_program;
+}
+
+void GLStateCache::BindVertexArray(GLuint t_vao) {
+    if (count(frameCounters.vertexArray, vertexArray == t_vao)) {
+        return;
+    }
+    glBindVertexArray(t_vao);
+    vertexArray = t_vao;
+}
+
+void GLStateCache::BindTexture(GLuint t_unit, GLenum t_target, GLuint t_texture) {
+    const int target = textureTargetIndex(t_target);
+    if (t_unit >= TEXTURE_UNITS || target < 0) {
+        activeTexture(t_unit);
+        count(frameCounters.texture, false);
+        glBindTexture(t_target, t_texture);
+        return;
+    }
+    if (count(frameCounters.texture, textures[t_unit][target] == t_texture)) {
+        return;
+    }
+    activeTexture(t_unit);
+    glBindTexture(t_target, t_texture);
+    textures[t_unit][target] = t_texture;
+}
+
+void GLStateCache::BindBuffer(GLenum t_target, GLuint t_buffer) {
+    if (t_target == GL_ELEMENT_ARRAY_BUFFER) {
+        // Without a known vertex array there is nothing to attach the binding to.
+        if (vertexArray == UNKNOWN) {
+            count(frameCounters.buffer, false);
+            glBindBuffer(t_target, t_buffer);
+            return;
+        }
+        const auto bound = elementBuffers.find(vertexArray);
+        if (count(frameCounters.buffer, bound != elementBuffers.end() && bound->second == t_buffer)) {
+            return;
+        }
+        glBindBuffer(t_target, t_buffer);
+        elementBuffers[vertexArray] = t_buffer;
+        return;
+    }
+    const auto bound = buffers.find(t_target);
+    if (count(frameCounters.buffer, bound != buffers.end() && bound->second == t_buffer)) {
+        return;
+    }
+    glBindBuffer(t_target, t_buffer);
+    buffers[t_target] = t_buffer;
+}
+
+void GLStateCache::BindBufferBase(GLenum t_target, GLuint t_index, GLuint t_buffer) {
+    IndexedBinding binding;
+    binding.buffer = t_buffer;
+    bindIndexed(t_target, t_index, binding);
+}
+
+void GLStateCache::BindBufferRange(GLenum t_target, GLuint t_index, GLuint t_buffer, GLintptr t_offset, GLsizeiptr t_size) {
+    IndexedBinding binding;
+    binding.buffer = t_buffer;
+    binding.offset = t_offset;
+    binding.size = t_size;
+    bindIndexed(t_target, t_index, binding);
+}
+
+void GLStateCache::BindFramebuffer(GLenum t_target, GLuint t_framebuffer) {
+    const bool read = t_target != GL_DRAW_FRAMEBUFFER;
+    const bool draw = t_target != GL_READ_FRAMEBUFFER;
+    if (count(frameCounters.framebuffer, (!read || readFramebuffer == t_framebuffer) && (!draw || drawFramebuffer == t_framebuffer))) {
+        return;
+    }
+    glBindFramebuffer(t_target, t_framebuffer);
+    if (read) {
+        readFramebuffer = t_framebuffer;
+    }
+    if (draw) {
+        drawFramebuffer = t_framebuffer;
+    }
+}
+
+GLuint GLStateCache::GetFramebuffer(GLenum t_target) const {
+    const GLuint framebuffer = t_target == GL_READ_FRAMEBUFFER ? readFramebuffer : drawFramebuffer;
+    return framebuffer == UNKNOWN ? 0 : framebuffer;
+}
+
+void GLStateCache::Enable(GLenum t_capability) {
+    const auto state = capabilities.find(t_capability);
+    if (count(frameCounters.capability, state != capabilities.end() && state->second)) {
+        return;
+    }
+    glEnable(t_capability);
+    capabilities[t_capability] = true;
+}
+
+void GLStateCache::Disable(GLenum t_capability) {
+    const auto state = capabilities.find(t_capability);
+    if (count(frameCounters.capability, state != capabilities.end() && !state->second)) {
+        return;
+    }
+    glDisable(t_capability);
+    capabilities[t_capability] = false;
+}
+
+void GLStateCache::Viewport(GLint t_x, GLint t_y, GLsizei t_width, GLsizei t_height) {
+    const glm::ivec4 requested(t_x, t_y, t_width, t_height);
+    if (count(frameCounters.capability, viewport == requested)) {
+        return;
+    }
+    glViewport(t_x, t_y, t_width, t_height);
+    viewport = requested;
+}
+
+const glm::ivec4& GLStateCache::GetViewport() const {
+    return viewport;
+}
+
+// GL rebinds 0 in place of a deleted vertex array that is bound
+void GLStateCache::DeleteVertexArrays(GLsizei t_count, const GLuint* t_vaos) {
+    glDeleteVertexArrays(t_count, t_vaos);
+    for (GLsizei i = 0; i < t_count; ++i) {
+        if (t_vaos[i] == 0) {
+            continue;
+        }
+        elementBuffers.erase(t_vaos[i]);
+        if (vertexArray == t_vaos[i]) {
+            vertexArray = 0;
+        }
+    }
+}
+
+// GL resets every binding of a deleted buffer in the context, except inside vertex arrays that
+// are not bound; those keep the old object, so their cached index buffer is forgotten. Some
+// drivers reset an indexed binding by binding 0 to the whole target, which also changes the
+// generic binding, and the buffer may sit at a binding point the cache does not know about, so
+// the generic uniform and shader storage bindings are forgotten on every delete.
+void GLStateCache::DeleteBuffers(GLsizei t_count, const GLuint* t_buffers) {
+    glDeleteBuffers(t_count, t_buffers);
+    for (GLsizei i = 0; i < t_count; ++i) {
+        const GLuint buffer = t_buffers[i];
+        if (buffer == 0) {
+            continue;
+        }
+        for (auto& binding : buffers) {
+            if (binding.second == buffer) {
+                binding.second = 0;
+            }
+        }
+        for (auto binding = elementBuffers.begin(); binding != elementBuffers.end();) {
+            if (binding->second != buffer) {
+                ++binding;
+            }
+            else if (binding->first == vertexArray) {
+                binding->second = 0;
+                ++binding;
+            }
+            else {
+                binding = elementBuffers.erase(binding);
+            }
+        }
+        for (GLuint index = 0; index < INDEXED_BINDINGS; ++index) {
+            for (IndexedBinding* binding : { &uniformBuffers[index], &storageBuffers[index] }) {
+                if (binding->buffer == buffer) {
+                    *binding = IndexedBinding();
+                    binding->buffer = 0;
+                }
+            }
+        }
+    }
+    buffers.erase(GL_UNIFORM_BUFFER);
+    buffers.erase(GL_SHADER_STORAGE_BUFFER);
+}
+
+// GL binds texture 0 in place of a deleted texture on every unit
+void GLStateCache::DeleteTextures(GLsizei t_count, const GLuint* t_textures) {
+    glDeleteTextures(t_count, t_textures);
+    for (GLsizei i = 0; i < t_count; ++i) {
+        if (t_textures[i] == 0) {
+            continue;
+        }
+        for (GLuint unit = 0; unit < TEXTURE_UNITS; ++unit) {
+            std::replace(textures[unit], textures[unit] + TEXTURE_TARGETS, t_textures[i], 0u);
+        }
+    }
+}
+
+// GL binds the default framebuffer in place of a deleted framebuffer that is bound
+void GLStateCache::DeleteFramebuffers(GLsizei t_count, const GLuint* t_framebuffers) {
+    glDeleteFramebuffers(t_count, t_framebuffers);
+    for (GLsizei i = 0; i < t_count; ++i) {
+        if (t_framebuffers[i] == 0) {
+            continue;
+        }
+        if (readFramebuffer == t_framebuffers[i]) {
+            readFramebuffer = 0;
+        }
+        if (drawFramebuffer == t_framebuffers[i]) {
+            drawFramebuffer = 0;
+        }
+    }
+}
+
+// A program in use is only flagged for deletion, so its name must not be trusted afterwards:
+// a new program may get the same name while the old one is still the one in use.
+void GLStateCache::DeleteProgram(GLuint t_program) {
+    glDeleteProgram(t_program);
+    if (program == t_program) {
+        program = UNKNOWN;
+    }
+}
+
+void GLStateCache::Invalidate() {
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeUnit = UNKNOWN;
+    for (GLuint unit = 0; unit < TEXTURE_UNITS; ++unit) {
+        std::fill(textures[unit], textures[unit] + TEXTURE_TARGETS, UNKNOWN);
+    }
+    buffers.clear();
+    elementBuffers.clear();
+    readFramebuffer = UNKNOWN;
+    drawFramebuffer = UNKNOWN;
+    std::fill(uniformBuffers, uniformBuffers + INDEXED_BINDINGS, IndexedBinding());
+    std::fill(storageBuffers, storageBuffers + INDEXED_BINDINGS, IndexedBinding());
+    capabilities.clear();
+    viewport = glm::ivec4(-1);
+}
+
+void GLStateCache::EndFrame() {
+    lastFrameCounters = frameCounters;
+    frameCounters = GLStateCounters();
+}
+
+const GLStateCounters& GLStateCache::GetFrameCounters() const {
+    return lastFrameCounters;
+}
+
+int GLStateCache::textureTargetIndex(GLenum t_target) {
+    switch (t_target) {
+    case GL_TEXTURE_2D:
+        return 0;
+    case GL_TEXTURE_CUBE_MAP:
+        return 1;
+    case GL_TEXTURE_2D_ARRAY:
+        return 2;
+    case GL_TEXTURE_3D:
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+// Count a call as filtered or issued and return whether it was redundant
+bool GLStateCache::count(GLStateCounter& t_counter, bool t_redundant) {
+    if (t_redundant) {
+        ++t_counter.filtered;
+    }
+    else {
+        ++t_counter.issued;
+    }
+    return t_redundant;
+}
+
+void GLStateCache::activeTexture(GLuint t_unit) {
+    if (activeUnit == t_unit) {
+        return;
+    }
+    count(frameCounters.texture, false);
+    glActiveTexture(GL_TEXTURE0 + t_unit);
+    activeUnit = t_unit;
+}
+
+GLStateCache::IndexedBinding* GLStateCache::indexedBinding(GLenum t_target, GLuint t_index) {
+    if (t_index >= INDEXED_BINDINGS) {
+        return nullptr;
+    }
+    if (t_target == GL_UNIFORM_BUFFER) {
+        return &uniformBuffers[t_index];
+    }
+    if (t_target == GL_SHADER_STORAGE_BUFFER) {
+        return &storageBuffers[t_index];
+    }
+    return nullptr;
+}
+
+void GLStateCache::bindIndexed(GLenum t_target, GLuint t_index, const IndexedBinding& t_binding) {
+    IndexedBinding* binding = indexedBinding(t_target, t_index);
+    const bool redundant = binding != nullptr && binding->buffer == t_binding.buffer
+        && binding->offset == t_binding.offset && binding->size == t_binding.size;
+    if (count(frameCounters.buffer, redundant)) {
+        return;
+    }
+    if (t_binding.size == 0) {
+        glBindBufferBase(t_target, t_index, t_binding.buffer);
+    }
+    else {
+        glBindBufferRange(t_target, t_index, t_binding.buffer, t_binding.offset, t_binding.size);
+    }
+    if (binding != nullptr) {
+        *binding = t_binding;
+    }
+    buffers[t_target] = t_binding.buffer;
+}
@@ -0,0 +1,129 @@
+/*
+ * File:          GLStateCache.hpp
+ * Description:   Shadow copy of the OpenGL binding state the renderer touches: program,
+ *                vertex array, textures per unit, buffer bindings (generic and indexed),
+ *                framebuffers, capability flags and the viewport. Every bind goes through it, so a call
+ *                that would not change anything is dropped before it reaches the driver,
+ *                and code that needs the current state reads the shadow instead of making
+ *                a synchronous glGet. State starts unknown, so the first call of each kind
+ *                is always issued. Counters of issued and dropped calls are kept per frame.
+ */
+
+#ifndef __OPEN_GL_LIBRARY__
+#define __OPEN_GL_LIBRARY__
+
+#include <GL/glew.h>               // GLEW library
+#include <GLFW/glfw3.h>            // GLFW library
+#include <glm/glm.hpp>             // glm library
+#include <glm/gtx/transform.hpp>   // glm library
+#include <glm/gtc/type_ptr.hpp>    // glm library
+
+#endif
+
+#include <unordered_map>
+
+#ifndef _GLStateCache_
+#define _GLStateCache_
+
+#pragma once
+namespace RichWerks {
+    struct GLStateCounter {
+        unsigned int issued = 0;        // Calls passed on to GL
+        unsigned int filtered = 0;      // Redundant calls dropped
+    };
+
+    struct GLStateCounters {
+        GLStateCounter program;
+        GLStateCounter vertexArray;
+        GLStateCounter texture;         // Includes the glActiveTexture calls a bind needs
+        GLStateCounter buffer;
+        GLStateCounter framebuffer;
+        GLStateCounter capability;      // Enable flags and the viewport
+
+        GLStateCounter Total() const;
+    };
+
+    class GLStateCache
+    {
+    public:
+        static constexpr GLuint TEXTURE_UNITS = 16;
+        static constexpr GLuint INDEXED_BINDINGS = 16;  // Uniform and shader storage binding points tracked
+
+        // The cache of the application's one context.
+        static GLStateCache& Current();
+
+        GLStateCache();
+        GLStateCache(const GLStateCache&) = delete;
+        GLStateCache& operator=(const GLStateCache&) = delete;
+
+        void UseProgram(GLuint t_program);
+        void BindVertexArray(GLuint t_vao);
+        // Bind a texture to a unit, switching the active unit only when needed. 2D, cube map,
+        // 2D array and 3D targets are tracked; other targets are always issued.
+        void BindTexture(GLuint t_unit, GLenum t_target, GLuint t_texture);
+        // GL_ELEMENT_ARRAY_BUFFER is tracked per vertex array, since it is part of its state.
+        void BindBuffer(GLenum t_target, GLuint t_buffer);
+        // Both also set the generic binding of the target, like the GL calls do.
+        void BindBufferBase(GLenum t_target, GLuint t_index, GLuint t_buffer);
+        void BindBufferRange(GLenum t_target, GLuint t_index, GLuint t_buffer, GLintptr t_offset, GLsizeiptr t_size);
+        // GL_FRAMEBUFFER binds both the read and the draw framebuffer, like glBindFramebuffer.
+        void BindFramebuffer(GLenum t_target, GLuint t_framebuffer);
+        // Last read or draw framebuffer bound through the cache; 0, the default framebuffer, until then.
+        GLuint GetFramebuffer(GLenum t_target) const;
+        void Enable(GLenum t_capability);
+        void Disable(GLenum t_capability);
+        void Viewport(GLint t_x, GLint t_y, GLsizei t_width, GLsizei t_height);
+        // Last viewport set through the cache (x, y, width, height), without glGetIntegerv.
+        const glm::ivec4& GetViewport() const;
+
+        // Deleting through the cache drops the bindings GL itself resets, so a recycled name is
+        // never mistaken for one that is still bound.
+        void DeleteVertexArrays(GLsizei t_count, const GLuint* t_vaos);
+        void DeleteBuffers(GLsizei t_count, const GLuint* t_buffers);
+        void DeleteTextures(GLsizei t_count, const GLuint* t_textures);
+        void DeleteFramebuffers(GLsizei t_count, const GLuint* t_framebuffers);
+        void DeleteProgram(GLuint t_program);
+
+        // Forget everything, after code that changed tracked state without the cache.
+        void Invalidate();
+
+        // Close the frame's counters; GetFrameCounters then returns them until the next EndFrame.
+        void EndFrame();
+        const GLStateCounters& GetFrameCounters() const;
+
+    protected:
+        static constexpr GLuint UNKNOWN = 0xFFFFFFFF;
+        static constexpr int TEXTURE_TARGETS = 4;
+
+        // What is bound at an indexed binding point; a size of 0 is the whole buffer.
+        struct IndexedBinding {
+            GLuint buffer = UNKNOWN;
+            GLintptr offset = 0;
+            GLsizeiptr size = 0;
+        };
+
+        static int textureTargetIndex(GLenum t_target);
+        static bool count(GLStateCounter& t_counter, bool t_redundant);
+        void activeTexture(GLuint t_unit);
+        IndexedBinding* indexedBinding(GLenum t_target, GLuint t_index);
+        void bindIndexed(GLenum t_target, GLuint t_index, const IndexedBinding& t_binding);
+
+        GLuint program;
+        GLuint vertexArray;
+        GLuint activeUnit;
+        GLuint textures[TEXTURE_UNITS][TEXTURE_TARGETS];
+        std::unordered_map<GLenum, GLuint> buffers;             // Generic binding per target
+        std::unordered_map<GLuint, GLuint> elementBuffers;      // Index buffer per vertex array
+        GLuint readFramebuffer;
+        GLuint drawFramebuffer;
+        IndexedBinding uniformBuffers[INDEXED_BINDINGS];
+        IndexedBinding storageBuffers[INDEXED_BINDINGS];
+        std::unordered_map<GLenum, bool> capabilities;
+        glm::ivec4 viewport;
+
+        GLStateCounters frameCounters;
+        GLStateCounters lastFrameCounters;
+    };
+
+}
+#endif // !_GLStateCache_
@@ -0,0 +1,260 @@
+#include "IndirectRenderer.hpp"
+#include "GLStateCache.hpp"
+#include "MeshGenerator.hpp"
+#include "MeshletBuilder.hpp"
+#include <algorithm>
+#include <cmath>
+using namespace RichWerks;
+
+// Check for multi-draw indirect and draw parameter support
+bool RichWerks::IndirectDrawSupported() {
+    return (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect) && (GLEW_VERSION_4_6 || GLEW_ARB_shader_draw_parameters);
+}
+
+IndirectRenderer::IndirectRenderer(Shader& t_shader)
+    : shader(&t_shader), texturesUniform(t_shader.getUniform<int>("textures")) {
+}
+
+IndirectRenderer::~IndirectRenderer() {
+    const GLuint buffers[] = { commandBuffer, drawBuffer, materialBuffer };
+    GLStateCache::Current().DeleteBuffers(3, buffers);
+    GLStateCache::Current().DeleteTextures(1, &textureArray);
+    GLStateCache::Current().DeleteFramebuffers(2, framebuffers);
+}
+
+void IndirectRenderer::Render(FrameUniforms& t_frame, std::vector<UGLProp>& t_props) {
+    const FrameData& frame = t_frame.GetFrameData();
+    commands.clear();
+    draws.clear();
+    reclaimArena();
+    for (UGLProp& prop : t_props) {
+        if (prop.IsProcedural()) {
+            continue;
+        }
+        const std::vector<std::shared_ptr<const Mesh>>& meshes = prop.SelectLOD(frame);
+        const std::vector<Material>& propMaterials = prop.GetMaterials();
+        DrawData draw;
+        draw.objectIndex = t_frame.AddObject(prop.GetModelMatrix(), prop.GetNormalMatrix());
+        draw.padding = 0;
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            const Mesh& mesh = *meshes[i];
+            if (!mesh.buffer || mesh.indexData.empty()) {
+                continue;   // Not bound yet, or nothing to draw
+            }
+            // Mesh i uses material i, or the last one, like UGLProp::Render.
+            const Material material = propMaterials.empty() ? Material() : propMaterials[std::min(i, propMaterials.size() - 1)];
+            draw.materialIndex = materialIndex(material);
+            draw.textureLayer = textureLayer(material);
+            const ArenaRange& range = arenaRange(mesh);
+            if (mesh.meshlets.empty()) {
+                addCommand(static_cast<GLuint>(mesh.indexData.size()), 0, range, draw);
+                continue;
+            }
+            // One command per visible run of meshlets, all reading the same DrawData.
+            drawCounts.clear();
+            drawFirstIndices.clear();
+            std::cullMeshlets(mesh, prop.GetModelMatrix(), frame.viewProjection, frame.cameraPosition, drawCounts, drawFirstIndices);
+            for (size_t run = 0; run < drawCounts.size(); ++run) {
+                addCommand(static_cast<GLuint>(drawCounts[run]), drawFirstIndices[run], range, draw);
+            }
+        }
+    }
+
+    callCount = 0;
+    if (!commands.empty()) {
+        GLStateCache& state = GLStateCache::Current();
+        if (arenaDirty) {
+            // One FLOAT32 layout for every mesh: compact meshes are drawn from their float source data.
+            arena.vertexFormat = VertexFormat::FLOAT32;
+            UploadMesh(arena);
+            arenaDirty = false;
+        }
+        if (materialsDirty) {
+            upload(GL_SHADER_STORAGE_BUFFER, materialBuffer, materials.data(), materials.size() * sizeof(MaterialData));
+            materialsDirty = false;
+        }
+        if (texturesDirty) {
+            buildTextureArray();
+            texturesDirty = false;
+        }
+        upload(GL_SHADER_STORAGE_BUFFER, drawBuffer, draws.data(), draws.size() * sizeof(DrawData));
+        upload(GL_DRAW_INDIRECT_BUFFER, commandBuffer, commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand));
+
+        state.UseProgram(shader->ID);
+        shader->set(texturesUniform, 0);
+        state.BindVertexArray(arena.buffer->vao);
+        state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_BINDING, drawBuffer);
+        state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_BINDING, materialBuffer);
+        state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        state.BindTexture(0, GL_TEXTURE_2D_ARRAY, textureArray);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, arena.buffer->indexType, nullptr, static_cast<GLsizei>(commands.size()), 0);
+        callCount = 1;
+    }
+
+    for (UGLProp& prop : t_props) {
+        if (prop.IsProcedural()) {
+            prop.Render(t_frame);
+        }
+    }
+}
+
+GLuint IndirectRenderer::GetCommandCount() const {
+    return static_cast<GLuint>(commands.size());
+}
+
+GLuint IndirectRenderer::GetCallCount() const {
+    return callCount;
+}
+
+// Drop the ranges of mesh buffers that no longer exist. Their data stays in the arena until more
+// than half of its vertices are dead; then the arena is rebuilt from the live ranges alone.
+void IndirectRenderer::reclaimArena() {
+    for (auto it = ranges.begin(); it != ranges.end();) {
+        if (it->second.source.expired()) {
+            deadVertices += it->second.vertexCount;
+            it = ranges.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    const size_t arenaVertices = arena.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+    if (deadVertices * 2 <= arenaVertices) {
+        return;
+    }
+    // Indices are relative to their mesh, so they move unchanged.
+    std::vector<GLfloat> vertexData;
+    std::vector<GLuint> indexData;
+    vertexData.reserve((arenaVertices - deadVertices) * RichWerks::FLOATS_PER_MESH_VERTEX);
+    for (auto& entry : ranges) {
+        ArenaRange& range = entry.second;
+        const auto vertices = arena.vertexData.begin() + static_cast<size_t>(range.baseVertex) * RichWerks::FLOATS_PER_MESH_VERTEX;
+        const auto indices = arena.indexData.begin() + range.firstIndex;
+        range.firstIndex = static_cast<GLuint>(indexData.size());
+        range.baseVertex = static_cast<GLint>(vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX);
+        vertexData.insert(vertexData.end(), vertices, vertices + static_cast<size_t>(range.vertexCount) * RichWerks::FLOATS_PER_MESH_VERTEX);
+        indexData.insert(indexData.end(), indices, indices + range.indexCount);
+    }
+    arena.vertexData.swap(vertexData);
+    arena.indexData.swap(indexData);
+    deadVertices = 0;
+    arenaDirty = true;
+}
+
+// Find a mesh in the arena, appending it the first time it is seen. Meshes are keyed by their
+// buffer, so meshes shared through a MeshCache are stored once.
+const IndirectRenderer::ArenaRange& IndirectRenderer::arenaRange(const Mesh& t_mesh) {
+    ArenaRange& range = ranges[t_mesh.buffer.get()];
+    if (!range.source.expired()) {
+        return range;
+    }
+    deadVertices += range.vertexCount;  // A buffer that died at this address since reclaimArena
+    range.source = t_mesh.buffer;
+    range.firstIndex = static_cast<GLuint>(arena.indexData.size());
+    range.baseVertex = static_cast<GLint>(arena.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX);
+    range.indexCount = static_cast<GLuint>(t_mesh.indexData.size());
+    range.vertexCount = static_cast<GLuint>(t_mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX);
+    arena.vertexData.insert(arena.vertexData.end(), t_mesh.vertexData.begin(), t_mesh.vertexData.end());
+    arena.indexData.insert(arena.indexData.end(), t_mesh.indexData.begin(), t_mesh.indexData.end());
+    arenaDirty = true;
+    return range;
+}
+
+// Index of a material in the MaterialBuffer, adding it if no entry matches
+GLint IndirectRenderer::materialIndex(const Material& t_material) {
+    for (size_t i = 0; i < materials.size(); ++i) {
+        if (materials[i].shininess == t_material.shininess && materials[i].emission == t_material.emission) {
+            return static_cast<GLint>(i);
+        }
+    }
+    MaterialData material;
+    material.emission = t_material.emission;
+    material.shininess = t_material.shininess;
+    materials.push_back(material);
+    materialsDirty = true;
+    return static_cast<GLint>(materials.size() - 1);
+}
+
+// Layer of a material's texture in the texture array, adding one the first time the texture is seen
+GLint IndirectRenderer::textureLayer(const Material& t_material) {
+    const GLuint texture = static_cast<GLuint>(t_material.texture);
+    const auto found = textureLayers.find(texture);
+    if (found != textureLayers.end()) {
+        return found->second;
+    }
+    const GLint layer = static_cast<GLint>(layerSources.size());
+    textureLayers.emplace(texture, layer);
+    LayerSource source;
+    source.texture = texture;
+    source.size = t_material.textureSize;
+    layerSources.push_back(source);
+    texturesDirty = true;
+    return layer;
+}
+
+// Rebuild the texture array with one layer per texture, each scaled to the largest texture size
+// (at most MAX_LAYER_SIZE) by a framebuffer blit. Texture 0, and a texture of unknown size,
+// becomes a black layer, which is what sampling no texture gives.
+void IndirectRenderer::buildTextureArray() {
+    GLStateCache& state = GLStateCache::Current();
+    GLint width = 1;
+    GLint height = 1;
+    for (const LayerSource& source : layerSources) {
+        width = std::max(width, std::min(source.size.x, MAX_LAYER_SIZE));
+        height = std::max(height, std::min(source.size.y, MAX_LAYER_SIZE));
+    }
+
+    // Storage is immutable, so a new layer count needs a new texture.
+    state.DeleteTextures(1, &textureArray);
+    glGenTextures(1, &textureArray);
+    state.BindTexture(0, GL_TEXTURE_2D_ARRAY, textureArray);
+    const GLsizei levels = 1 + static_cast<GLsizei>(std::floor(std::log2(static_cast<float>(std::max(width, height)))));
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, width, height, static_cast<GLsizei>(layerSources.size()));
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    const GLuint readFramebuffer = state.GetFramebuffer(GL_READ_FRAMEBUFFER);
+    const GLuint drawFramebuffer = state.GetFramebuffer(GL_DRAW_FRAMEBUFFER);
+    if (framebuffers[0] == 0) {
+        glGenFramebuffers(2, framebuffers);
+    }
+    state.BindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[0]);
+    state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers[1]);
+    const GLfloat black[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    for (size_t layer = 0; layer < layerSources.size(); ++layer) {
+        const LayerSource& source = layerSources[layer];
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, textureArray, 0, static_cast<GLint>(layer));
+        if (source.texture == 0 || source.size.x <= 0 || source.size.y <= 0) {
+            glClearBufferfv(GL_COLOR, 0, black);
+            continue;
+        }
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source.texture, 0);
+        glBlitFramebuffer(0, 0, source.size.x, source.size.y, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+    state.BindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+    state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+
+void IndirectRenderer::addCommand(GLuint t_count, GLuint t_firstIndex, const ArenaRange& t_range, const DrawData& t_draw) {
+    DrawElementsIndirectCommand command;
+    command.count = t_count;
+    command.instanceCount = 1;
+    command.firstIndex = t_range.firstIndex + t_firstIndex;
+    command.baseVertex = t_range.baseVertex;
+    command.baseInstance = 0;
+    commands.push_back(command);
+    draws.push_back(t_draw);
+}
+
+// Replace a buffer's contents, creating it on first use. Respecifying the whole store lets the
+// driver hand out fresh memory instead of waiting for last frame's draws.
+void IndirectRenderer::upload(GLenum t_target, GLuint& t_buffer, const void* t_data, GLsizeiptr t_size) {
+    if (t_buffer == 0) {
+        glGenBuffers(1, &t_buffer);
+    }
+    GLStateCache::Current().BindBuffer(t_target, t_buffer);
+    glBufferData(t_target, t_size, t_data, GL_STREAM_DRAW);
+}
@@ -0,0 +1,126 @@
+/*
+ * File:          IndirectRenderer.hpp
+ * Description:   Multi-draw indirect rendering of the props. Every mesh a prop draws is
+ *                copied once into a shared arena (one vertex and one index buffer), so
+ *                the whole prop list becomes one DrawElementsIndirectCommand per mesh (or
+ *                per visible meshlet range) and a single glMultiDrawElementsIndirect call.
+ *                Each command has a DrawData entry with its object (FrameUniforms), its
+ *                material and its texture layer; shaders/indirect_shader.* read it through
+ *                gl_DrawIDARB. Every texture the props use is copied into one layer of a
+ *                2D array texture, so the shader can pick a texture per draw; the copy
+ *                reads the texture's size from Material::textureSize. The CPU work
+ *                per prop is picking its LOD and writing a few structs, with no state
+ *                change or draw call, so the driver cost no longer grows with the prop count.
+ */
+
+#include "UGLProp.hpp"
+#include <unordered_map>
+
+#ifndef _IndirectRenderer_
+#define _IndirectRenderer_
+
+#pragma once
+namespace RichWerks {
+    // One command of glMultiDrawElementsIndirect, in the layout GL reads it.
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // std430 layout of a DrawData entry of the DrawBuffer storage block in the indirect shaders.
+    struct DrawData {
+        GLint objectIndex;      // FrameUniforms ObjectBuffer entry
+        GLint materialIndex;    // MaterialBuffer entry
+        GLint textureLayer;     // Layer of the textures array texture
+        GLint padding;
+    };
+
+    // std430 layout of a MaterialData entry of the MaterialBuffer storage block. Only what
+    // UGLProp::Render uploads per material is carried.
+    struct MaterialData {
+        glm::vec3 emission;
+        GLint shininess;
+    };
+
+    // Whether the context has glMultiDrawElementsIndirect (OpenGL 4.3) and gl_DrawIDARB
+    // (ARB_shader_draw_parameters, core in OpenGL 4.6).
+    bool IndirectDrawSupported();
+
+    class IndirectRenderer
+    {
+    public:
+        static constexpr GLuint DRAW_BINDING = 3;       // Storage binding of DrawBuffer
+        static constexpr GLuint MATERIAL_BINDING = 4;   // Storage binding of MaterialBuffer
+        static constexpr GLint MAX_LAYER_SIZE = 1024;   // Largest width and height of a texture layer
+
+        // t_shader is built from shaders/indirect_shader.vs and shaders/indirect_shader.fs.
+        explicit IndirectRenderer(Shader& t_shader);
+        IndirectRenderer(const IndirectRenderer&) = delete;
+        IndirectRenderer& operator=(const IndirectRenderer&) = delete;
+        ~IndirectRenderer();
+
+        // Draw the props' meshes with the indirect shader, whatever shader each prop has
+        // attached. Meshes are added to the arena and textures to the texture array the first
+        // time they are drawn; later changes to a texture's pixels are not seen. A texture
+        // whose material has no textureSize gets a black layer. Procedural
+        // props have no index data to merge; they are drawn one by one after the call.
+        // Call between t_frame.Begin and t_frame.End.
+        void Render(FrameUniforms& t_frame, std::vector<UGLProp>& t_props);
+
+        // Commands and glMultiDrawElementsIndirect calls of the last Render.
+        GLuint GetCommandCount() const;
+        GLuint GetCallCount() const;
+
+    protected:
+        // Where a mesh lives in the arena. The source tells a mesh buffer from a later one
+        // allocated at the same address.
+        struct ArenaRange {
+            std::weak_ptr<MeshBuffer> source;
+            GLuint firstIndex = 0;
+            GLint baseVertex = 0;
+            GLuint indexCount = 0;
+            GLuint vertexCount = 0;
+        };
+
+        void reclaimArena();
+        const ArenaRange& arenaRange(const Mesh& t_mesh);
+        GLint materialIndex(const Material& t_material);
+        GLint textureLayer(const Material& t_material);
+        void buildTextureArray();
+        void addCommand(GLuint t_count, GLuint t_firstIndex, const ArenaRange& t_range, const DrawData& t_draw);
+        static void upload(GLenum t_target, GLuint& t_buffer, const void* t_data, GLsizeiptr t_size);
+
+        Shader* shader;
+        Mesh arena;             // Every mesh drawn so far, FLOAT32; indices stay relative to each mesh
+        bool arenaDirty = false;
+        GLuint deadVertices = 0;                // Arena vertices of mesh buffers that no longer exist
+        std::unordered_map<const MeshBuffer*, ArenaRange> ranges;
+        std::vector<MaterialData> materials;
+        bool materialsDirty = false;
+        std::vector<DrawElementsIndirectCommand> commands;
+        std::vector<DrawData> draws;
+        std::vector<GLsizei> drawCounts;        // Scratch for the visible meshlet ranges of one mesh
+        std::vector<GLuint> drawFirstIndices;
+        GLuint commandBuffer = 0;
+        GLuint drawBuffer = 0;
+        GLuint materialBuffer = 0;
+        // Source texture of one layer of the texture array.
+        struct LayerSource {
+            GLuint texture = 0;
+            glm::ivec2 size = glm::ivec2(0);
+        };
+
+        Shader::Uniform<int> texturesUniform;   // Sampler of the texture array, always unit 0
+        std::unordered_map<GLuint, GLint> textureLayers;
+        std::vector<LayerSource> layerSources;
+        bool texturesDirty = false;
+        GLuint textureArray = 0;
+        GLuint framebuffers[2] = { 0, 0 };      // Read and draw framebuffers of the layer copies
+        GLuint callCount = 0;
+    };
+
+}
+#endif // !_IndirectRenderer_
@@ -0,0 +1,203 @@
+#include "MeshCache.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshletBuilder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+using namespace RichWerks;
+
+namespace {
+    // Mix the bit pattern of a float into a running hash. -0.0f compares equal to 0.0f, so it
+    // is hashed as 0.0f.
+    void hashCombine(size_t& seed, const GLfloat value) {
+        const GLfloat normalized = value == 0.0f ? 0.0f : value;
+        uint32_t bits;
+        std::memcpy(&bits, &normalized, sizeof(bits));
+        seed ^= std::hash<uint32_t>()(bits) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    // Recipe for a generator with up to three arguments, no transforms and the FLOAT32 layout
+    MeshRecipe makeRecipe(const MeshPrimitive primitive, const GLfloat a, const GLfloat b, const GLfloat c) {
+        MeshRecipe recipe;
+        recipe.primitive = primitive;
+        recipe.parameters = { a, b, c };
+        return recipe;
+    }
+}
+
+bool MeshTransform::operator==(const MeshTransform& other) const {
+    return type == other.type && radians == other.radians && vector == other.vector;
+}
+
+MeshRecipe MeshRecipe::Cylinder(const float radius, const float height, const int segments) {
+    return makeRecipe(MeshPrimitive::CYLINDER, radius, height, static_cast<GLfloat>(segments));
+}
+
+MeshRecipe MeshRecipe::Cube(const float length, const float width, const float height) {
+    return makeRecipe(MeshPrimitive::CUBE, length, width, height);
+}
+
+MeshRecipe MeshRecipe::Plane(const float length, const float width) {
+    return makeRecipe(MeshPrimitive::PLANE, length, width, 0.0f);
+}
+
+MeshRecipe MeshRecipe::Pyramid(const float baseLength, const float height) {
+    return makeRecipe(MeshPrimitive::PYRAMID, baseLength, height, 0.0f);
+}
+
+MeshRecipe MeshRecipe::Sphere(const float radius, const int divisions) {
+    return makeRecipe(MeshPrimitive::SPHERE, radius, static_cast<GLfloat>(divisions), 0.0f);
+}
+
+MeshRecipe MeshRecipe::Torus(const float outerRadius, const float innerRadius, const int segments) {
+    return makeRecipe(MeshPrimitive::TORUS, outerRadius, innerRadius, static_cast<GLfloat>(segments));
+}
+
+MeshRecipe MeshRecipe::Cone(const float radius, const float height, const int segments) {
+    return makeRecipe(MeshPrimitive::CONE, radius, height, static_cast<GLfloat>(segments));
+}
+
+MeshRecipe MeshRecipe::Icosphere(const float radius, const int subdivisions) {
+    return makeRecipe(MeshPrimitive::ICOSPHERE, radius, static_cast<GLfloat>(subdivisions), 0.0f);
+}
+
+MeshRecipe& MeshRecipe::Rotate(const float radians, const glm::vec3 axes) {
+    transforms.push_back({ MeshTransform::Type::ROTATE, radians, axes });
+    return *this;
+}
+
+MeshRecipe& MeshRecipe::Translate(const glm::vec3 t_position) {
+    transforms.push_back({ MeshTransform::Type::TRANSLATE, 0.0f, t_position });
+    return *this;
+}
+
+MeshRecipe& MeshRecipe::Compact() {
+    vertexFormat = VertexFormat::COMPACT;
+    return *this;
+}
+
+MeshRecipe MeshRecipe::Reduced(const float detailScale) const {
+    MeshRecipe reduced = *this;
+    const auto scaleDetail = [detailScale](GLfloat& detail, const GLfloat minimum) {
+        detail = std::max(minimum, std::round(detail * detailScale));
+    };
+    switch (primitive) {
+    case MeshPrimitive::CYLINDER:
+        scaleDetail(reduced.parameters[2], 3.0f);
+        break;
+    case MeshPrimitive::SPHERE:
+        scaleDetail(reduced.parameters[1], 4.0f);
+        break;
+    case MeshPrimitive::TORUS:
+    case MeshPrimitive::CONE:
+        scaleDetail(reduced.parameters[2], 3.0f);
+        break;
+    case MeshPrimitive::ICOSPHERE:
+        // Each subdivision quadruples the triangles, i.e. doubles the detail along an edge.
+        reduced.parameters[1] = std::max(0.0f, reduced.parameters[1] + std::round(std::log2(detailScale)));
+        break;
+    default:
+        break;
+    }
+    return reduced;
+}
+
+Mesh MeshRecipe::Generate() const {
+    Mesh mesh;
+    switch (primitive) {
+    case MeshPrimitive::CYLINDER:
+        mesh = std::generateCylinder(parameters[0], parameters[1], static_cast<int>(parameters[2]));
+        break;
+    case MeshPrimitive::CUBE:
+        mesh = std::generateCube(parameters[0], parameters[1], parameters[2]);
+        break;
+    case MeshPrimitive::PLANE:
+        mesh = std::generatePlane(parameters[0], parameters[1]);
+        break;
+    case MeshPrimitive::PYRAMID:
+        mesh = std::generatePyramid(parameters[0], parameters[1]);
+        break;
+    case MeshPrimitive::SPHERE:
+        mesh = std::generateSphere(parameters[0], static_cast<int>(parameters[1]));
+        break;
+    case MeshPrimitive::TORUS:
+        mesh = std::generateTorus(parameters[0], parameters[1], static_cast<int>(parameters[2]));
+        break;
+    case MeshPrimitive::CONE:
+        mesh = std::generateCone(parameters[0], parameters[1], static_cast<int>(parameters[2]));
+        break;
+    case MeshPrimitive::ICOSPHERE:
+        mesh = std::generateIcosphere(parameters[0], static_cast<int>(parameters[1]));
+        break;
+    }
+
+    // Compose the pre-transforms so the vertices are only touched once.
+    if (!transforms.empty()) {
+        glm::mat4 composed(1.0f);
+        for (const MeshTransform& transform : transforms) {
+            if (transform.type == MeshTransform::Type::ROTATE) {
+                composed = glm::rotate(glm::mat4(1.0f), transform.radians, transform.vector) * composed;
+            }
+            else {
+                composed = glm::translate(glm::mat4(1.0f), transform.vector) * composed;
+            }
+        }
+        std::transformMesh(mesh, composed);
+    }
+
+    // Cached meshes are uploaded once and drawn every frame, so reorder them for the GPU and
+    // split them into meshlets Render can cull.
+    std::optimizeMesh(mesh);
+    std::buildMeshlets(mesh);
+    mesh.vertexFormat = vertexFormat;
+    return mesh;
+}
+
+bool MeshRecipe::operator==(const MeshRecipe& other) const {
+    return primitive == other.primitive && parameters == other.parameters && transforms == other.transforms
+        && vertexFormat == other.vertexFormat;
+}
+
+size_t MeshRecipeHash::operator()(const MeshRecipe& recipe) const {
+    size_t seed = std::hash<GLint>()(static_cast<GLint>(recipe.primitive));
+    hashCombine(seed, static_cast<GLfloat>(recipe.vertexFormat));
+    for (const GLfloat parameter : recipe.parameters) {
+        hashCombine(seed, parameter);
+    }
+    for (const MeshTransform& transform : recipe.transforms) {
+        hashCombine(seed, static_cast<GLfloat>(transform.type));
+        hashCombine(seed, transform.radians);
+        hashCombine(seed, transform.vector.x);
+        hashCombine(seed, transform.vector.y);
+        hashCombine(seed, transform.vector.z);
+    }
+    return seed;
+}
+
+// Look up or create the mesh for a recipe
+std::shared_ptr<const Mesh> MeshCache::Get(const MeshRecipe& recipe) {
+    std::shared_ptr<const Mesh>& cached = entries[recipe];
+    if (!cached) {
+        Mesh mesh = recipe.Generate();
+        UploadMesh(mesh);
+        cached = std::make_shared<const Mesh>(std::move(mesh));
+    }
+    return cached;
+}
+
+// Remove entries that no prop references any more
+void MeshCache::Prune() {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.use_count() == 1) {
+            it = entries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+// Get the number of cached recipes
+size_t MeshCache::GetSize() const {
+    return entries.size();
+}
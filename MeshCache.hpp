@@ -0,0 +1,89 @@
+/*
+ * File:          MeshCache.hpp
+ * Description:   Cache of generated meshes keyed by generator, parameters and any
+ *                pre-transforms. Identical requests return the same shared mesh, CPU
+ *                data and GPU buffer alike, so props that repeat in a scene are only
+ *                generated, stored and uploaded once.
+ */
+
+#include <array>
+#include <unordered_map>
+#include "MeshGenerator.hpp"
+
+#ifndef _MeshCache_
+#define _MeshCache_
+
+#pragma once
+namespace RichWerks {
+
+    // The generator a MeshRecipe runs.
+    enum struct MeshPrimitive : GLint { CYLINDER, CUBE, PLANE, PYRAMID, SPHERE, TORUS, CONE, ICOSPHERE };
+
+    // A rotateMesh or translateMesh applied to the generated mesh.
+    struct MeshTransform {
+        enum struct Type : GLint { ROTATE, TRANSLATE };
+        Type type;
+        GLfloat radians;      // Rotation angle (ROTATE only)
+        glm::vec3 vector;     // Rotation axes or translation
+
+        bool operator==(const MeshTransform& other) const;
+    };
+
+    // Everything needed to reproduce a generated mesh. Used as the cache key.
+    struct MeshRecipe {
+        MeshPrimitive primitive;
+        std::array<GLfloat, 3> parameters = { 0.0f, 0.0f, 0.0f };  // Generator arguments in declaration order
+        std::vector<MeshTransform> transforms;
+        VertexFormat vertexFormat = VertexFormat::FLOAT32;
+
+        // Recipes for each generator in MeshGenerator.hpp.
+        static MeshRecipe Cylinder(const float radius, const float height, const int segments);
+        static MeshRecipe Cube(const float length, const float width, const float height);
+        static MeshRecipe Plane(const float length, const float width);
+        static MeshRecipe Pyramid(const float baseLength, const float height);
+        static MeshRecipe Sphere(const float radius, const int divisions);
+        static MeshRecipe Torus(const float outerRadius, const float innerRadius, const int segments);
+        static MeshRecipe Cone(const float radius, const float height, const int segments);
+        static MeshRecipe Icosphere(const float radius, const int subdivisions);
+
+        // Append a pre-transform. Transforms are applied in the order they are added.
+        MeshRecipe& Rotate(const float radians, const glm::vec3 axes);
+        MeshRecipe& Translate(const glm::vec3 t_position);
+
+        // Upload the mesh in the COMPACT vertex layout (16 bytes per vertex instead of 32).
+        MeshRecipe& Compact();
+
+        // Copy of this recipe with the segment/division count scaled by detailScale, for a
+        // coarser level of detail. Primitives without a detail argument are returned as-is.
+        MeshRecipe Reduced(const float detailScale) const;
+
+        // Run the generator, pre-transforms and optimizeMesh without touching the cache or the GPU.
+        Mesh Generate() const;
+
+        bool operator==(const MeshRecipe& other) const;
+    };
+
+    struct MeshRecipeHash {
+        size_t operator()(const MeshRecipe& recipe) const;
+    };
+
+    class MeshCache
+    {
+    public:
+        // Return the mesh for a recipe, generating and uploading it only on the first request.
+        // Every request gets the same Mesh, already bound, so it can be added to a prop as-is.
+        std::shared_ptr<const Mesh> Get(const MeshRecipe& recipe);
+
+        // Drop the meshes no prop holds any more, releasing their CPU data and GPU buffer.
+        void Prune();
+
+        // Number of distinct recipes currently cached.
+        size_t GetSize() const;
+
+    protected:
+        // The cache holds one reference itself, so a mesh stays resident until Prune.
+        std::unordered_map<MeshRecipe, std::shared_ptr<const Mesh>, MeshRecipeHash> entries;
+    };
+
+}
+#endif // !_MeshCache_
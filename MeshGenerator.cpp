@@ -1,1255 +1,1077 @@
 #include "MeshGenerator.hpp"
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <glm/gtc/packing.hpp>
+
+// Pick the widest vector kernel the compiler was told it may use (/arch:AVX or -mavx for AVX).
+#if defined(__AVX__)
+#define MESH_TRANSFORM_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_TRANSFORM_SSE
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Write one interleaved vertex (position, normal, texture coordinate) and return the next write position.
+    inline GLfloat* writeVertex(GLfloat* out, float x, float y, float z, float nX, float nY, float nZ, float u, float v) {
+        out[0] = x;
+        out[1] = y;
+        out[2] = z;
+        out[3] = nX;
+        out[4] = nY;
+        out[5] = nZ;
+        out[6] = u;
+        out[7] = v;
+        return out + RichWerks::FLOATS_PER_MESH_VERTEX;
+    }
+
+    // Write one triangle offset by baseIndex and return the next write position.
+    inline GLuint* writeTriangle(GLuint* out, const GLuint baseIndex, int a, int b, int c) {
+        out[0] = baseIndex + a;
+        out[1] = baseIndex + b;
+        out[2] = baseIndex + c;
+        return out + 3;
+    }
+
+    // Copy a unit primitive table, scaling positions per axis and offsetting indices by baseIndex.
+    template <size_t V, size_t I>
+    void copyScaled(const std::array<GLfloat, V>& vertices, const std::array<GLuint, I>& indices, const glm::vec3 scale,
+        GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        for (size_t i = 0; i < V; i += RichWerks::FLOATS_PER_MESH_VERTEX) {
+            vertexOut = writeVertex(vertexOut, vertices[i] * scale.x, vertices[i + 1] * scale.y, vertices[i + 2] * scale.z,
+                vertices[i + 3], vertices[i + 4], vertices[i + 5], vertices[i + 6], vertices[i + 7]);
+        }
+        for (size_t i = 0; i < I; ++i) {
+            indexOut[i] = baseIndex + indices[i];
+        }
+    }
+
+    // Allocate a mesh whose vertex and index buffers are already sized to their final length.
+    RichWerks::Mesh allocateMesh(const RichWerks::MeshCounts counts) {
+        RichWerks::Mesh mesh;
+        mesh.vertexData.resize(counts.vertexCount * RichWerks::FLOATS_PER_MESH_VERTEX);
+        mesh.indexData.resize(counts.indexCount);
+        return mesh;
+    }
+
+    // Fewest vertices worth one thread pool task. Below it the hand-off costs more than the
+    // rows save, so smaller meshes are written on the calling thread.
+    const int PARALLEL_GRAIN_VERTICES = 16384;
+
+    // Call writeRows(rowBegin, rowEnd) over [0, rows) in chunks of at least
+    // PARALLEL_GRAIN_VERTICES, across the pool when there is more than one chunk.
+    template <class WriteRows>
+    void forEachRowChunk(RichWerks::ThreadPool& pool, const int rows, const int verticesPerRow, const WriteRows& writeRows) {
+        const int rowsPerChunk = std::max(1, (PARALLEL_GRAIN_VERTICES + verticesPerRow - 1) / verticesPerRow);
+        const int chunks = (rows + rowsPerChunk - 1) / rowsPerChunk;
+        if (chunks <= 1) {
+            writeRows(0, rows);
+            return;
+        }
+        pool.ParallelFor(static_cast<size_t>(chunks), [&](const size_t chunk) {
+            const int rowBegin = static_cast<int>(chunk) * rowsPerChunk;
+            writeRows(rowBegin, std::min(rows, rowBegin + rowsPerChunk));
+        });
+    }
+
+    // Sphere rings [ringBegin, ringEnd): each ring's vertex row and, above the last ring, the
+    // quads between it and the next. Rings write disjoint slices, so they can run in parallel.
+    void writeSphereRings(const float radius, const int divisions, const RichWerks::AngleTable& sectorAngles, const int ringBegin, const int ringEnd,
+        GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        const int rings = divisions;
+        const int sectors = divisions;
+        const float RADS_PER_RING = M_PI / rings;
+
+        for (int ring = ringBegin; ring < ringEnd; ++ring) {
+            const float theta = ring * RADS_PER_RING;
+            const float sinTheta = std::sin(theta);
+            const float cosTheta = std::cos(theta);
+            const float v = static_cast<float>(ring) / rings;
+
+            GLfloat* vertex = vertexOut + static_cast<size_t>(ring) * (sectors + 1) * RichWerks::FLOATS_PER_MESH_VERTEX;
+            for (int sector = 0; sector <= sectors; ++sector) {
+                const float x = radius * sinTheta * sectorAngles.cosines[sector];
+                const float y = radius * cosTheta;
+                const float z = radius * sinTheta * sectorAngles.sines[sector];
+
+                const float u = static_cast<float>(sector) / sectors;
+
+                const glm::vec3 normal = glm::normalize(glm::vec3(x, y, z));
+                vertex = writeVertex(vertex, x, y, z, normal.x, normal.y, normal.z, u, v);
+            }
+
+            if (ring == rings) {
+                continue;
+            }
+            GLuint* index = indexOut + static_cast<size_t>(ring) * sectors * 6;
+            for (int sector = 0; sector < sectors; ++sector) {
+                const int current = ring * (sectors + 1) + sector;
+                const int next = current + sectors + 1;
+
+                index = writeTriangle(index, baseIndex, current, next, current + 1);
+                index = writeTriangle(index, baseIndex, current + 1, next, next + 1);
+            }
+        }
+    }
+
+    // Torus rings [ringBegin, ringEnd) around the major axis, each writing segments vertices and
+    // their 2 * segments triangles into its own slice of the buffers.
+    void writeTorusRings(const float outerRadius, const float innerRadius, const int segments, const RichWerks::AngleTable& angles, const int ringBegin, const int ringEnd,
+        GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        const int majorSegments = segments;
+        const int minorSegments = segments;
+
+        for (int i = ringBegin; i < ringEnd; ++i) {
+            const float cosMajor = angles.cosines[i];
+            const float sinMajor = angles.sines[i];
+            const float u = static_cast<float>(i) / majorSegments;
+
+            GLfloat* vertex = vertexOut + static_cast<size_t>(i) * minorSegments * RichWerks::FLOATS_PER_MESH_VERTEX;
+            GLuint* index = indexOut + static_cast<size_t>(i) * minorSegments * 6;
+            for (int j = 0; j < minorSegments; ++j) {
+                const float cosMinor = angles.cosines[j];
+                const float sinMinor = angles.sines[j];
+
+                // Calculate vertex position
+                const float x = (outerRadius + innerRadius * cosMinor) * cosMajor;
+                const float y = innerRadius * sinMinor;
+                const float z = (outerRadius + innerRadius * cosMinor) * sinMajor;
+
+                // Calculate vertex normal
+                const float nX = cosMajor * cosMinor;
+                const float nY = sinMinor;
+                const float nZ = sinMajor * cosMinor;
+
+                // Calculate texture coordinates
+                const float v = static_cast<float>(j) / minorSegments;
+
+                // Add the vertex
+                vertex = writeVertex(vertex, x, y, z, nX, nY, nZ, u, v);
+
+                // Calculate indices for the triangles
+                const int nextRow = (j + 1) % minorSegments;
+                const int nextCol = (i + 1) % majorSegments;
+
+                const int currentIndex = j * majorSegments + i;
+                const int nextRowIndex = nextRow * majorSegments + i;
+                const int nextColIndex = j * majorSegments + nextCol;
+                const int nextRowNextColIndex = nextRow * majorSegments + nextCol;
+
+                // Add indices for the two triangles
+                index = writeTriangle(index, baseIndex, currentIndex, nextRowIndex, nextColIndex);
+                index = writeTriangle(index, baseIndex, nextRowIndex, nextRowNextColIndex, nextColIndex);
+            }
+        }
+    }
+
+    // Whether the lathe joins profile points i and i + 1 with triangles (not a hard edge).
+    inline bool latheSpanUsed(const RichWerks::ProfilePoint& a, const RichWerks::ProfilePoint& b) {
+        return a.radius != b.radius || a.height != b.height;
+    }
+
+    // Triangles between two profile rows. Rows on the axis become fans.
+    inline size_t latheSpanTriangles(const RichWerks::ProfilePoint& a, const RichWerks::ProfilePoint& b, const int segments) {
+        if (!latheSpanUsed(a, b)) {
+            return 0;
+        }
+        return static_cast<size_t>(segments) * ((a.radius == 0.0f || b.radius == 0.0f) ? 1 : 2);
+    }
+
+    // Write one lathe row: the profile point revolved through every column of the angle table.
+    void writeLatheRow(const RichWerks::ProfilePoint& point, const RichWerks::AngleTable& angles, const int columns, GLfloat* vertexOut) {
+        int column = 0;
+#if defined(MESH_TRANSFORM_SSE) || defined(MESH_TRANSFORM_AVX)
+        // Four columns at a time: compute x/z and the normal's x/z as vectors, then transpose
+        // (x, y, z, nX) and (nY, nZ, u, v) into the two halves of four interleaved vertices.
+        const __m128 radius = _mm_set1_ps(point.radius);
+        const __m128 normalRadial = _mm_set1_ps(point.normalRadial);
+        const __m128 height = _mm_set1_ps(point.height);
+        const __m128 normalY = _mm_set1_ps(point.normalY);
+        const __m128 v = _mm_set1_ps(point.v);
+        for (; column + 4 <= columns; column += 4) {
+            const __m128 cosines = _mm_loadu_ps(&angles.cosines[column]);
+            const __m128 sines = _mm_loadu_ps(&angles.sines[column]);
+            __m128 first0 = _mm_mul_ps(radius, cosines);
+            __m128 first1 = height;
+            __m128 first2 = _mm_mul_ps(radius, sines);
+            __m128 first3 = _mm_mul_ps(normalRadial, cosines);
+            __m128 second0 = normalY;
+            __m128 second1 = _mm_mul_ps(normalRadial, sines);
+            __m128 second2 = _mm_loadu_ps(&angles.u[column]);
+            __m128 second3 = v;
+            _MM_TRANSPOSE4_PS(first0, first1, first2, first3);
+            _MM_TRANSPOSE4_PS(second0, second1, second2, second3);
+            GLfloat* out = vertexOut + static_cast<size_t>(column) * RichWerks::FLOATS_PER_MESH_VERTEX;
+            _mm_storeu_ps(out, first0);
+            _mm_storeu_ps(out + 4, second0);
+            _mm_storeu_ps(out + 8, first1);
+            _mm_storeu_ps(out + 12, second1);
+            _mm_storeu_ps(out + 16, first2);
+            _mm_storeu_ps(out + 20, second2);
+            _mm_storeu_ps(out + 24, first3);
+            _mm_storeu_ps(out + 28, second3);
+        }
+#endif
+        for (; column < columns; ++column) {
+            writeVertex(vertexOut + static_cast<size_t>(column) * RichWerks::FLOATS_PER_MESH_VERTEX,
+                point.radius * angles.cosines[column], point.height, point.radius * angles.sines[column],
+                point.normalRadial * angles.cosines[column], point.normalY, point.normalRadial * angles.sines[column],
+                angles.u[column], point.v);
+        }
+    }
+
+#if !defined(MESH_TRANSFORM_SSE)
+    // Apply an affine matrix to positions and a 3x3 normal matrix to normals of count interleaved
+    // vertices in place, widening boundsMin/boundsMax by every transformed position. Texture
+    // coordinates pass through untouched.
+    void transformVerticesScalar(GLfloat* vertex, size_t count, const glm::mat4& transform, const glm::mat3& normalMatrix,
+        glm::vec3& boundsMin, glm::vec3& boundsMax) {
+        for (size_t i = 0; i < count; ++i, vertex += RichWerks::FLOATS_PER_MESH_VERTEX) {
+            const glm::vec3 position = glm::vec3(transform * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+            const glm::vec3 normal = normalMatrix * glm::vec3(vertex[3], vertex[4], vertex[5]);
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+            vertex[0] = position.x;
+            vertex[1] = position.y;
+            vertex[2] = position.z;
+            vertex[3] = normal.x;
+            vertex[4] = normal.y;
+            vertex[5] = normal.z;
+        }
+    }
+#endif
+
+#if defined(MESH_TRANSFORM_SSE) || defined(MESH_TRANSFORM_AVX)
+    // One vertex is two 4-float halves: lo = (x, y, z, nX) and hi = (nY, nZ, u, v).
+    // The same shuffles work per 128-bit lane for both the SSE and AVX kernels. The position
+    // (p.x, p.y, p.z, 1) also widens boxMin/boxMax, so the bounds come out of the same pass.
+#define MESH_TRANSFORM_KERNEL(VEC, ADD, MUL, SHUFFLE, MIN, MAX)                               \
+    {                                                                                        \
+        const VEC x = SHUFFLE(lo, lo, _MM_SHUFFLE(0, 0, 0, 0));                              \
+        const VEC y = SHUFFLE(lo, lo, _MM_SHUFFLE(1, 1, 1, 1));                              \
+        const VEC z = SHUFFLE(lo, lo, _MM_SHUFFLE(2, 2, 2, 2));                              \
+        const VEC nX = SHUFFLE(lo, lo, _MM_SHUFFLE(3, 3, 3, 3));                             \
+        const VEC nY = SHUFFLE(hi, hi, _MM_SHUFFLE(0, 0, 0, 0));                             \
+        const VEC nZ = SHUFFLE(hi, hi, _MM_SHUFFLE(1, 1, 1, 1));                             \
+        const VEC p = ADD(ADD(MUL(c0, x), MUL(c1, y)), ADD(MUL(c2, z), c3));                 \
+        const VEC n = ADD(ADD(MUL(n0, nX), MUL(n1, nY)), MUL(n2, nZ));                       \
+        boxMin = MIN(boxMin, p);                                                             \
+        boxMax = MAX(boxMax, p);                                                             \
+        /* (p.z, p.z, n.x, n.x) then (p.x, p.y, p.z, n.x) and (n.y, n.z, u, v) */            \
+        const VEC pzNx = SHUFFLE(p, n, _MM_SHUFFLE(0, 0, 2, 2));                             \
+        lo = SHUFFLE(p, pzNx, _MM_SHUFFLE(2, 0, 1, 0));                                      \
+        hi = SHUFFLE(n, hi, _MM_SHUFFLE(3, 2, 2, 1));                                        \
+    }
+#endif
+
+#if defined(MESH_TRANSFORM_AVX)
+    // AVX: two vertices per iteration, one in each 128-bit lane.
+    void transformVertices(GLfloat* vertex, size_t count, const glm::mat4& transform, const glm::mat3& normalMatrix,
+        glm::vec3& boundsMin, glm::vec3& boundsMax) {
+        const __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&transform[0][0]));
+        const __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&transform[1][0]));
+        const __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&transform[2][0]));
+        const __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&transform[3][0]));
+        const __m256 n0 = _mm256_setr_ps(normalMatrix[0][0], normalMatrix[0][1], normalMatrix[0][2], 0.0f, normalMatrix[0][0], normalMatrix[0][1], normalMatrix[0][2], 0.0f);
+        const __m256 n1 = _mm256_setr_ps(normalMatrix[1][0], normalMatrix[1][1], normalMatrix[1][2], 0.0f, normalMatrix[1][0], normalMatrix[1][1], normalMatrix[1][2], 0.0f);
+        const __m256 n2 = _mm256_setr_ps(normalMatrix[2][0], normalMatrix[2][1], normalMatrix[2][2], 0.0f, normalMatrix[2][0], normalMatrix[2][1], normalMatrix[2][2], 0.0f);
+        __m256 boxMin = _mm256_set1_ps(std::numeric_limits<GLfloat>::max());
+        __m256 boxMax = _mm256_set1_ps(-std::numeric_limits<GLfloat>::max());
+
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2, vertex += 2 * RichWerks::FLOATS_PER_MESH_VERTEX) {
+            const __m256 a = _mm256_loadu_ps(vertex);
+            const __m256 b = _mm256_loadu_ps(vertex + RichWerks::FLOATS_PER_MESH_VERTEX);
+            __m256 lo = _mm256_permute2f128_ps(a, b, 0x20);
+            __m256 hi = _mm256_permute2f128_ps(a, b, 0x31);
+            MESH_TRANSFORM_KERNEL(__m256, _mm256_add_ps, _mm256_mul_ps, _mm256_shuffle_ps, _mm256_min_ps, _mm256_max_ps)
+            _mm256_storeu_ps(vertex, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(vertex + RichWerks::FLOATS_PER_MESH_VERTEX, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+        GLfloat laneMin[4];
+        GLfloat laneMax[4];
+        _mm_storeu_ps(laneMin, _mm_min_ps(_mm256_castps256_ps128(boxMin), _mm256_extractf128_ps(boxMin, 1)));
+        _mm_storeu_ps(laneMax, _mm_max_ps(_mm256_castps256_ps128(boxMax), _mm256_extractf128_ps(boxMax, 1)));
+        boundsMin = glm::min(boundsMin, glm::vec3(laneMin[0], laneMin[1], laneMin[2]));
+        boundsMax = glm::max(boundsMax, glm::vec3(laneMax[0], laneMax[1], laneMax[2]));
+        transformVerticesScalar(vertex, count - i, transform, normalMatrix, boundsMin, boundsMax);
+    }
+#elif defined(MESH_TRANSFORM_SSE)
+    // SSE: one vertex per iteration.
+    void transformVertices(GLfloat* vertex, size_t count, const glm::mat4& transform, const glm::mat3& normalMatrix,
+        glm::vec3& boundsMin, glm::vec3& boundsMax) {
+        const __m128 c0 = _mm_loadu_ps(&transform[0][0]);
+        const __m128 c1 = _mm_loadu_ps(&transform[1][0]);
+        const __m128 c2 = _mm_loadu_ps(&transform[2][0]);
+        const __m128 c3 = _mm_loadu_ps(&transform[3][0]);
+        const __m128 n0 = _mm_setr_ps(normalMatrix[0][0], normalMatrix[0][1], normalMatrix[0][2], 0.0f);
+        const __m128 n1 = _mm_setr_ps(normalMatrix[1][0], normalMatrix[1][1], normalMatrix[1][2], 0.0f);
+        const __m128 n2 = _mm_setr_ps(normalMatrix[2][0], normalMatrix[2][1], normalMatrix[2][2], 0.0f);
+        __m128 boxMin = _mm_set1_ps(std::numeric_limits<GLfloat>::max());
+        __m128 boxMax = _mm_set1_ps(-std::numeric_limits<GLfloat>::max());
+
+        for (size_t i = 0; i < count; ++i, vertex += RichWerks::FLOATS_PER_MESH_VERTEX) {
+            __m128 lo = _mm_loadu_ps(vertex);
+            __m128 hi = _mm_loadu_ps(vertex + 4);
+            MESH_TRANSFORM_KERNEL(__m128, _mm_add_ps, _mm_mul_ps, _mm_shuffle_ps, _mm_min_ps, _mm_max_ps)
+            _mm_storeu_ps(vertex, lo);
+            _mm_storeu_ps(vertex + 4, hi);
+        }
+        GLfloat laneMin[4];
+        GLfloat laneMax[4];
+        _mm_storeu_ps(laneMin, boxMin);
+        _mm_storeu_ps(laneMax, boxMax);
+        boundsMin = glm::min(boundsMin, glm::vec3(laneMin[0], laneMin[1], laneMin[2]));
+        boundsMax = glm::max(boundsMax, glm::vec3(laneMax[0], laneMax[1], laneMax[2]));
+    }
+#else
+    void transformVertices(GLfloat* vertex, size_t count, const glm::mat4& transform, const glm::mat3& normalMatrix,
+        glm::vec3& boundsMin, glm::vec3& boundsMax) {
+        transformVerticesScalar(vertex, count, transform, normalMatrix, boundsMin, boundsMax);
+    }
+#endif
+}
 
 namespace std {
-       
+
+    RichWerks::MeshCounts countCylinder(const int segments) {
+        // Two caps of a center plus one ring, and a body with two rows of segments + 2 columns.
+        return { static_cast<size_t>(2 * (segments + 1) + 2 * (segments + 2)), static_cast<size_t>(6 * segments + 6 * (segments + 1)) };
+    }
+
+    RichWerks::MeshCounts countCube() {
+        return { RichWerks::UNIT_CUBE_VERTICES.size() / RichWerks::FLOATS_PER_MESH_VERTEX, RichWerks::UNIT_CUBE_INDICES.size() };
+    }
+
+    RichWerks::MeshCounts countPlane() {
+        return { RichWerks::UNIT_PLANE_VERTICES.size() / RichWerks::FLOATS_PER_MESH_VERTEX, RichWerks::UNIT_PLANE_INDICES.size() };
+    }
+
+    RichWerks::MeshCounts countPlane(const int divisions) {
+        return { static_cast<size_t>((divisions + 1) * (divisions + 1)), static_cast<size_t>(6 * divisions * divisions) };
+    }
+
+    RichWerks::MeshCounts countPyramid() {
+        return { RichWerks::UNIT_PYRAMID_VERTICES.size() / RichWerks::FLOATS_PER_MESH_VERTEX, RichWerks::UNIT_PYRAMID_INDICES.size() };
+    }
+
+    RichWerks::MeshCounts countSphere(const int divisions) {
+        // (rings + 1) * (sectors + 1) vertices, 2 triangles per ring/sector quad.
+        return { static_cast<size_t>((divisions + 1) * (divisions + 1)), static_cast<size_t>(6 * divisions * divisions) };
+    }
+
+    RichWerks::MeshCounts countTorus(const int segments) {
+        return { static_cast<size_t>(segments * segments), static_cast<size_t>(6 * segments * segments) };
+    }
+
+    RichWerks::MeshCounts countLathe(const std::vector<RichWerks::ProfilePoint>& profile, const int segments) {
+        size_t triangles = 0;
+        for (size_t i = 0; i + 1 < profile.size(); ++i) {
+            triangles += latheSpanTriangles(profile[i], profile[i + 1], segments);
+        }
+        return { profile.size() * static_cast<size_t>(segments + 1), triangles * 3 };
+    }
+
+    RichWerks::MeshCounts countCone(const int segments) {
+        return countLathe(coneProfile(1.0f, 1.0f), segments);
+    }
+
+    std::shared_ptr<const RichWerks::AngleTable> angleTable(const int segments) {
+        static std::mutex mutex;
+        static std::unordered_map<int, std::shared_ptr<const RichWerks::AngleTable>> cache;
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const RichWerks::AngleTable>& cached = cache[segments];
+        if (!cached) {
+            // Same float step and product the generators always used, so output is unchanged.
+            const float RADS_PER_SEG = (2 * M_PI) / segments * 1.0f;
+            auto table = std::make_shared<RichWerks::AngleTable>();
+            table->cosines.resize(static_cast<size_t>(segments) + 2);
+            table->sines.resize(static_cast<size_t>(segments) + 2);
+            table->u.resize(static_cast<size_t>(segments) + 2);
+            for (int i = 0; i <= segments + 1; ++i) {
+                const float angle = RADS_PER_SEG * i;
+                table->cosines[i] = std::cos(angle);
+                table->sines[i] = std::sin(angle);
+                table->u[i] = static_cast<float>(i) / segments;
+            }
+            cached = table;
+        }
+        return cached;
+    }
+
     RichWerks::Mesh generateCylinder(const float radius, const float height, const int segments) {
-        RichWerks::Mesh cylinder;
+        RichWerks::Mesh cylinder = allocateMesh(countCylinder(segments));
         cylinder.size = glm::vec3(radius, height, radius);
+        generateCylinder(radius, height, segments, cylinder.vertexData.data(), cylinder.indexData.data());
+        computeMeshBounds(cylinder);
+        return cylinder;
+    }
 
-        // Constants for generating the cylinder mesh.
-        const int FLOATS_PER_POS = 3;
-        const int FLOATS_PER_NORM = 3;
-        const int FLOATS_PER_UV = 2;
-        const int FLOATS_PER_VERT = FLOATS_PER_POS + FLOATS_PER_NORM + FLOATS_PER_UV;
-        const float RADS_PER_SEG = (2 * M_PI) / segments * 1.0f;
+    RichWerks::Mesh generateCube(const float length, const float width, const float height) {
+        RichWerks::Mesh cube = allocateMesh(countCube());
+        cube.size = glm::vec3(width, height, length);
+        generateCube(length, width, height, cube.vertexData.data(), cube.indexData.data());
+        computeMeshBounds(cube);
+        return cube;
+    }
 
-        int firstIndex, nextIndex;
+    RichWerks::Mesh generatePlane(const float length, const float width) {
+        RichWerks::Mesh plane = allocateMesh(countPlane());
+        // Set the dimensions of the plane.
+        plane.size = glm::vec3(width, 0.0f, length);
+        generatePlane(length, width, plane.vertexData.data(), plane.indexData.data());
+        computeMeshBounds(plane);
+        return plane;
+    }
+
+    RichWerks::Mesh generatePlane(const float length, const float width, const int divisions) {
+        RichWerks::Mesh plane = allocateMesh(countPlane(divisions));
+        plane.size = glm::vec3(width, 0.0f, length);
+        generatePlane(length, width, divisions, plane.vertexData.data(), plane.indexData.data());
+        computeMeshBounds(plane);
+        return plane;
+    }
+
+    RichWerks::Mesh generatePyramid(const float baseLength, const float height) {
+        RichWerks::Mesh pyramid = allocateMesh(countPyramid());
+        pyramid.size = glm::vec3(baseLength, height, baseLength);
+        generatePyramid(baseLength, height, pyramid.vertexData.data(), pyramid.indexData.data());
+        computeMeshBounds(pyramid);
+        return pyramid;
+    }
+
+    RichWerks::Mesh generateSphere(const float radius, const int divisions) {
+        RichWerks::Mesh sphere = allocateMesh(countSphere(divisions));
+        generateSphere(radius, divisions, sphere.vertexData.data(), sphere.indexData.data());
+        computeMeshBounds(sphere);
+        return sphere;
+    }
+
+    RichWerks::Mesh generateTorus(const float outerRadius, const float innerRadius, const int segments) {
+        RichWerks::Mesh torus = allocateMesh(countTorus(segments));
+        generateTorus(outerRadius, innerRadius, segments, torus.vertexData.data(), torus.indexData.data());
+        computeMeshBounds(torus);
+        return torus;
+    }
+
+    RichWerks::Mesh generateLathe(const std::vector<RichWerks::ProfilePoint>& profile, const int segments) {
+        RichWerks::Mesh lathe = allocateMesh(countLathe(profile, segments));
+        generateLathe(profile, segments, lathe.vertexData.data(), lathe.indexData.data());
+        computeMeshBounds(lathe);
+        glm::vec2 extent(0.0f);
+        for (const RichWerks::ProfilePoint& point : profile) {
+            extent = glm::max(extent, glm::vec2(point.radius, point.height));
+        }
+        lathe.size = glm::vec3(extent.x, extent.y, extent.x);
+        return lathe;
+    }
+
+    RichWerks::Mesh generateCone(const float radius, const float height, const int segments) {
+        return generateLathe(coneProfile(radius, height), segments);
+    }
+
+    RichWerks::Mesh generateIcosphere(const float radius, const int subdivisions) {
+        // Unit icosahedron with a vertex on each pole and two rings of five at y = +-1/sqrt(5),
+        // the lower ring turned half a step. Pole indices stay 0 and 11 through every split.
+        const GLuint NORTH_POLE = 0;
+        const GLuint SOUTH_POLE = 11;
+        const float ringY = 1.0f / std::sqrt(5.0f);
+        const float ringRadius = 2.0f * ringY;
+        const float step = static_cast<float>(2.0 * M_PI / 5.0);
+        std::vector<glm::vec3> positions;
+        positions.reserve(10 * (static_cast<size_t>(1) << (2 * std::max(subdivisions, 0))) + 2);
+        positions.push_back(glm::vec3(0.0f, 1.0f, 0.0f));
+        for (int k = 0; k < 5; ++k) {
+            positions.push_back(glm::vec3(ringRadius * std::cos(k * step), ringY, ringRadius * std::sin(k * step)));
+        }
+        for (int k = 0; k < 5; ++k) {
+            positions.push_back(glm::vec3(ringRadius * std::cos((k + 0.5f) * step), -ringY, ringRadius * std::sin((k + 0.5f) * step)));
+        }
+        positions.push_back(glm::vec3(0.0f, -1.0f, 0.0f));
+
+        // Counter-clockwise seen from outside.
+        std::vector<GLuint> triangles;
+        for (GLuint k = 0; k < 5; ++k) {
+            const GLuint upper = 1 + k;
+            const GLuint upperNext = 1 + (k + 1) % 5;
+            const GLuint lower = 6 + k;
+            const GLuint lowerNext = 6 + (k + 1) % 5;
+            triangles.insert(triangles.end(), { NORTH_POLE, upperNext, upper });
+            triangles.insert(triangles.end(), { upper, upperNext, lower });
+            triangles.insert(triangles.end(), { upperNext, lowerNext, lower });
+            triangles.insert(triangles.end(), { SOUTH_POLE, lower, lowerNext });
+        }
+
+        // Split every triangle in four. Each edge's midpoint is made once and looked up by the
+        // second triangle sharing it, so the surface stays watertight.
+        std::unordered_map<uint64_t, GLuint> midpoints;
+        for (int level = 0; level < subdivisions; ++level) {
+            midpoints.clear();
+            midpoints.reserve(triangles.size() / 2);
+            const auto midpoint = [&](const GLuint a, const GLuint b) {
+                const uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+                const auto inserted = midpoints.emplace(key, static_cast<GLuint>(positions.size()));
+                if (inserted.second) {
+                    positions.push_back(glm::normalize(positions[a] + positions[b]));
+                }
+                return inserted.first->second;
+            };
+
+            std::vector<GLuint> split;
+            split.reserve(triangles.size() * 4);
+            for (size_t i = 0; i < triangles.size(); i += 3) {
+                const GLuint a = triangles[i];
+                const GLuint b = triangles[i + 1];
+                const GLuint c = triangles[i + 2];
+                const GLuint ab = midpoint(a, b);
+                const GLuint bc = midpoint(b, c);
+                const GLuint ca = midpoint(c, a);
+                split.insert(split.end(), { a, ab, ca, ab, b, bc, ca, bc, c, ab, bc, ca });
+            }
+            triangles.swap(split);
+        }
+
+        // Spherical texture coordinates of the shared vertices.
+        std::vector<glm::vec2> texCoords(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            float u = static_cast<float>(std::atan2(positions[i].z, positions[i].x) / (2.0 * M_PI));
+            u = u < 0.0f ? u + 1.0f : u;
+            texCoords[i] = glm::vec2(u, static_cast<float>(std::acos(glm::clamp(positions[i].y, -1.0f, 1.0f)) / M_PI));
+        }
+
+        RichWerks::Mesh sphere;
+        const auto addVertex = [&](const GLuint source, const glm::vec2 texCoord) {
+            const glm::vec3 normal = positions[source];
+            const glm::vec3 position = normal * radius;
+            sphere.vertexData.insert(sphere.vertexData.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, texCoord.x, texCoord.y });
+            return static_cast<GLuint>(sphere.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX - 1);
+        };
+        sphere.vertexData.reserve((positions.size() + positions.size() / 8) * RichWerks::FLOATS_PER_MESH_VERTEX);
+        for (size_t i = 0; i < positions.size(); ++i) {
+            addVertex(static_cast<GLuint>(i), texCoords[i]);
+        }
+
+        // A triangle whose u values span more than half a turn crosses the seam; its vertices on
+        // the u = 0 side use a copy with u + 1. The poles have no u of their own, so each pole
+        // triangle gets a pole vertex with the mean u of its other two corners.
+        std::vector<GLuint> seamCopies(positions.size(), UINT32_MAX);
+        sphere.indexData.reserve(triangles.size());
+        for (size_t i = 0; i < triangles.size(); i += 3) {
+            GLuint corners[3] = { triangles[i], triangles[i + 1], triangles[i + 2] };
+            glm::vec2 cornerTexCoords[3];
+            float uMin = 1.0f;
+            float uMax = 0.0f;
+            int pole = -1;
+            for (int corner = 0; corner < 3; ++corner) {
+                cornerTexCoords[corner] = texCoords[corners[corner]];
+                if (corners[corner] == NORTH_POLE || corners[corner] == SOUTH_POLE) {
+                    pole = corner;
+                    continue;
+                }
+                uMin = std::min(uMin, cornerTexCoords[corner].x);
+                uMax = std::max(uMax, cornerTexCoords[corner].x);
+            }
+            if (uMax - uMin > 0.5f) {
+                for (int corner = 0; corner < 3; ++corner) {
+                    if (corner == pole || cornerTexCoords[corner].x >= 0.5f) {
+                        continue;
+                    }
+                    GLuint& copy = seamCopies[corners[corner]];
+                    cornerTexCoords[corner].x += 1.0f;
+                    if (copy == UINT32_MAX) {
+                        copy = addVertex(corners[corner], cornerTexCoords[corner]);
+                    }
+                    corners[corner] = copy;
+                }
+            }
+            if (pole >= 0) {
+                const float u = (cornerTexCoords[(pole + 1) % 3].x + cornerTexCoords[(pole + 2) % 3].x) * 0.5f;
+                corners[pole] = addVertex(corners[pole], glm::vec2(u, cornerTexCoords[pole].y));
+            }
+            sphere.indexData.insert(sphere.indexData.end(), { corners[0], corners[1], corners[2] });
+        }
+
+        computeMeshBounds(sphere);
+        return sphere;
+    }
+
+    std::vector<RichWerks::ProfilePoint> cylinderProfile(const float radius, const float height) {
+        return {
+            { 0.0f, 0.0f, 0.0f, -1.0f, 0.0f },        // Bottom cap
+            { radius, 0.0f, 0.0f, -1.0f, 0.0f },
+            { radius, 0.0f, 1.0f, 0.0f, 0.0f },       // Body
+            { radius, height, 1.0f, 0.0f, 1.0f },
+            { radius, height, 0.0f, 1.0f, 1.0f },     // Top cap
+            { 0.0f, height, 0.0f, 1.0f, 1.0f },
+        };
+    }
+
+    std::vector<RichWerks::ProfilePoint> coneProfile(const float radius, const float height) {
+        // The side normal is perpendicular to the slant line from the rim to the apex.
+        const glm::vec2 slant = glm::normalize(glm::vec2(height, radius));
+        return {
+            { 0.0f, 0.0f, 0.0f, -1.0f, 0.0f },        // Base
+            { radius, 0.0f, 0.0f, -1.0f, 0.0f },
+            { radius, 0.0f, slant.x, slant.y, 0.0f }, // Side
+            { 0.0f, height, slant.x, slant.y, 1.0f },
+        };
+    }
+
+    std::vector<RichWerks::ProfilePoint> sphereProfile(const float radius, const int rings) {
+        // Bottom to top like every profile; v still runs from 0 at the top to 1 at the bottom,
+        // like generateSphere.
+        std::vector<RichWerks::ProfilePoint> profile(static_cast<size_t>(rings) + 1);
+        for (int ring = 0; ring <= rings; ++ring) {
+            const float theta = ring * static_cast<float>(M_PI / rings);
+            const float sinTheta = ring == rings ? 0.0f : std::sin(theta);
+            profile[rings - ring] = { radius * sinTheta, radius * std::cos(theta), sinTheta, std::cos(theta), static_cast<float>(ring) / rings };
+        }
+        return profile;
+    }
+
+    std::vector<RichWerks::ProfilePoint> torusProfile(const float outerRadius, const float innerRadius, const int segments) {
+        // The tube cross-section, closed with a duplicate of the first point for the v seam.
+        const std::shared_ptr<const RichWerks::AngleTable> angles = angleTable(segments);
+        std::vector<RichWerks::ProfilePoint> profile(static_cast<size_t>(segments) + 1);
+        for (int j = 0; j <= segments; ++j) {
+            const int wrapped = j % segments;
+            profile[j] = { outerRadius + innerRadius * angles->cosines[wrapped], innerRadius * angles->sines[wrapped],
+                angles->cosines[wrapped], angles->sines[wrapped], angles->u[j] };
+        }
+        return profile;
+    }
+
+    RichWerks::Mesh generateSphere(const float radius, const int divisions, RichWerks::ThreadPool& pool) {
+        RichWerks::Mesh sphere = allocateMesh(countSphere(divisions));
+        generateSphere(radius, divisions, sphere.vertexData.data(), sphere.indexData.data(), 0, pool);
+        computeMeshBounds(sphere);
+        return sphere;
+    }
+
+    RichWerks::Mesh generateTorus(const float outerRadius, const float innerRadius, const int segments, RichWerks::ThreadPool& pool) {
+        RichWerks::Mesh torus = allocateMesh(countTorus(segments));
+        generateTorus(outerRadius, innerRadius, segments, torus.vertexData.data(), torus.indexData.data(), 0, pool);
+        computeMeshBounds(torus);
+        return torus;
+    }
+
+    void generateCylinder(const float radius, const float height, const int segments, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        // cos/sin of every segment angle, shared by both caps and the body.
+        const std::shared_ptr<const RichWerks::AngleTable> angleData = angleTable(segments);
+        const RichWerks::AngleTable& angles = *angleData;
+
+        int firstIndex, nextIndex, vertexCount = 0;
 
         // Begin building the bottom cap of the cylinder.
-        firstIndex = cylinder.vertexData.size() / FLOATS_PER_VERT;
+        firstIndex = vertexCount;
         // Initial values for the center vertex of the bottom cap.
         float x = 0.0f, y = 0.0f, z = 0.0f, nX = 0.0f, nY = -1.0f, nZ = 0.0f;
         float u = 0.5f, v = 0.5f; // Initial texture coordinates for center vertex.
 
         // Add center vertex data for bottom cap.
-        cylinder.vertexData.insert(cylinder.vertexData.end(), { x, y, z, nX, nY, nZ, u, v });
+        vertexOut = writeVertex(vertexOut, x, y, z, nX, nY, nZ, u, v);
+        ++vertexCount;
 
         // Create the circular vertices for the bottom cap.
         for (int i = 0; i < segments; ++i) {
-            float currAngle = RADS_PER_SEG * i;
-            x = cos(currAngle) * radius;
-            z = sin(currAngle) * radius;
-            u = cos(currAngle) * 0.5f + 0.5f;
-            v = sin(currAngle) * 0.5f + 0.5f;
+            x = angles.cosines[i] * radius;
+            z = angles.sines[i] * radius;
+            u = angles.cosines[i] * 0.5f + 0.5f;
+            v = angles.sines[i] * 0.5f + 0.5f;
             // Add the vertex data.
-            cylinder.vertexData.insert(cylinder.vertexData.end(), { x, y, z, nX, nY, nZ, u, v });
+            vertexOut = writeVertex(vertexOut, x, y, z, nX, nY, nZ, u, v);
+            ++vertexCount;
         }
 
         // Index the bottom cap.
         nextIndex = firstIndex;
         for (int i = 0; i < segments; ++i) {
-            cylinder.indexData.push_back(firstIndex);
-            cylinder.indexData.push_back(nextIndex + 1);
-            cylinder.indexData.push_back((i + 1 == segments ? firstIndex + 1 : nextIndex + 2));
+            indexOut = writeTriangle(indexOut, baseIndex, firstIndex, nextIndex + 1, (i + 1 == segments ? firstIndex + 1 : nextIndex + 2));
             nextIndex += 1;
         }
 
         // Begin building the top cap of the cylinder.
-        firstIndex = cylinder.vertexData.size() / FLOATS_PER_VERT;
+        firstIndex = vertexCount;
         y = height;  // Adjust y to the height for the top cap.
         nY = 1.0f;   // Adjust normal Y direction for top cap.
-        cylinder.vertexData.insert(cylinder.vertexData.end(), { x, y, z, nX, nY, nZ, u, v });
+        vertexOut = writeVertex(vertexOut, x, y, z, nX, nY, nZ, u, v);
+        ++vertexCount;
 
         // Create the circular vertices for the top cap.
         for (int i = 0; i < segments; ++i) {
-            float currAngle = RADS_PER_SEG * i;
-            x = cos(currAngle) * radius;
-            z = sin(currAngle) * radius;
-            u = cos(currAngle) * 0.5f + 0.5f;
-            v = sin(currAngle) * 0.5f + 0.5f;
-            cylinder.vertexData.insert(cylinder.vertexData.end(), { x, y, z, nX, nY, nZ, u, v });
+            x = angles.cosines[i] * radius;
+            z = angles.sines[i] * radius;
+            u = angles.cosines[i] * 0.5f + 0.5f;
+            v = angles.sines[i] * 0.5f + 0.5f;
+            vertexOut = writeVertex(vertexOut, x, y, z, nX, nY, nZ, u, v);
+            ++vertexCount;
         }
 
         // Index the top cap.
         nextIndex = firstIndex;
         for (int i = 0; i < segments; ++i) {
-            cylinder.indexData.push_back(firstIndex);
-            cylinder.indexData.push_back(nextIndex + 1);
-            cylinder.indexData.push_back((i + 1 == segments ? firstIndex + 1 : nextIndex + 2));
+            indexOut = writeTriangle(indexOut, baseIndex, firstIndex, nextIndex + 1, (i + 1 == segments ? firstIndex + 1 : nextIndex + 2));
             nextIndex += 1;
         }
 
         // Begin building the body of the cylinder.
-        firstIndex = cylinder.vertexData.size() / FLOATS_PER_VERT;
+        firstIndex = vertexCount;
         for (int i = 0; i <= segments + 1; ++i) {
-            float currAngle = RADS_PER_SEG * i;
-            x = cos(currAngle) * radius;
-            z = sin(currAngle) * radius;
-            nX = cos(currAngle);
-            nZ = sin(currAngle);
+            x = angles.cosines[i] * radius;
+            z = angles.sines[i] * radius;
+            nX = angles.cosines[i];
+            nZ = angles.sines[i];
             u = static_cast<float>(i * 1.0f / segments);
             v = 0.0f;
-            cylinder.vertexData.insert(cylinder.vertexData.end(), { x, 0, z, nX, 0, nZ, u, v });
+            vertexOut = writeVertex(vertexOut, x, 0, z, nX, 0, nZ, u, v);
             v = 1.0f;
-            cylinder.vertexData.insert(cylinder.vertexData.end(), { x, height, z, nX, 0, nZ, u, v });
+            vertexOut = writeVertex(vertexOut, x, height, z, nX, 0, nZ, u, v);
         }
 
         // Index the body of the cylinder.
         nextIndex = firstIndex;
         for (int i = 0; i <= segments; ++i) {
-            GLshort leftTriangle[3] = { nextIndex, nextIndex + 1, nextIndex + 3 };
-            GLshort rightTriangle[3] = { nextIndex + 3, nextIndex + 2, nextIndex };
-            cylinder.indexData.insert(cylinder.indexData.end(), { leftTriangle[0], leftTriangle[1], leftTriangle[2], rightTriangle[0], rightTriangle[1], rightTriangle[2] });
+            indexOut = writeTriangle(indexOut, baseIndex, nextIndex, nextIndex + 1, nextIndex + 3);
+            indexOut = writeTriangle(indexOut, baseIndex, nextIndex + 3, nextIndex + 2, nextIndex);
             nextIndex += 2;
         }
-
-        return cylinder;
     }
 
 
-    // This function is identical, but adds pos.x,y,z to vertex.x,y,z to place the cube in world space.
-    RichWerks::Mesh generateCube(const float length, const float width, const float height) {
-        RichWerks::Mesh cube;
-        cube.size = glm::vec3(width, height, length);
-        int i = 0;
-        float x, y, z, nX, nY, nZ, u, v;
-
-        //Front square
-        // Bottom Left
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (length / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = 1.0f;
-        u = 0.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Bottom Right
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (length / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = 1.0f;
-        u = 1.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Right
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f + (length / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = 1.0f;
-        u = 1.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Left
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f + (length / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = 1.0f;
-        u = 0.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Add the indexData for this square
-        // left triangle
-        cube.indexData.push_back(i);
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 3);
-        
-        // right triangle
-        cube.indexData.push_back(i +1);
-        cube.indexData.push_back(i + 2);
-        cube.indexData.push_back(i + 3);
-
-        i += 4;
-
-        //Right square
-        // Bottom Left
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (length / 2.0f);
-        nX = 1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Bottom Right
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (length / 2.0f);
-        nX = 1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Right
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f - (length / 2.0f);
-        nX = 1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Left
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f + (length / 2.0f);
-        nX = 1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Add the indexData for this square
-        // left triangle
-        cube.indexData.push_back(i);
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 3);
-
-        // right triangle
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 2);
-        cube.indexData.push_back(i + 3);
-
-        i += 4;
-
-        //Back square
-        // Bottom Left
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (length / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = -1.0f;
-        u = 0.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Bottom Right
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (length / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = -1.0f;
-        u = 1.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Right
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f - (length / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = -1.0f;
-        u = 1.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Left
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f - (length / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = -1.0f;
-        u = 0.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Add the indexData for this square
-        // left triangle
-        cube.indexData.push_back(i);
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 3);
-
-        // right triangle
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 2);
-        cube.indexData.push_back(i + 3);
-
-        i += 4;
-
-        //Left square
-        // Bottom Left
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (length / 2.0f);
-        nX = -1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Bottom Right
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (length / 2.0f);
-        nX = -1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Right
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f + (length / 2.0f);
-        nX = -1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Left
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f - (length / 2.0f);
-        nX = -1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Add the indexData for this square
-        // left triangle
-        cube.indexData.push_back(i);
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 3);
-
-        // right triangle
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 2);
-        cube.indexData.push_back(i + 3);
-
-        i += 4;
-
-        //Top square
-        // Bottom Left
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f + (length / 2.0f);
-        nX = 0.0f;
-        nY = 1.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Bottom Right
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f + (length / 2.0f);
-        nX = 0.0f;
-        nY = 1.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Right
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f - (length / 2.0f);
-        nX = 0.0f;
-        nY = 1.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Left
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f + height;
-        z = 0.0f - (length / 2.0f);
-        nX = 0.0f;
-        nY = 1.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Add the indexData for this square
-        // left triangle
-        cube.indexData.push_back(i);
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 3);
-
-        // right triangle
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 2);
-        cube.indexData.push_back(i + 3);
-
-        i += 4;
-
-        //Bottom square
-        // Bottom Left
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (length / 2.0f);
-        nX = 0.0f;
-        nY = -1.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Bottom Right
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (length / 2.0f);
-        nX = 0.0f;
-        nY = -1.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 0.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Right
-        x = 0.0f + (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (length / 2.0f);
-        nX = 0.0f;
-        nY = -1.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Top Left
-        x = 0.0f - (width / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (length / 2.0f);
-        nX = 0.0f;
-        nY = -1.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 1.0f;
-        
-        // add the vertex
-        cube.vertexData.push_back(x);
-        cube.vertexData.push_back(y);
-        cube.vertexData.push_back(z);
-        cube.vertexData.push_back(nX);
-        cube.vertexData.push_back(nY);
-        cube.vertexData.push_back(nZ);
-        cube.vertexData.push_back(u);
-        cube.vertexData.push_back(v);
-
-        // Add the indexData for this square
-        // left triangle
-        cube.indexData.push_back(i);
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 3);
-
-        // right triangle
-        cube.indexData.push_back(i + 1);
-        cube.indexData.push_back(i + 2);
-        cube.indexData.push_back(i + 3);
-
-        return cube;
+    void generateCube(const float length, const float width, const float height, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        copyScaled(RichWerks::UNIT_CUBE_VERTICES, RichWerks::UNIT_CUBE_INDICES, glm::vec3(width, height, length), vertexOut, indexOut, baseIndex);
     }
 
-    RichWerks::Mesh generatePlane(const float length, const float width) {
-        RichWerks::Mesh plane;
-
-        // Set the dimensions of the plane.
-        plane.size = glm::vec3(width, 0.0f, length);
+    void generatePlane(const float length, const float width, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        copyScaled(RichWerks::UNIT_PLANE_VERTICES, RichWerks::UNIT_PLANE_INDICES, glm::vec3(width, 0.0f, length), vertexOut, indexOut, baseIndex);
+    }
 
-        float x, y, z, nX, nY, nZ, u, v;
-
-        // Each section below defines the vertex properties for a corner of the plane.
-
-        // Top Right vertex properties [0]
-        x = width / 2.0f;
-        y = 0.0f;
-        z = -length / 2.0f;
-        nX = 0.0f;
-        nY = 1.0f; // Normal pointing upwards for plane.
-        nZ = 0.0f;
-        u = 1.0f;  // Texture coordinate for top right corner.
-        v = 1.0f;
-        plane.vertexData.insert(plane.vertexData.end(), { x, y, z, nX, nY, nZ, u, v });
-
-        // Bottom Right vertex properties [1]
-        x = width / 2.0f;
-        z = length / 2.0f;
-        u = 1.0f;  // Texture coordinate for bottom right corner.
-        v = 0.0f;
-        plane.vertexData.insert(plane.vertexData.end(), { x, y, z, nX, nY, nZ, u, v });
-
-        // Bottom Left vertex properties [2]
-        x = -width / 2.0f;
-        u = 0.0f;  // Texture coordinate for bottom left corner.
-        v = 0.0f;
-        plane.vertexData.insert(plane.vertexData.end(), { x, y, z, nX, nY, nZ, u, v });
-
-        // Top Left vertex properties
-        z = -length / 2.0f;
-        u = 0.0f;  // Texture coordinate for top left corner.
-        v = 1.0f;
-        plane.vertexData.insert(plane.vertexData.end(), { x, y, z, nX, nY, nZ, u, v });
-
-        // Define the indices that make up the two triangles of the plane.
-        // The plane is divided into 2 triangles: 
-        // 1. TopRight -> BottomLeft -> BottomRight
-        // 2. TopRight -> BottomLeft -> TopLeft
-        plane.indexData = {
-            0, 2, 1,
-            0, 2, 3
-        };
+    void generatePlane(const float length, const float width, const int divisions, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        const float step = 1.0f / divisions;
+        for (int row = 0; row <= divisions; ++row) {
+            const float v = row * step;
+            for (int column = 0; column <= divisions; ++column) {
+                const float u = column * step;
+                vertexOut = writeVertex(vertexOut, (u - 0.5f) * width, 0.0f, (0.5f - v) * length, 0.0f, 1.0f, 0.0f, u, v);
+            }
+        }
 
-        return plane;
+        // Counter-clockwise from above, like the single-quad plane.
+        for (int row = 0; row < divisions; ++row) {
+            for (int column = 0; column < divisions; ++column) {
+                const int current = row * (divisions + 1) + column;
+                const int next = current + divisions + 1;
+                indexOut = writeTriangle(indexOut, baseIndex, current, current + 1, next);
+                indexOut = writeTriangle(indexOut, baseIndex, current + 1, next + 1, next);
+            }
+        }
     }
 
+    void generatePyramid(const float baseLength, const float height, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        copyScaled(RichWerks::UNIT_PYRAMID_VERTICES, RichWerks::UNIT_PYRAMID_INDICES, glm::vec3(baseLength, height, baseLength), vertexOut, indexOut, baseIndex);
+    }
 
-    // generate pyramid. Add texture and color parameters
-    RichWerks::Mesh generatePyramid(const float baseLength, const float height) {
-        RichWerks::Mesh pyramid;
-        pyramid.size = glm::vec3(baseLength, height, baseLength);
-        float x, y, z, nX, nY, nZ, u, v;
-
-        // Triangle vertices that make up the pyramid (4 triangles make up the sides, 2 triangles make up the square base)
-        int i = -1;
-        // Trangle Front
-        // Top
-        x = 0.0;
-        y = 0.0f + height;
-        z = 0.0f;
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = 1.0f;
-        u = 0.5f;
-        v = 1.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Bottom left
-        x = 0.0 - (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (baseLength / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = 1.0f;
-        u = 0.0f;
-        v = 0.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-
-        // Bottom bottom right
-        x = 0.0 + (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (baseLength / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = 1.0f;
-        u = 1.0f;
-        v = 0.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Right triangle
-       // Top
-        x = 0.0;
-        y = 0.0f + height;
-        z = 0.0f;
-        nX = 1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 0.5f;
-        v = 1.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Bottom left
-        x = 0.0f + (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (baseLength / 2.0f);
-        nX = 1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 0.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Bottom bottom right
-        x = 0.0f + (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (baseLength / 2.0f);
-        nX = 1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 0.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Back triangle
-       // Top
-        x = 0.0f;
-        y = 0.0f + height;
-        z = 0.0f;
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = -1.0f;
-        u = 0.5f;
-        v = 1.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Bottom left
-        x = 0.0f + (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (baseLength / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = -1.0f;
-        u = 0.0f;
-        v = 0.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Bottom bottom right
-        x = 0.0f - (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (baseLength / 2.0f);
-        nX = 0.0f;
-        nY = 0.0f;
-        nZ = -1.0f;
-        u = 1.0f;
-        v = 0.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Left triangle
-       // Top
-        x = 0.0f;
-        y = 0.0f + height;
-        z = 0.0f;
-        nX = -1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 0.5f;
-        v = 1.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Bottom left
-        x = 0.0 - (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (baseLength / 2.0f);
-        nX = -1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 0.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Bottom  right
-        x = 0.0 - (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (baseLength / 2.0f);
-        nX = -1.0f;
-        nY = 0.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 0.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        pyramid.indexData.push_back(++i);
-
-        // Base of pyramid
-        // Front-left
-        x = 0.0f - (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (baseLength / 2.0f);
-        nX = 0.0f;
-        nY = -1.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 0.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        // Base of pyramid
-        // Front-right
-        x = 0.0 + (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f + (baseLength / 2.0f);
-        nX = 0.0f;
-        nY = -1.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 0.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        // Base of pyramid
-        // Back-right
-        x = 0.0 + (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (baseLength / 2.0f);
-        nX = 0.0f;
-        nY = -1.0f;
-        nZ = 0.0f;
-        u = 1.0f;
-        v = 1.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        // Base of pyramid
-        // Back-left
-        x = 0.0 - (baseLength / 2.0f);
-        y = 0.0f;
-        z = 0.0f - (baseLength / 2.0f);
-        nX = 0.0f;
-        nY = -1.0f;
-        nZ = 0.0f;
-        u = 0.0f;
-        v = 1.0f;
-
-        // add the vertex
-        pyramid.vertexData.push_back(x);
-        pyramid.vertexData.push_back(y);
-        pyramid.vertexData.push_back(z);
-        pyramid.vertexData.push_back(nX);
-        pyramid.vertexData.push_back(nY);
-        pyramid.vertexData.push_back(nZ);
-        pyramid.vertexData.push_back(u);
-        pyramid.vertexData.push_back(v);
-
-        ++i;
-        pyramid.indexData.push_back(i);
-        pyramid.indexData.push_back(i + 1);
-        pyramid.indexData.push_back(i + 3);
-
-        pyramid.indexData.push_back(i + 1);
-        pyramid.indexData.push_back(i + 2);
-        pyramid.indexData.push_back(i + 3);
-
-        return pyramid;
+    void generateSphere(const float radius, const int divisions, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        const std::shared_ptr<const RichWerks::AngleTable> sectorAngles = angleTable(divisions);
+        writeSphereRings(radius, divisions, *sectorAngles, 0, divisions + 1, vertexOut, indexOut, baseIndex);
     }
 
-    RichWerks::Mesh generateSphere(const float radius, const int divisions) {
-        RichWerks::Mesh sphere;
-        const int rings = divisions;
-        const int sectors = divisions;
-        // Calculate the number of vertices and indices needed
-        //const int numVertices = (rings + 1) * (sectors + 1);
-        //const int numIndices = rings * sectors * 6; // 2 triangles per sector, 3 indices per triangle
+    void generateTorus(const float outerRadius, const float innerRadius, const int segments, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        const std::shared_ptr<const RichWerks::AngleTable> angles = angleTable(segments);
+        writeTorusRings(outerRadius, innerRadius, segments, *angles, 0, segments, vertexOut, indexOut, baseIndex);
+    }
 
-        // Reserve space for vertices and indices to avoid reallocations
-        //sphere.vertexData.reserve(numVertices * 8); // Each vertex has 8 floats (3 pos, 3 norm, 2 tex)
-        //sphere.indexData.reserve(numIndices);
+    void generateSphere(const float radius, const int divisions, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex, RichWerks::ThreadPool& pool) {
+        const std::shared_ptr<const RichWerks::AngleTable> sectorAngles = angleTable(divisions);
+        forEachRowChunk(pool, divisions + 1, divisions + 1, [&](const int ringBegin, const int ringEnd) {
+            writeSphereRings(radius, divisions, *sectorAngles, ringBegin, ringEnd, vertexOut, indexOut, baseIndex);
+        });
+    }
 
-        // Calculate angles
-        const float RADS_PER_RING = M_PI / rings;
-        const float RADS_PER_SECTOR = 2.0f * M_PI / sectors;
+    void generateTorus(const float outerRadius, const float innerRadius, const int segments, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex, RichWerks::ThreadPool& pool) {
+        const std::shared_ptr<const RichWerks::AngleTable> angles = angleTable(segments);
+        forEachRowChunk(pool, segments, segments, [&](const int ringBegin, const int ringEnd) {
+            writeTorusRings(outerRadius, innerRadius, segments, *angles, ringBegin, ringEnd, vertexOut, indexOut, baseIndex);
+        });
+    }
 
-        for (int ring = 0; ring <= rings; ++ring) {
-            for (int sector = 0; sector <= sectors; ++sector) {
-                const float theta = ring * RADS_PER_RING;
-                const float phi = sector * RADS_PER_SECTOR;
+    void generateLathe(const std::vector<RichWerks::ProfilePoint>& profile, const int segments, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        const std::shared_ptr<const RichWerks::AngleTable> angles = angleTable(segments);
+        const int columns = segments + 1;
+        for (size_t row = 0; row < profile.size(); ++row) {
+            writeLatheRow(profile[row], *angles, columns, vertexOut + row * columns * RichWerks::FLOATS_PER_MESH_VERTEX);
+        }
 
-                const float x = radius * sin(theta) * cos(phi);
-                const float y = radius * cos(theta);
-                const float z = radius * sin(theta) * sin(phi);
+        // Same quad split as generateSphere; one triangle per quad where a row sits on the axis.
+        for (size_t row = 0; row + 1 < profile.size(); ++row) {
+            if (!latheSpanUsed(profile[row], profile[row + 1])) {
+                continue;
+            }
+            const bool rowOnAxis = profile[row].radius == 0.0f;
+            const bool nextOnAxis = profile[row + 1].radius == 0.0f;
+            for (int column = 0; column < segments; ++column) {
+                const int current = static_cast<int>(row) * columns + column;
+                const int next = current + columns;
+                if (!rowOnAxis) {
+                    indexOut = writeTriangle(indexOut, baseIndex, current, next, current + 1);
+                }
+                if (!nextOnAxis) {
+                    indexOut = writeTriangle(indexOut, baseIndex, current + 1, next, next + 1);
+                }
+            }
+        }
+    }
 
-                const float u = static_cast<float>(sector) / sectors;
-                const float v = static_cast<float>(ring) / rings;
+    void generateCone(const float radius, const float height, const int segments, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex) {
+        generateLathe(coneProfile(radius, height), segments, vertexOut, indexOut, baseIndex);
+    }
 
-                sphere.vertexData.push_back(x);
-                sphere.vertexData.push_back(y);
-                sphere.vertexData.push_back(z);
+    void computeVertexBounds(const GLfloat* vertexIn, const size_t count, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+        boundsMin = glm::vec3(count > 0 ? vertexIn[0] : 0.0f, count > 0 ? vertexIn[1] : 0.0f, count > 0 ? vertexIn[2] : 0.0f);
+        boundsMax = boundsMin;
+        for (size_t i = 0; i < count; ++i, vertexIn += RichWerks::FLOATS_PER_MESH_VERTEX) {
+            const glm::vec3 position(vertexIn[0], vertexIn[1], vertexIn[2]);
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+        }
+    }
 
-                const glm::vec3 normal = glm::normalize(glm::vec3(x, y, z));
-                sphere.vertexData.push_back(normal.x);
-                sphere.vertexData.push_back(normal.y);
-                sphere.vertexData.push_back(normal.z);
+    void computeMeshBounds(RichWerks::Mesh& mesh) {
+        const size_t count = mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+        RichWerks::BoundingVolume& bounds = mesh.bounds;
+        bounds = RichWerks::BoundingVolume();
+        if (count == 0) {
+            return;
+        }
+        const GLfloat* vertices = mesh.vertexData.data();
+        const auto positionAt = [vertices](const size_t i) {
+            const GLfloat* vertex = vertices + i * RichWerks::FLOATS_PER_MESH_VERTEX;
+            return glm::vec3(vertex[0], vertex[1], vertex[2]);
+        };
+        computeVertexBounds(vertices, count, bounds.boxMin, bounds.boxMax);
+
+        // Sphere around the box center.
+        const glm::vec3 boxCenter = (bounds.boxMin + bounds.boxMax) * 0.5f;
+        GLfloat boxRadiusSquared = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec3 offset = positionAt(i) - boxCenter;
+            boxRadiusSquared = std::max(boxRadiusSquared, glm::dot(offset, offset));
+        }
 
-                sphere.vertexData.push_back(u);
-                sphere.vertexData.push_back(v);
+        // Ritter: start from the two points furthest apart along the axis with the widest
+        // spread, then grow the sphere over every point outside it.
+        size_t minIndex[3] = { 0, 0, 0 };
+        size_t maxIndex[3] = { 0, 0, 0 };
+        for (size_t i = 1; i < count; ++i) {
+            const glm::vec3 position = positionAt(i);
+            for (int axis = 0; axis < 3; ++axis) {
+                if (position[axis] < positionAt(minIndex[axis])[axis]) {
+                    minIndex[axis] = i;
+                }
+                if (position[axis] > positionAt(maxIndex[axis])[axis]) {
+                    maxIndex[axis] = i;
+                }
             }
         }
-
-        for (int ring = 0; ring < rings; ++ring) {
-            for (int sector = 0; sector < sectors; ++sector) {
-                const int current = ring * (sectors + 1) + sector;
-                const int next = current + sectors + 1;
-
-                sphere.indexData.push_back(current);
-                sphere.indexData.push_back(next);
-                sphere.indexData.push_back(current + 1);
-
-                sphere.indexData.push_back(current + 1);
-                sphere.indexData.push_back(next);
-                sphere.indexData.push_back(next + 1);
+        GLfloat widestSpread = -1.0f;
+        glm::vec3 center(0.0f);
+        GLfloat radius = 0.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            const glm::vec3 a = positionAt(minIndex[axis]);
+            const glm::vec3 b = positionAt(maxIndex[axis]);
+            const GLfloat spread = glm::dot(b - a, b - a);
+            if (spread > widestSpread) {
+                widestSpread = spread;
+                center = (a + b) * 0.5f;
+                radius = std::sqrt(spread) * 0.5f;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec3 offset = positionAt(i) - center;
+            const GLfloat distanceSquared = glm::dot(offset, offset);
+            if (distanceSquared > radius * radius) {
+                const GLfloat distance = std::sqrt(distanceSquared);
+                const GLfloat grownRadius = (radius + distance) * 0.5f;
+                center += offset * ((grownRadius - radius) / distance);
+                radius = grownRadius;
             }
         }
+        // Float rounding while growing can leave a point a hair outside; one pass fixes that.
+        GLfloat ritterRadiusSquared = radius * radius;
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec3 offset = positionAt(i) - center;
+            ritterRadiusSquared = std::max(ritterRadiusSquared, glm::dot(offset, offset));
+        }
 
-        return sphere;
+        if (ritterRadiusSquared < boxRadiusSquared) {
+            bounds.center = center;
+            bounds.radius = std::sqrt(ritterRadiusSquared);
+        }
+        else {
+            bounds.center = boxCenter;
+            bounds.radius = std::sqrt(boxRadiusSquared);
+        }
     }
 
-    RichWerks::Mesh generateTorus(const float outerRadius, const float innerRadius, const int segments) {
-        RichWerks::Mesh torus;
-        const int majorSegments = segments;
-        const int minorSegments = segments;
-        float x, y, z, nX, nY, nZ, u, v;
-        int indexCounter = 0;
-
-        const float majorRadsPerSeg = (2 * glm::pi<float>()) / majorSegments;
-        const float minorRadsPerSeg = (2 * glm::pi<float>()) / minorSegments;
-
-        for (int i = 0; i < majorSegments; ++i) {
-            for (int j = 0; j < minorSegments; ++j) {
-                float majorCurrAngle = majorRadsPerSeg * i;
-                float minorCurrAngle = minorRadsPerSeg * j;
-
-                // Calculate vertex position
-                x = (outerRadius + innerRadius * cos(minorCurrAngle)) * cos(majorCurrAngle);
-                y = innerRadius * sin(minorCurrAngle);
-                z = (outerRadius + innerRadius * cos(minorCurrAngle)) * sin(majorCurrAngle);
-
-                // Calculate vertex normal
-                nX = cos(majorCurrAngle) * cos(minorCurrAngle);
-                nY = sin(minorCurrAngle);
-                nZ = sin(majorCurrAngle) * cos(minorCurrAngle);
-
-                // Calculate texture coordinates
-                u = static_cast<float>(i) / majorSegments;
-                v = static_cast<float>(j) / minorSegments;
-
-                // Add the vertex
-                torus.vertexData.push_back(x);
-                torus.vertexData.push_back(y);
-                torus.vertexData.push_back(z);
-                torus.vertexData.push_back(nX);
-                torus.vertexData.push_back(nY);
-                torus.vertexData.push_back(nZ);
-                torus.vertexData.push_back(u);
-                torus.vertexData.push_back(v);
-
-                // Calculate indices for the triangles
-                int nextRow = (j + 1) % minorSegments;
-                int nextCol = (i + 1) % majorSegments;
-
-                int currentIndex = j * majorSegments + i;
-                int nextRowIndex = nextRow * majorSegments + i;
-                int nextColIndex = j * majorSegments + nextCol;
-                int nextRowNextColIndex = nextRow * majorSegments + nextCol;
-
-                // Add indices for the two triangles
-                torus.indexData.push_back(currentIndex);
-                torus.indexData.push_back(nextRowIndex);
-                torus.indexData.push_back(nextColIndex);
-
-                torus.indexData.push_back(nextRowIndex);
-                torus.indexData.push_back(nextRowNextColIndex);
-                torus.indexData.push_back(nextColIndex);
+    RichWerks::BoundingVolume mergeBounds(const RichWerks::BoundingVolume& a, const RichWerks::BoundingVolume& b) {
+        if (a.IsEmpty()) {
+            return b;
+        }
+        if (b.IsEmpty()) {
+            return a;
+        }
+        RichWerks::BoundingVolume merged;
+        merged.boxMin = glm::min(a.boxMin, b.boxMin);
+        merged.boxMax = glm::max(a.boxMax, b.boxMax);
+
+        const glm::vec3 offset = b.center - a.center;
+        const GLfloat distance = glm::length(offset);
+        if (distance + b.radius <= a.radius) {
+            merged.center = a.center;
+            merged.radius = a.radius;
+        }
+        else if (distance + a.radius <= b.radius) {
+            merged.center = b.center;
+            merged.radius = b.radius;
+        }
+        else {
+            merged.radius = (distance + a.radius + b.radius) * 0.5f;
+            merged.center = a.center + offset * ((merged.radius - a.radius) / distance);
+        }
+        return merged;
+    }
 
-                indexCounter += 6; // 6 indices were added for the two triangles
+    RichWerks::BoundingVolume transformBounds(const RichWerks::BoundingVolume& bounds, const glm::mat4& transform) {
+        if (bounds.IsEmpty()) {
+            return bounds;
+        }
+        RichWerks::BoundingVolume transformed;
+        const glm::vec3 translation(transform[3]);
+        transformed.boxMin = translation;
+        transformed.boxMax = translation;
+        for (int column = 0; column < 3; ++column) {
+            for (int row = 0; row < 3; ++row) {
+                const GLfloat a = transform[column][row] * bounds.boxMin[column];
+                const GLfloat b = transform[column][row] * bounds.boxMax[column];
+                transformed.boxMin[row] += std::min(a, b);
+                transformed.boxMax[row] += std::max(a, b);
             }
         }
 
-        return torus;
+        const GLfloat maxScale = std::sqrt(std::max(glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+            std::max(glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])), glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2])))));
+        transformed.center = glm::vec3(transform * glm::vec4(bounds.center, 1.0f));
+        transformed.radius = bounds.radius * maxScale;
+        return transformed;
     }
 
-    void rotateMesh(RichWerks::Mesh& mesh, const float radians, const glm::vec3 axes) {
-        glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0f), radians, axes);
+    RichWerks::BoundingVolume computeProceduralBounds(const RichWerks::ProceduralMesh& mesh) {
+        const glm::vec3 parameters = mesh.parameters;
+        RichWerks::BoundingVolume bounds;
+        switch (mesh.shape) {
+        case RichWerks::ProceduralShape::PLANE:
+            bounds.boxMax = glm::vec3(parameters.y, 0.0f, parameters.x) * 0.5f;
+            bounds.boxMin = -bounds.boxMax;
+            bounds.radius = glm::length(bounds.boxMax);
+            break;
+        case RichWerks::ProceduralShape::CYLINDER:
+            bounds.boxMin = glm::vec3(-parameters.x, 0.0f, -parameters.x);
+            bounds.boxMax = glm::vec3(parameters.x, parameters.y, parameters.x);
+            bounds.center = glm::vec3(0.0f, parameters.y * 0.5f, 0.0f);
+            bounds.radius = glm::length(glm::vec2(parameters.x, parameters.y * 0.5f));
+            break;
+        case RichWerks::ProceduralShape::SPHERE:
+            bounds.boxMin = glm::vec3(-parameters.x);
+            bounds.boxMax = glm::vec3(parameters.x);
+            bounds.radius = parameters.x;
+            break;
+        case RichWerks::ProceduralShape::TORUS:
+            bounds.boxMax = glm::vec3(parameters.x + parameters.y, parameters.y, parameters.x + parameters.y);
+            bounds.boxMin = -bounds.boxMax;
+            bounds.radius = parameters.x + parameters.y;
+            break;
+        default:
+            return bounds;
+        }
 
-        for (int i = 0; i < mesh.vertexData.size(); i += 8) {
-            glm::vec4 vertPosition(mesh.vertexData[i], mesh.vertexData[i + 1], mesh.vertexData[i + 2], 1.0f);
-            glm::vec4 newPosition = rotationMatrix * vertPosition;
+        if (mesh.instanceTransforms.empty()) {
+            return bounds;
+        }
+        RichWerks::BoundingVolume instances;
+        for (const glm::mat4& transform : mesh.instanceTransforms) {
+            instances = mergeBounds(instances, transformBounds(bounds, transform));
+        }
+        return instances;
+    }
 
-            mesh.vertexData[i] = newPosition.x;
-            mesh.vertexData[i + 1] = newPosition.y;
-            mesh.vertexData[i + 2] = newPosition.z;
+    void extractFrustumPlanes(const glm::mat4& clip, glm::vec4 planes[6]) {
+        for (int axis = 0; axis < 3; ++axis) {
+            for (int side = 0; side < 2; ++side) {
+                glm::vec4& plane = planes[axis * 2 + side];
+                for (int column = 0; column < 4; ++column) {
+                    plane[column] = clip[column][3] + (side == 0 ? clip[column][axis] : -clip[column][axis]);
+                }
+                plane /= glm::length(glm::vec3(plane));
+            }
+        }
+    }
 
-            // Rotate normals using the same rotation matrix
-            glm::vec4 vertNormal(mesh.vertexData[i + 3], mesh.vertexData[i + 4], mesh.vertexData[i + 5], 0.0f);
-            glm::vec4 newNormal = rotationMatrix * vertNormal;
+    bool isBoxInFrustum(const glm::vec3 boxMin, const glm::vec3 boxMax, const glm::vec4 planes[6]) {
+        for (int i = 0; i < 6; ++i) {
+            // The box corner furthest along the plane normal.
+            const glm::vec3 normal(planes[i]);
+            const glm::vec3 corner(normal.x >= 0.0f ? boxMax.x : boxMin.x, normal.y >= 0.0f ? boxMax.y : boxMin.y, normal.z >= 0.0f ? boxMax.z : boxMin.z);
+            if (glm::dot(normal, corner) + planes[i].w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
 
-            mesh.vertexData[i + 3] = newNormal.x;
-            mesh.vertexData[i + 4] = newNormal.y;
-            mesh.vertexData[i + 5] = newNormal.z;
+    void packCompactVertices(const GLfloat* vertexIn, const size_t count, const glm::vec3 boundsMin, const glm::vec3 boundsMax, RichWerks::CompactVertex* vertexOut) {
+        const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        const glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+        // Flat axes (e.g. y of a plane) have no extent; store them as 0 rather than dividing by it.
+        const glm::vec3 inverseExtent(extent.x > 0.0f ? 1.0f / extent.x : 0.0f, extent.y > 0.0f ? 1.0f / extent.y : 0.0f, extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+        for (size_t i = 0; i < count; ++i, vertexIn += RichWerks::FLOATS_PER_MESH_VERTEX, ++vertexOut) {
+            const glm::vec3 position = glm::clamp((glm::vec3(vertexIn[0], vertexIn[1], vertexIn[2]) - center) * inverseExtent, -1.0f, 1.0f);
+            vertexOut->position[0] = static_cast<GLshort>(std::round(position.x * 32767.0f));
+            vertexOut->position[1] = static_cast<GLshort>(std::round(position.y * 32767.0f));
+            vertexOut->position[2] = static_cast<GLshort>(std::round(position.z * 32767.0f));
+            vertexOut->position[3] = 0;
+            vertexOut->normal = glm::packSnorm3x10_1x2(glm::vec4(vertexIn[3], vertexIn[4], vertexIn[5], 0.0f));
+            vertexOut->texCoord[0] = glm::packHalf1x16(vertexIn[6]);
+            vertexOut->texCoord[1] = glm::packHalf1x16(vertexIn[7]);
         }
     }
 
-    void translateMesh(RichWerks::Mesh& mesh, const glm::vec3 t_position){
-        glm::mat4 translationMatrix = glm::translate(glm::mat4(1.0f), t_position);
+    void transformMesh(RichWerks::Mesh& mesh, const glm::mat4& transform) {
+        // Normals need the inverse-transpose so they stay perpendicular under non-uniform scale.
+        const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+        const size_t count = mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+        glm::vec3 boundsMin(std::numeric_limits<GLfloat>::max());
+        glm::vec3 boundsMax(-std::numeric_limits<GLfloat>::max());
+        transformVertices(mesh.vertexData.data(), count, transform, normalMatrix, boundsMin, boundsMax);
+        if (count == 0 || mesh.bounds.IsEmpty()) {
+            computeMeshBounds(mesh);
+            return;
+        }
+        // The box comes exact out of the pass; the sphere is carried over, which stays
+        // conservative without another pass over the vertices.
+        mesh.bounds = transformBounds(mesh.bounds, transform);
+        mesh.bounds.boxMin = boundsMin;
+        mesh.bounds.boxMax = boundsMax;
+    }
 
-        for (int i = 0; i < mesh.vertexData.size(); i += 8) {
-            glm::vec4 originalPos(glm::vec3(mesh.vertexData[i], mesh.vertexData[i + 1], mesh.vertexData[i + 2]), 1.0f);
-            glm::vec4 newPosition = translationMatrix * originalPos;
+    void rotateMesh(RichWerks::Mesh& mesh, const float radians, const glm::vec3 axes) {
+        transformMesh(mesh, glm::rotate(glm::mat4(1.0f), radians, axes));
+    }
 
-            mesh.vertexData[i] = newPosition.x;
-            mesh.vertexData[i + 1] = newPosition.y;
-            mesh.vertexData[i + 2] = newPosition.z;
-        }
+    void translateMesh(RichWerks::Mesh& mesh, const glm::vec3 t_position){
+        transformMesh(mesh, glm::translate(glm::mat4(1.0f), t_position));
     }
-}
\ No newline at end of file
+}
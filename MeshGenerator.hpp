@@ -17,10 +17,57 @@
 #include <cmath>
 #include <glm/glm.hpp>     // Include the GLFW library
 #include "UGLProp.hpp"     // Include the UGLProp header
+#include "MeshPrimitives.hpp"  // Unit cube, pyramid and plane tables
+#include "ThreadPool.hpp"      // Parallel sphere/torus generation
 #pragma once
 
+namespace RichWerks {
+    // Number of floats in one interleaved vertex: position (3), normal (3), texture coordinate (2).
+    const int FLOATS_PER_MESH_VERTEX = 8;
+
+    // Exact number of vertices and indices a generator writes. Sum these to size one shared
+    // buffer, then generate every primitive into it without a single reallocation.
+    struct MeshCounts {
+        size_t vertexCount;
+        size_t indexCount;
+    };
+
+    // cos/sin (and the matching u texture coordinate) of i * 2pi / segments for i in
+    // [0, segments + 1], so generators that wrap around an axis never call cos/sin per vertex.
+    struct AngleTable {
+        std::vector<GLfloat> cosines;
+        std::vector<GLfloat> sines;
+        std::vector<GLfloat> u;
+    };
+
+    // One point of a lathe profile in the XY half-plane, revolved around the Y axis.
+    // Repeat a point with a different normal for a hard edge (no triangles join the two).
+    struct ProfilePoint {
+        GLfloat radius;         // Distance from the Y axis; 0 closes the surface with a fan
+        GLfloat height;         // Y
+        GLfloat normalRadial;   // Normal component pointing away from the axis
+        GLfloat normalY;
+        GLfloat v;              // Texture coordinate along the profile
+    };
+}
+
 // This library will be part of the namespace "std"
 namespace std {
+    // Exact output sizes for each generator.
+    RichWerks::MeshCounts countCylinder(const int segments);
+    RichWerks::MeshCounts countCube();
+    RichWerks::MeshCounts countPlane();
+    RichWerks::MeshCounts countPlane(const int divisions);
+    RichWerks::MeshCounts countPyramid();
+    RichWerks::MeshCounts countSphere(const int divisions);
+    RichWerks::MeshCounts countTorus(const int segments);
+    RichWerks::MeshCounts countLathe(const std::vector<RichWerks::ProfilePoint>& profile, const int segments);
+    RichWerks::MeshCounts countCone(const int segments);
+
+    // Shared angle table for a segment count. Tables are built once and cached for every
+    // later call (from any thread).
+    std::shared_ptr<const RichWerks::AngleTable> angleTable(const int segments);
+
     // Function declarations for generating primitive shapes.
 
     // Generate vertex and index data for a cylinder.
@@ -32,6 +79,11 @@ namespace std {
     // Generate vertex and index data for a plane.
     RichWerks::Mesh generatePlane(const float length, const float width);
 
+    // Generate a plane split into divisions x divisions quads, with the same orientation, normal
+    // and 0..1 texture coordinates as the single-quad plane. Vertices run row by row along x,
+    // rows from +z/2 (v = 0) to -z/2 (v = 1).
+    RichWerks::Mesh generatePlane(const float length, const float width, const int divisions);
+
     // Generate vertex and index data for a pyramid.
     RichWerks::Mesh generatePyramid(const float baseLength, const float height);
 
@@ -41,6 +93,86 @@ namespace std {
     // Generate vertex and index data for a torus.
     RichWerks::Mesh generateTorus(const float outerRadius, const float innerRadius, const int segments);
 
+    // Revolve a profile around the Y axis in segments steps. Rows follow the profile, columns
+    // the angle, with a duplicated seam column so u runs from 0 to 1. Triangles are wound
+    // counter-clockwise seen from the side that lies to the right of the profile's direction
+    // (x to the right, y up): a profile running bottom to top faces away from the axis, and a
+    // closed one should run counter-clockwise around its cross-section. The built-in profiles follow this.
+    RichWerks::Mesh generateLathe(const std::vector<RichWerks::ProfilePoint>& profile, const int segments);
+
+    // Generate vertex and index data for a cone with its base on y = 0.
+    RichWerks::Mesh generateCone(const float radius, const float height, const int segments);
+
+    // Geodesic sphere: an icosahedron with each triangle split in four subdivisions times, every
+    // new vertex pushed out to the radius. Triangles stay close to equilateral everywhere, so for
+    // the same silhouette error it needs far fewer than generateSphere, which crowds them at the
+    // poles. Shared edges are split once, seam triangles get a duplicated u = 1 vertex and each
+    // pole triangle its own pole vertex, so UVs match generateSphere's (u around Y, v = 0 at top).
+    RichWerks::Mesh generateIcosphere(const float radius, const int subdivisions);
+
+    // Profiles for the lathe, each running bottom to top. The cylinder and cone include their caps.
+    std::vector<RichWerks::ProfilePoint> cylinderProfile(const float radius, const float height);
+    std::vector<RichWerks::ProfilePoint> coneProfile(const float radius, const float height);
+    std::vector<RichWerks::ProfilePoint> sphereProfile(const float radius, const int rings);
+    std::vector<RichWerks::ProfilePoint> torusProfile(const float outerRadius, const float innerRadius, const int segments);
+
+    // Span versions of the generators above. vertexOut must hold count*().vertexCount * FLOATS_PER_MESH_VERTEX
+    // floats and indexOut count*().indexCount indices. baseIndex is added to every index so several
+    // primitives can be written back to back into the same buffers.
+    void generateCylinder(const float radius, const float height, const int segments, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex = 0);
+    void generateCube(const float length, const float width, const float height, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex = 0);
+    void generatePlane(const float length, const float width, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex = 0);
+    void generatePlane(const float length, const float width, const int divisions, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex = 0);
+    void generatePyramid(const float baseLength, const float height, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex = 0);
+    void generateSphere(const float radius, const int divisions, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex = 0);
+    void generateTorus(const float outerRadius, const float innerRadius, const int segments, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex = 0);
+    void generateLathe(const std::vector<RichWerks::ProfilePoint>& profile, const int segments, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex = 0);
+    void generateCone(const float radius, const float height, const int segments, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex = 0);
+
+    // Sphere and torus split into chunks of rings across a thread pool, each chunk at least a few
+    // thousand vertices; smaller meshes are written on the calling thread. Each ring writes its own
+    // slice of the pre-sized buffers, so the output is identical to the single-threaded versions.
+    RichWerks::Mesh generateSphere(const float radius, const int divisions, RichWerks::ThreadPool& pool);
+    RichWerks::Mesh generateTorus(const float outerRadius, const float innerRadius, const int segments, RichWerks::ThreadPool& pool);
+    void generateSphere(const float radius, const int divisions, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex, RichWerks::ThreadPool& pool);
+    void generateTorus(const float outerRadius, const float innerRadius, const int segments, GLfloat* vertexOut, GLuint* indexOut, const GLuint baseIndex, RichWerks::ThreadPool& pool);
+
+    // Axis-aligned bounds of count interleaved vertices.
+    void computeVertexBounds(const GLfloat* vertexIn, const size_t count, glm::vec3& boundsMin, glm::vec3& boundsMax);
+
+    // Recompute mesh.bounds from its vertices: the exact AABB, and the tighter of the sphere
+    // around the AABB center and Ritter's sphere.
+    void computeMeshBounds(RichWerks::Mesh& mesh);
+
+    // Smallest volume holding both a and b (the sphere is exact for two spheres).
+    RichWerks::BoundingVolume mergeBounds(const RichWerks::BoundingVolume& a, const RichWerks::BoundingVolume& b);
+
+    // Bounds of a transformed volume: Arvo's method for the box, the sphere grows by the
+    // largest axis scale. Both stay conservative under rotation.
+    RichWerks::BoundingVolume transformBounds(const RichWerks::BoundingVolume& bounds, const glm::mat4& transform);
+
+    // Analytic bounds of a procedural mesh over all of its instances, without generating it.
+    RichWerks::BoundingVolume computeProceduralBounds(const RichWerks::ProceduralMesh& mesh);
+
+    // View frustum planes of a clip matrix (Gribb-Hartmann), as (normal, distance) with the
+    // normals pointing inwards and normalized, so plane distances are in the matrix's input units.
+    void extractFrustumPlanes(const glm::mat4& clip, glm::vec4 planes[6]);
+
+    // Whether an axis-aligned box is at least partly inside the planes. Conservative: boxes
+    // near a frustum corner can pass without being visible.
+    bool isBoxInFrustum(const glm::vec3 boxMin, const glm::vec3 boxMax, const glm::vec4 planes[6]);
+
+    // Pack count interleaved float vertices into the COMPACT layout, quantizing positions to
+    // the given bounds. Generators can write into a float scratch buffer and pack from it.
+    void packCompactVertices(const GLfloat* vertexIn, const size_t count, const glm::vec3 boundsMin, const glm::vec3 boundsMax, RichWerks::CompactVertex* vertexOut);
+
+    // Transform the vertices of a mesh by an affine matrix in one pass. Normals are transformed by
+    // the inverse-transpose of the upper 3x3. Compose several rotations/translations into one
+    // matrix and call this once instead of making a pass per transform. The bounding box is
+    // recomputed in the same pass and the sphere is transformed (see transformBounds); call
+    // computeMeshBounds afterwards for a tight Ritter sphere.
+    void transformMesh(RichWerks::Mesh& mesh, const glm::mat4& transform);
+
     // Rotate the vertices of a mesh around a given axis.
     void rotateMesh(RichWerks::Mesh& mesh, const float radians, const glm::vec3 axes);
 
@@ -0,0 +1,55 @@
+#include "MeshLOD.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace std {
+
+    GLfloat computeBoundingRadius(const std::vector<RichWerks::Mesh>& meshes) {
+        GLfloat radiusSquared = 0.0f;
+        for (const RichWerks::Mesh& mesh : meshes) {
+            for (size_t i = 0; i + 2 < mesh.vertexData.size(); i += RichWerks::FLOATS_PER_MESH_VERTEX) {
+                const glm::vec3 position(mesh.vertexData[i], mesh.vertexData[i + 1], mesh.vertexData[i + 2]);
+                radiusSquared = std::max(radiusSquared, glm::dot(position, position));
+            }
+        }
+        return std::sqrt(radiusSquared);
+    }
+
+    GLfloat projectedScreenSize(const glm::vec3 center, const GLfloat radius, const glm::mat4& view, const glm::mat4& projection) {
+        // Clip-space w of the center: the view depth for perspective, 1 for orthographic.
+        const glm::vec4 viewCenter = view * glm::vec4(center, 1.0f);
+        const GLfloat w = projection[2][3] * viewCenter.z + projection[3][3];
+        if (w <= radius * std::abs(projection[2][3])) {
+            // The camera is inside (or in front of the near side of) the sphere.
+            return std::numeric_limits<GLfloat>::max();
+        }
+        // projection[1][1] maps view-space height to NDC, whose full height is 2.
+        return radius * projection[1][1] / w;
+    }
+
+    GLint proceduralSegments(const GLfloat screenSize, const GLint viewportHeight, const GLfloat pixelsPerSegment, const GLint maxSegments) {
+        const GLfloat MIN_SEGMENTS = 3.0f;
+        // screenSize is the diameter as a fraction of the viewport height. Clamp before
+        // converting, since it is FLT_MAX when the camera is inside the sphere.
+        const GLfloat circumference = static_cast<GLfloat>(M_PI) * screenSize * viewportHeight;
+        const GLfloat segments = std::ceil(circumference / pixelsPerSegment);
+        return static_cast<GLint>(std::max(MIN_SEGMENTS, std::min(segments, static_cast<GLfloat>(maxSegments))));
+    }
+
+    int selectLOD(const std::vector<RichWerks::LODLevel>& levels, const GLfloat screenSize, const int currentLevel, const GLfloat hysteresis) {
+        int level = 0;
+        for (size_t i = 0; i < levels.size(); ++i) {
+            // levels[i] is level i + 1. Getting coarser than the current level means dropping
+            // below the threshold by the margin; getting finer means rising above it by the margin.
+            const bool coarser = static_cast<int>(i) + 1 > currentLevel;
+            const GLfloat threshold = levels[i].screenSize * (coarser ? 1.0f - hysteresis : 1.0f + hysteresis);
+            if (screenSize >= threshold) {
+                break;
+            }
+            level = static_cast<int>(i) + 1;
+        }
+        return level;
+    }
+
+}
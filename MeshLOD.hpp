@@ -0,0 +1,33 @@
+/*
+ * File:          MeshLOD.hpp
+ * Description:   Discrete levels of detail. A prop keeps its full-detail meshes plus
+ *                a chain of coarser copies, and each frame picks the level to draw
+ *                from how much of the viewport its bounding sphere covers. A margin
+ *                around every threshold (hysteresis) keeps a prop that hovers near
+ *                a switch distance from popping between levels.
+ */
+
+#include "MeshGenerator.hpp"
+
+#ifndef _MeshLOD_
+#define _MeshLOD_
+
+#pragma once
+namespace std {
+    // Radius of a sphere around the model origin that contains every vertex of the meshes.
+    GLfloat computeBoundingRadius(const std::vector<RichWerks::Mesh>& meshes);
+
+    // Fraction of the viewport height covered by a world-space sphere. Works for both
+    // perspective and orthographic projections.
+    GLfloat projectedScreenSize(const glm::vec3 center, const GLfloat radius, const glm::mat4& view, const glm::mat4& projection);
+
+    // Segment count that gives a procedural mesh segments of about pixelsPerSegment pixels around
+    // its bounding sphere's projected circumference, between 3 and maxSegments. screenSize is
+    // from projectedScreenSize. The CPU fallback of UGLProp's tessellation path.
+    GLint proceduralSegments(const GLfloat screenSize, const GLint viewportHeight, const GLfloat pixelsPerSegment, const GLint maxSegments);
+
+    // Pick the level to draw: 0 is full detail, i + 1 is levels[i]. Moving away from the
+    // current level needs the size to clear the threshold by hysteresis * threshold.
+    int selectLOD(const std::vector<RichWerks::LODLevel>& levels, const GLfloat screenSize, const int currentLevel, const GLfloat hysteresis = RichWerks::LOD_HYSTERESIS);
+}
+#endif // !_MeshLOD_
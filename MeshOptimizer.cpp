@@ -0,0 +1,392 @@
+#include "MeshOptimizer.hpp"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+    // Forsyth scoring parameters. The LRU cache being modelled is larger than the hardware
+    // FIFO analyzeVertexCache simulates, which is what the original algorithm recommends.
+    const int FORSYTH_CACHE_SIZE = 32;
+    const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+    const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+    const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+    const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+    inline size_t vertexOf(const GLuint index) {
+        return index;
+    }
+
+    float forsythVertexScore(const int cachePosition, const int remainingTriangles) {
+        if (remainingTriangles == 0) {
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3) {
+                // The last triangle's vertices are used again by the next one for free.
+                score = FORSYTH_LAST_TRIANGLE_SCORE;
+            }
+            else {
+                const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                score = std::pow(1.0f - (cachePosition - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+            }
+        }
+        // Favour vertices with few triangles left so they leave the working set early.
+        score += FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -FORSYTH_VALENCE_BOOST_POWER);
+        return score;
+    }
+
+    // Average vertex position of a triangle range.
+    glm::vec3 triangleCentroid(const RichWerks::Mesh& mesh, const size_t triangle) {
+        glm::vec3 sum(0.0f);
+        for (size_t k = 0; k < 3; ++k) {
+            const GLfloat* vertex = &mesh.vertexData[vertexOf(mesh.indexData[triangle * 3 + k]) * RichWerks::FLOATS_PER_MESH_VERTEX];
+            sum += glm::vec3(vertex[0], vertex[1], vertex[2]);
+        }
+        return sum / 3.0f;
+    }
+
+    // Area-weighted face normal (cross product of two edges).
+    glm::vec3 triangleNormal(const RichWerks::Mesh& mesh, const size_t triangle) {
+        glm::vec3 corners[3];
+        for (size_t k = 0; k < 3; ++k) {
+            const GLfloat* vertex = &mesh.vertexData[vertexOf(mesh.indexData[triangle * 3 + k]) * RichWerks::FLOATS_PER_MESH_VERTEX];
+            corners[k] = glm::vec3(vertex[0], vertex[1], vertex[2]);
+        }
+        return glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+    }
+
+    // Key of the epsilon-sized grid cell holding a position.
+    struct WeldCell {
+        int64_t x, y, z;
+        bool operator==(const WeldCell& other) const {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    struct WeldCellHash {
+        size_t operator()(const WeldCell& cell) const {
+            // Large primes from Teschner et al., "Optimized Spatial Hashing for Collision Detection".
+            return static_cast<size_t>(static_cast<uint64_t>(cell.x) * 73856093u ^ static_cast<uint64_t>(cell.y) * 19349663u ^ static_cast<uint64_t>(cell.z) * 83492791u);
+        }
+    };
+
+    bool verticesMatch(const GLfloat* a, const GLfloat* b, const RichWerks::WeldOptions& options) {
+        const size_t end = options.compareTexCoords ? 8 : (options.compareNormals ? 6 : 3);
+        for (size_t i = 0; i < end; ++i) {
+            if (i >= 3 && i < 6 && !options.compareNormals) {
+                continue;
+            }
+            if (std::abs(a[i] - b[i]) > options.epsilon) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+namespace std {
+
+    size_t weldMesh(RichWerks::Mesh& mesh, const RichWerks::WeldOptions options) {
+        const size_t vertexCount = mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+        const float cellSize = std::max(options.epsilon, 1.0e-12f) * 2.0f;
+
+        // Unique vertices bucketed by grid cell. Cells are twice epsilon wide, so a match can
+        // only be in the vertex's own cell or one of its 26 neighbours.
+        std::unordered_map<WeldCell, std::vector<size_t>, WeldCellHash> grid;
+        grid.reserve(vertexCount);
+        std::vector<size_t> remap(vertexCount);
+        std::vector<GLfloat> unique;
+        unique.reserve(mesh.vertexData.size());
+
+        for (size_t v = 0; v < vertexCount; ++v) {
+            const GLfloat* vertex = &mesh.vertexData[v * RichWerks::FLOATS_PER_MESH_VERTEX];
+            const WeldCell cell = { static_cast<int64_t>(std::floor(vertex[0] / cellSize)), static_cast<int64_t>(std::floor(vertex[1] / cellSize)), static_cast<int64_t>(std::floor(vertex[2] / cellSize)) };
+
+            size_t match = SIZE_MAX;
+            for (int64_t dx = -1; dx <= 1 && match == SIZE_MAX; ++dx) {
+                for (int64_t dy = -1; dy <= 1 && match == SIZE_MAX; ++dy) {
+                    for (int64_t dz = -1; dz <= 1 && match == SIZE_MAX; ++dz) {
+                        const auto found = grid.find({ cell.x + dx, cell.y + dy, cell.z + dz });
+                        if (found == grid.end()) {
+                            continue;
+                        }
+                        for (const size_t candidate : found->second) {
+                            if (verticesMatch(&unique[candidate * RichWerks::FLOATS_PER_MESH_VERTEX], vertex, options)) {
+                                match = candidate;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (match == SIZE_MAX) {
+                match = unique.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+                unique.insert(unique.end(), vertex, vertex + RichWerks::FLOATS_PER_MESH_VERTEX);
+                grid[cell].push_back(match);
+            }
+            remap[v] = match;
+        }
+
+        // Rewrite the triangles, dropping any whose corners were welded together.
+        std::vector<GLuint> indices;
+        indices.reserve(mesh.indexData.size());
+        for (size_t i = 0; i + 2 < mesh.indexData.size(); i += 3) {
+            const size_t a = remap[vertexOf(mesh.indexData[i])];
+            const size_t b = remap[vertexOf(mesh.indexData[i + 1])];
+            const size_t c = remap[vertexOf(mesh.indexData[i + 2])];
+            if (a != b && b != c && a != c) {
+                indices.insert(indices.end(), { static_cast<GLuint>(a), static_cast<GLuint>(b), static_cast<GLuint>(c) });
+            }
+        }
+
+        mesh.vertexData.swap(unique);
+        mesh.indexData.swap(indices);
+        computeMeshBounds(mesh);
+        return vertexCount - mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+    }
+
+    RichWerks::VertexCacheStats analyzeVertexCache(const RichWerks::Mesh& mesh, const int cacheSize) {
+        RichWerks::VertexCacheStats stats;
+        const size_t vertexCount = mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+        const size_t triangleCount = mesh.indexData.size() / 3;
+        if (vertexCount == 0 || triangleCount == 0) {
+            return stats;
+        }
+
+        // A vertex is in the FIFO while it was inserted within the last cacheSize misses.
+        std::vector<size_t> insertedAt(vertexCount, 0);
+        size_t misses = 0;
+        for (const GLuint index : mesh.indexData) {
+            const size_t vertex = vertexOf(index);
+            if (insertedAt[vertex] == 0 || misses - insertedAt[vertex] + 1 > static_cast<size_t>(cacheSize)) {
+                ++misses;
+                insertedAt[vertex] = misses;
+            }
+        }
+
+        stats.transformedVertices = misses;
+        stats.acmr = static_cast<GLfloat>(misses) / triangleCount;
+        stats.atvr = static_cast<GLfloat>(misses) / vertexCount;
+        return stats;
+    }
+
+    void optimizeVertexCache(RichWerks::Mesh& mesh) {
+        const size_t vertexCount = mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+        const size_t triangleCount = mesh.indexData.size() / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        // Triangle adjacency per vertex, stored as one flat array with offsets.
+        std::vector<int> remaining(vertexCount, 0);
+        for (const GLuint index : mesh.indexData) {
+            ++remaining[vertexOf(index)];
+        }
+        std::vector<size_t> adjacencyOffset(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+        }
+        std::vector<size_t> adjacency(adjacencyOffset.back());
+        std::vector<size_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (size_t k = 0; k < 3; ++k) {
+                adjacency[fill[vertexOf(mesh.indexData[t * 3 + k])]++] = t;
+            }
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            vertexScore[v] = forsythVertexScore(-1, remaining[v]);
+        }
+        std::vector<float> triangleScore(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            triangleScore[t] = vertexScore[vertexOf(mesh.indexData[t * 3])] + vertexScore[vertexOf(mesh.indexData[t * 3 + 1])] + vertexScore[vertexOf(mesh.indexData[t * 3 + 2])];
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<GLuint> optimized;
+        optimized.reserve(mesh.indexData.size());
+        std::vector<size_t> cache;
+        cache.reserve(FORSYTH_CACHE_SIZE + 3);
+        std::vector<size_t> nextCache;
+        nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+        size_t bestTriangle = std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin();
+        size_t scanPosition = 0;
+        for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+            if (bestTriangle == triangleCount) {
+                // Nothing adjacent to the cache is left; continue with the next unused triangle.
+                while (emitted[scanPosition]) {
+                    ++scanPosition;
+                }
+                bestTriangle = scanPosition;
+            }
+
+            // Emit the triangle and take it out of its vertices' adjacency lists.
+            emitted[bestTriangle] = true;
+            nextCache.clear();
+            for (size_t k = 0; k < 3; ++k) {
+                const size_t vertex = vertexOf(mesh.indexData[bestTriangle * 3 + k]);
+                optimized.push_back(mesh.indexData[bestTriangle * 3 + k]);
+                nextCache.push_back(vertex);
+
+                size_t* begin = &adjacency[adjacencyOffset[vertex]];
+                size_t* end = begin + remaining[vertex];
+                *std::find(begin, end, bestTriangle) = *(end - 1);
+                --remaining[vertex];
+            }
+
+            // The emitted vertices move to the front of the LRU cache.
+            for (const size_t vertex : cache) {
+                if (std::find(nextCache.begin(), nextCache.begin() + 3, vertex) == nextCache.begin() + 3) {
+                    nextCache.push_back(vertex);
+                }
+            }
+            for (size_t i = FORSYTH_CACHE_SIZE; i < nextCache.size(); ++i) {
+                cachePosition[nextCache[i]] = -1;
+                vertexScore[nextCache[i]] = forsythVertexScore(-1, remaining[nextCache[i]]);
+            }
+            nextCache.resize(std::min<size_t>(nextCache.size(), FORSYTH_CACHE_SIZE));
+            cache.swap(nextCache);
+
+            // Rescore the cached vertices and pick the best triangle touching them.
+            for (size_t i = 0; i < cache.size(); ++i) {
+                cachePosition[cache[i]] = static_cast<int>(i);
+                vertexScore[cache[i]] = forsythVertexScore(static_cast<int>(i), remaining[cache[i]]);
+            }
+            bestTriangle = triangleCount;
+            float bestScore = -1.0f;
+            for (const size_t vertex : cache) {
+                for (size_t a = adjacencyOffset[vertex]; a < adjacencyOffset[vertex] + remaining[vertex]; ++a) {
+                    const size_t t = adjacency[a];
+                    triangleScore[t] = vertexScore[vertexOf(mesh.indexData[t * 3])] + vertexScore[vertexOf(mesh.indexData[t * 3 + 1])] + vertexScore[vertexOf(mesh.indexData[t * 3 + 2])];
+                    if (triangleScore[t] > bestScore) {
+                        bestScore = triangleScore[t];
+                        bestTriangle = t;
+                    }
+                }
+            }
+        }
+
+        mesh.indexData.swap(optimized);
+    }
+
+    void optimizeOverdraw(RichWerks::Mesh& mesh, const float threshold) {
+        const size_t triangleCount = mesh.indexData.size() / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+        const RichWerks::VertexCacheStats overall = analyzeVertexCache(mesh);
+        const int CACHE_SIZE = 16;
+
+        // Split the triangle order into clusters. A cluster ends once its own ACMR has come
+        // down to within threshold of the whole mesh, so reordering clusters costs little cache.
+        std::vector<size_t> clusterStart(1, 0);
+        const size_t vertexCount = mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+        // insertedAt holds the running miss count, so every vertex inserted before the current
+        // cluster began reads as missing without clearing the array at each cluster start.
+        std::vector<size_t> insertedAt(vertexCount, 0);
+        size_t misses = 0, clusterMisses = 0, clusterFirstMiss = 0;
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (size_t k = 0; k < 3; ++k) {
+                const size_t vertex = vertexOf(mesh.indexData[t * 3 + k]);
+                if (insertedAt[vertex] <= clusterFirstMiss || misses - insertedAt[vertex] + 1 > CACHE_SIZE) {
+                    ++misses;
+                    ++clusterMisses;
+                    insertedAt[vertex] = misses;
+                }
+            }
+            const size_t clusterTriangles = t + 1 - clusterStart.back();
+            if (t + 1 < triangleCount && static_cast<float>(clusterMisses) / clusterTriangles <= overall.acmr * threshold) {
+                clusterStart.push_back(t + 1);
+                clusterMisses = 0;
+                // Start each cluster with a cold cache, as it may be drawn after any other.
+                clusterFirstMiss = misses;
+            }
+        }
+        clusterStart.push_back(triangleCount);
+        const size_t clusterCount = clusterStart.size() - 1;
+
+        // Score each cluster by how much it faces away from the mesh center. Outward-facing
+        // clusters are drawn first so they can occlude the rest.
+        glm::vec3 meshCentroid(0.0f);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            meshCentroid += triangleCentroid(mesh, t);
+        }
+        meshCentroid /= static_cast<float>(triangleCount);
+
+        std::vector<float> clusterScore(clusterCount);
+        for (size_t c = 0; c < clusterCount; ++c) {
+            glm::vec3 centroid(0.0f), normal(0.0f);
+            for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; ++t) {
+                centroid += triangleCentroid(mesh, t);
+                normal += triangleNormal(mesh, t);
+            }
+            centroid /= static_cast<float>(clusterStart[c + 1] - clusterStart[c]);
+            const float length = glm::length(normal);
+            clusterScore[c] = length > 0.0f ? glm::dot(centroid - meshCentroid, normal / length) : 0.0f;
+        }
+
+        std::vector<size_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return clusterScore[a] > clusterScore[b]; });
+
+        std::vector<GLuint> sorted;
+        sorted.reserve(mesh.indexData.size());
+        for (const size_t c : order) {
+            sorted.insert(sorted.end(), mesh.indexData.begin() + clusterStart[c] * 3, mesh.indexData.begin() + clusterStart[c + 1] * 3);
+        }
+        // Clusters were measured from a cold cache, but the seams between them can still cost
+        // more than that; keep the input order if the new one misses the threshold.
+        sorted.swap(mesh.indexData);
+        if (analyzeVertexCache(mesh).acmr > overall.acmr * threshold) {
+            mesh.indexData.swap(sorted);
+        }
+    }
+
+    void optimizeVertexFetch(RichWerks::Mesh& mesh) {
+        const size_t vertexCount = mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+        const GLuint UNUSED = 0xFFFFFFFF;
+        std::vector<GLuint> remap(vertexCount, UNUSED);
+        std::vector<GLfloat> reordered(mesh.vertexData.size());
+
+        // Number vertices in the order the index buffer first uses them.
+        GLuint next = 0;
+        for (GLuint& index : mesh.indexData) {
+            const size_t vertex = vertexOf(index);
+            if (remap[vertex] == UNUSED) {
+                remap[vertex] = next;
+                std::copy_n(&mesh.vertexData[vertex * RichWerks::FLOATS_PER_MESH_VERTEX], RichWerks::FLOATS_PER_MESH_VERTEX,
+                    &reordered[static_cast<size_t>(next) * RichWerks::FLOATS_PER_MESH_VERTEX]);
+                ++next;
+            }
+            index = remap[vertex];
+        }
+
+        // Vertices no triangle uses are dropped.
+        reordered.resize(static_cast<size_t>(next) * RichWerks::FLOATS_PER_MESH_VERTEX);
+        mesh.vertexData.swap(reordered);
+    }
+
+    void optimizeMesh(RichWerks::Mesh& mesh) {
+        weldMesh(mesh);
+        // Generator output is often already in a good order (a cylinder is one strip), which
+        // Forsyth's LRU model can lose against on the FIFO. Never end up worse than the input.
+        const GLfloat inputAcmr = analyzeVertexCache(mesh).acmr;
+        std::vector<GLuint> input = mesh.indexData;
+        optimizeVertexCache(mesh);
+        GLfloat acmr = analyzeVertexCache(mesh).acmr;
+        if (acmr > inputAcmr) {
+            mesh.indexData.swap(input);
+            acmr = inputAcmr;
+        }
+        // The overdraw pass may only spend the cache gain the pass above made.
+        const float threshold = acmr > 0.0f ? std::min(1.05f, inputAcmr / acmr) : 1.0f;
+        optimizeOverdraw(mesh, threshold);
+        optimizeVertexFetch(mesh);
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * File:          MeshOptimizer.hpp
+ * Description:   Post-generation passes that shrink or reorder a mesh for the GPU
+ *                without changing what it looks like: welding of duplicate vertices,
+ *                index order for the post-transform vertex cache (Forsyth), triangle
+ *                clusters for overdraw, and vertex order for fetch locality.
+ */
+
+#include "MeshGenerator.hpp"
+
+#ifndef _MeshOptimizer_
+#define _MeshOptimizer_
+
+#pragma once
+namespace RichWerks {
+    // Post-transform vertex cache efficiency of an index buffer.
+    struct VertexCacheStats {
+        size_t transformedVertices = 0;  // Cache misses: vertex shader invocations
+        GLfloat acmr = 0.0f;             // Average cache miss ratio: misses per triangle (0.5 is ideal for grids)
+        GLfloat atvr = 0.0f;             // Average transform to vertex ratio: misses per vertex (1.0 is ideal)
+    };
+
+    // Which vertices weldMesh treats as the same. Positions are always compared; turning off
+    // an attribute merges vertices that differ only in it and keeps the first one's value.
+    struct WeldOptions {
+        GLfloat epsilon = 1.0e-5f;       // Largest per-component difference that still counts as equal
+        bool compareNormals = true;
+        bool compareTexCoords = true;
+    };
+}
+
+// This library will be part of the namespace "std", next to the generators
+namespace std {
+    // Merge vertices that are equal within options.epsilon, rewrite indexData to the unique
+    // vertices and drop triangles that collapse. Returns the number of vertices removed.
+    size_t weldMesh(RichWerks::Mesh& mesh, const RichWerks::WeldOptions options = RichWerks::WeldOptions());
+
+    // Simulate a FIFO post-transform cache of cacheSize entries over the index buffer.
+    RichWerks::VertexCacheStats analyzeVertexCache(const RichWerks::Mesh& mesh, const int cacheSize = 16);
+
+    // Reorder triangles for vertex cache locality (Tom Forsyth's linear-speed algorithm).
+    void optimizeVertexCache(RichWerks::Mesh& mesh);
+
+    // Split the cache-optimized triangle order into clusters whose local ACMR stays within
+    // threshold of the whole mesh, then order clusters so outward-facing ones draw first.
+    // Run after optimizeVertexCache; threshold 1.05 keeps about 95% of the cache gain. The
+    // input order is kept when the reordered mesh's ACMR would exceed threshold times the input's.
+    void optimizeOverdraw(RichWerks::Mesh& mesh, const float threshold = 1.05f);
+
+    // Reorder vertexData by first use in indexData and remap the indices.
+    void optimizeVertexFetch(RichWerks::Mesh& mesh);
+
+    // Run the weld, vertex cache, overdraw and vertex fetch passes in order. The result's ACMR
+    // is never worse than the welded input's.
+    void optimizeMesh(RichWerks::Mesh& mesh);
+}
+#endif // !_MeshOptimizer_
@@ -0,0 +1,130 @@
+/*
+ * File:          MeshPrimitives.hpp
+ * Description:   Compile-time vertex and index tables for the fixed primitives
+ *                (cube, pyramid and plane) at unit size. generateCube, generatePyramid
+ *                and generatePlane are a scaled copy of these tables; they can also be
+ *                uploaded as-is and scaled by the model matrix, or checked directly in tests.
+ *
+ *                Vertices use the interleaved layout of MeshGenerator.hpp:
+ *                x, y, z, nX, nY, nZ, u, v. Shapes are centered on x/z and sit on y = 0.
+ */
+
+#include <array>
+#include "UGLObject.hpp"
+
+#ifndef _MeshPrimitives_
+#define _MeshPrimitives_
+
+#pragma once
+namespace RichWerks {
+
+    // Unit cube: x and z in [-0.5, 0.5], y in [0, 1]. One quad (4 vertices) per face.
+    constexpr std::array<GLfloat, 24 * 8> UNIT_CUBE_VERTICES = {
+        // Front square
+        -0.5f, 0.0f,  0.5f,   0.0f,  0.0f,  1.0f,   0.0f, 0.0f,
+         0.5f, 0.0f,  0.5f,   0.0f,  0.0f,  1.0f,   1.0f, 0.0f,
+         0.5f, 1.0f,  0.5f,   0.0f,  0.0f,  1.0f,   1.0f, 1.0f,
+        -0.5f, 1.0f,  0.5f,   0.0f,  0.0f,  1.0f,   0.0f, 1.0f,
+        // Right square
+         0.5f, 0.0f,  0.5f,   1.0f,  0.0f,  0.0f,   0.0f, 0.0f,
+         0.5f, 0.0f, -0.5f,   1.0f,  0.0f,  0.0f,   1.0f, 0.0f,
+         0.5f, 1.0f, -0.5f,   1.0f,  0.0f,  0.0f,   1.0f, 1.0f,
+         0.5f, 1.0f,  0.5f,   1.0f,  0.0f,  0.0f,   0.0f, 1.0f,
+        // Back square
+         0.5f, 0.0f, -0.5f,   0.0f,  0.0f, -1.0f,   0.0f, 0.0f,
+        -0.5f, 0.0f, -0.5f,   0.0f,  0.0f, -1.0f,   1.0f, 0.0f,
+        -0.5f, 1.0f, -0.5f,   0.0f,  0.0f, -1.0f,   1.0f, 1.0f,
+         0.5f, 1.0f, -0.5f,   0.0f,  0.0f, -1.0f,   0.0f, 1.0f,
+        // Left square
+        -0.5f, 0.0f, -0.5f,  -1.0f,  0.0f,  0.0f,   0.0f, 0.0f,
+        -0.5f, 0.0f,  0.5f,  -1.0f,  0.0f,  0.0f,   1.0f, 0.0f,
+        -0.5f, 1.0f,  0.5f,  -1.0f,  0.0f,  0.0f,   1.0f, 1.0f,
+        -0.5f, 1.0f, -0.5f,  -1.0f,  0.0f,  0.0f,   0.0f, 1.0f,
+        // Top square
+        -0.5f, 1.0f,  0.5f,   0.0f,  1.0f,  0.0f,   0.0f, 0.0f,
+         0.5f, 1.0f,  0.5f,   0.0f,  1.0f,  0.0f,   1.0f, 0.0f,
+         0.5f, 1.0f, -0.5f,   0.0f,  1.0f,  0.0f,   1.0f, 1.0f,
+        -0.5f, 1.0f, -0.5f,   0.0f,  1.0f,  0.0f,   0.0f, 1.0f,
+        // Bottom square
+        -0.5f, 0.0f,  0.5f,   0.0f, -1.0f,  0.0f,   0.0f, 0.0f,
+         0.5f, 0.0f,  0.5f,   0.0f, -1.0f,  0.0f,   1.0f, 0.0f,
+         0.5f, 0.0f, -0.5f,   0.0f, -1.0f,  0.0f,   1.0f, 1.0f,
+        -0.5f, 0.0f, -0.5f,   0.0f, -1.0f,  0.0f,   0.0f, 1.0f,
+    };
+
+    constexpr std::array<GLuint, 36> UNIT_CUBE_INDICES = {
+         0,  1,  3,   1,  2,  3,   // Front
+         4,  5,  7,   5,  6,  7,   // Right
+         8,  9, 11,   9, 10, 11,   // Back
+        12, 13, 15,  13, 14, 15,   // Left
+        16, 17, 19,  17, 18, 19,   // Top
+        20, 21, 23,  21, 22, 23,   // Bottom
+    };
+
+    // Unit pyramid: square base with x and z in [-0.5, 0.5] at y = 0, apex at y = 1.
+    // Four side triangles followed by the two-triangle base.
+    constexpr std::array<GLfloat, 16 * 8> UNIT_PYRAMID_VERTICES = {
+        // Front triangle
+         0.0f, 1.0f,  0.0f,   0.0f,  0.0f,  1.0f,   0.5f, 1.0f,
+        -0.5f, 0.0f,  0.5f,   0.0f,  0.0f,  1.0f,   0.0f, 0.0f,
+         0.5f, 0.0f,  0.5f,   0.0f,  0.0f,  1.0f,   1.0f, 0.0f,
+        // Right triangle
+         0.0f, 1.0f,  0.0f,   1.0f,  0.0f,  0.0f,   0.5f, 1.0f,
+         0.5f, 0.0f,  0.5f,   1.0f,  0.0f,  0.0f,   0.0f, 0.0f,
+         0.5f, 0.0f, -0.5f,   1.0f,  0.0f,  0.0f,   1.0f, 0.0f,
+        // Back triangle
+         0.0f, 1.0f,  0.0f,   0.0f,  0.0f, -1.0f,   0.5f, 1.0f,
+         0.5f, 0.0f, -0.5f,   0.0f,  0.0f, -1.0f,   0.0f, 0.0f,
+        -0.5f, 0.0f, -0.5f,   0.0f,  0.0f, -1.0f,   1.0f, 0.0f,
+        // Left triangle
+         0.0f, 1.0f,  0.0f,  -1.0f,  0.0f,  0.0f,   0.5f, 1.0f,
+        -0.5f, 0.0f, -0.5f,  -1.0f,  0.0f,  0.0f,   0.0f, 0.0f,
+        -0.5f, 0.0f,  0.5f,  -1.0f,  0.0f,  0.0f,   1.0f, 0.0f,
+        // Base
+        -0.5f, 0.0f,  0.5f,   0.0f, -1.0f,  0.0f,   0.0f, 0.0f,
+         0.5f, 0.0f,  0.5f,   0.0f, -1.0f,  0.0f,   1.0f, 0.0f,
+         0.5f, 0.0f, -0.5f,   0.0f, -1.0f,  0.0f,   1.0f, 1.0f,
+        -0.5f, 0.0f, -0.5f,   0.0f, -1.0f,  0.0f,   0.0f, 1.0f,
+    };
+
+    constexpr std::array<GLuint, 18> UNIT_PYRAMID_INDICES = {
+         0,  1,  2,                // Front
+         3,  4,  5,                // Right
+         6,  7,  8,                // Back
+         9, 10, 11,                // Left
+        12, 13, 15,  13, 14, 15,   // Base
+    };
+
+    // Unit plane: x and z in [-0.5, 0.5] at y = 0, facing up.
+    constexpr std::array<GLfloat, 4 * 8> UNIT_PLANE_VERTICES = {
+         0.5f, 0.0f, -0.5f,   0.0f,  1.0f,  0.0f,   1.0f, 1.0f,   // Top Right
+         0.5f, 0.0f,  0.5f,   0.0f,  1.0f,  0.0f,   1.0f, 0.0f,   // Bottom Right
+        -0.5f, 0.0f,  0.5f,   0.0f,  1.0f,  0.0f,   0.0f, 0.0f,   // Bottom Left
+        -0.5f, 0.0f, -0.5f,   0.0f,  1.0f,  0.0f,   0.0f, 1.0f,   // Top Left
+    };
+
+    constexpr std::array<GLuint, 6> UNIT_PLANE_INDICES = {
+        0, 2, 1,
+        0, 2, 3,
+    };
+
+    // Every table must hold whole 8-float vertices and only index vertices it contains.
+    template <size_t V, size_t I>
+    constexpr bool isValidPrimitiveTable(const std::array<GLfloat, V>&, const std::array<GLuint, I>& indices) {
+        if (V % 8 != 0 || I % 3 != 0) {
+            return false;
+        }
+        for (size_t i = 0; i < I; ++i) {
+            if (indices[i] >= V / 8) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(isValidPrimitiveTable(UNIT_CUBE_VERTICES, UNIT_CUBE_INDICES), "invalid cube table");
+    static_assert(isValidPrimitiveTable(UNIT_PYRAMID_VERTICES, UNIT_PYRAMID_INDICES), "invalid pyramid table");
+    static_assert(isValidPrimitiveTable(UNIT_PLANE_VERTICES, UNIT_PLANE_INDICES), "invalid plane table");
+
+}
+#endif // !_MeshPrimitives_
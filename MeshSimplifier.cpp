@@ -0,0 +1,494 @@
+#include "MeshSimplifier.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshletBuilder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    // Border and seam edges get a plane quadric perpendicular to their face, weighted this
+    // much more than a face, so collapses keep the outline of open edges and UV islands.
+    const double BOUNDARY_WEIGHT = 10.0;
+
+    // How a position (all vertices that share it) may move.
+    enum struct VertexKind : uint8_t {
+        MANIFOLD,   // One vertex, closed fan: may collapse onto any neighbour
+        BORDER,     // One vertex on an open edge loop: may only slide along that loop
+        SEAM,       // Two vertices split by a normal/UV seam: may only slide along the seam
+        LOCKED      // Corners and anything non-manifold: never moves
+    };
+
+    // Symmetric 4x4 quadric: error(p) = p^T A p + 2 b.p + c.
+    struct Quadric {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0, c = 0;
+
+        // Squared distance to the plane n.p + d = 0 (n unit length), times weight.
+        void addPlane(const glm::dvec3 n, const double d, const double weight) {
+            a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+            a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a22 += weight * n.z * n.z;
+            b0 += weight * n.x * d; b1 += weight * n.y * d; b2 += weight * n.z * d;
+            c += weight * d * d;
+        }
+
+        void operator+=(const Quadric& other) {
+            a00 += other.a00; a01 += other.a01; a02 += other.a02; a11 += other.a11; a12 += other.a12; a22 += other.a22;
+            b0 += other.b0; b1 += other.b1; b2 += other.b2; c += other.c;
+        }
+
+        double error(const glm::dvec3 p) const {
+            const double rx = a00 * p.x + a01 * p.y + a02 * p.z + b0;
+            const double ry = a01 * p.x + a11 * p.y + a12 * p.z + b1;
+            const double rz = a02 * p.x + a12 * p.y + a22 * p.z + b2;
+            // Rounding can leave tiny negative values for points on every plane.
+            return std::max(0.0, rx * p.x + ry * p.y + rz * p.z + b0 * p.x + b1 * p.y + b2 * p.z + c);
+        }
+    };
+
+    struct Collapse {
+        GLuint from;     // Position (its first vertex) that goes away
+        GLuint to;       // Position it moves onto
+        double cost;
+    };
+
+    inline uint64_t edgeKey(const GLuint a, const GLuint b) {
+        return static_cast<uint64_t>(a) << 32 | b;
+    }
+
+    struct PositionKey {
+        GLfloat x, y, z;
+        bool operator==(const PositionKey& other) const {
+            return std::memcmp(this, &other, sizeof(PositionKey)) == 0;
+        }
+    };
+
+    struct PositionKeyHash {
+        size_t operator()(const PositionKey& key) const {
+            uint32_t bits[3];
+            std::memcpy(bits, &key, sizeof(bits));
+            return static_cast<size_t>(bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u);
+        }
+    };
+
+    // Working state for one simplifyMesh call.
+    class Simplifier {
+    public:
+        explicit Simplifier(RichWerks::Mesh& t_mesh) : mesh(t_mesh) {
+            vertexCount = mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+            positions.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i) {
+                const GLfloat* vertex = &mesh.vertexData[i * RichWerks::FLOATS_PER_MESH_VERTEX];
+                positions[i] = glm::dvec3(vertex[0], vertex[1], vertex[2]);
+            }
+            findWedges();
+            buildQuadrics();
+        }
+
+        // Bounding box diagonal, the unit options.targetError is given in.
+        double extent() const {
+            if (vertexCount == 0) {
+                return 0.0;
+            }
+            glm::dvec3 low = positions[0], high = positions[0];
+            for (const glm::dvec3& p : positions) {
+                low = glm::min(low, p);
+                high = glm::max(high, p);
+            }
+            return glm::length(high - low);
+        }
+
+        // Collapse until at most targetTriangles remain or the next collapse costs more than
+        // maxError (squared distance). Returns the largest collapse cost applied.
+        double run(const size_t targetTriangles, const double maxError) {
+            double reached = 0.0;
+            while (mesh.indexData.size() / 3 > targetTriangles) {
+                buildTopology();
+                std::vector<Collapse> collapses = findCollapses(maxError);
+                if (collapses.empty()) {
+                    break;
+                }
+                std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+                const size_t budget = mesh.indexData.size() / 3 - targetTriangles;
+                if (!applyCollapses(collapses, budget, reached)) {
+                    break;
+                }
+            }
+            return reached;
+        }
+
+    protected:
+        // Link every vertex to the others at exactly the same position.
+        void findWedges() {
+            positionOf.resize(vertexCount);
+            nextWedge.resize(vertexCount);
+            std::unordered_map<PositionKey, GLuint, PositionKeyHash> firstAt;
+            firstAt.reserve(vertexCount);
+            for (GLuint i = 0; i < vertexCount; ++i) {
+                const GLfloat* vertex = &mesh.vertexData[static_cast<size_t>(i) * RichWerks::FLOATS_PER_MESH_VERTEX];
+                const auto inserted = firstAt.emplace(PositionKey{ vertex[0], vertex[1], vertex[2] }, i);
+                const GLuint first = inserted.first->second;
+                positionOf[i] = first;
+                // Circular list through the vertices of a position, starting at the first.
+                nextWedge[i] = inserted.second ? i : nextWedge[first];
+                if (!inserted.second) {
+                    nextWedge[first] = i;
+                }
+            }
+        }
+
+        void buildQuadrics() {
+            quadrics.assign(vertexCount, Quadric());
+            std::unordered_set<uint64_t> vertexEdges;
+            for (size_t i = 0; i < mesh.indexData.size(); i += 3) {
+                for (size_t k = 0; k < 3; ++k) {
+                    vertexEdges.insert(edgeKey(mesh.indexData[i + k], mesh.indexData[i + (k + 1) % 3]));
+                }
+            }
+
+            for (size_t i = 0; i < mesh.indexData.size(); i += 3) {
+                const GLuint corner[3] = { positionOf[mesh.indexData[i]], positionOf[mesh.indexData[i + 1]], positionOf[mesh.indexData[i + 2]] };
+                const glm::dvec3 cross = glm::cross(positions[corner[1]] - positions[corner[0]], positions[corner[2]] - positions[corner[0]]);
+                const double doubleArea = glm::length(cross);
+                if (doubleArea <= 0.0) {
+                    continue;
+                }
+                const glm::dvec3 normal = cross / doubleArea;
+                Quadric face;
+                face.addPlane(normal, -glm::dot(normal, positions[corner[0]]), doubleArea * 0.5);
+                for (const GLuint position : corner) {
+                    quadrics[position] += face;
+                }
+
+                // Open edges at vertex level are borders or seams: hold them in place sideways.
+                for (size_t k = 0; k < 3; ++k) {
+                    const GLuint a = mesh.indexData[i + k], b = mesh.indexData[i + (k + 1) % 3];
+                    if (vertexEdges.count(edgeKey(b, a))) {
+                        continue;
+                    }
+                    const glm::dvec3 edge = positions[corner[(k + 1) % 3]] - positions[corner[k]];
+                    const double length = glm::length(edge);
+                    if (length <= 0.0) {
+                        continue;
+                    }
+                    const glm::dvec3 side = glm::normalize(glm::cross(edge, normal));
+                    Quadric boundary;
+                    boundary.addPlane(side, -glm::dot(side, positions[corner[k]]), length * length * BOUNDARY_WEIGHT);
+                    quadrics[corner[k]] += boundary;
+                    quadrics[corner[(k + 1) % 3]] += boundary;
+                }
+            }
+        }
+
+        // Edge sets, vertex-to-triangle lists and vertex kinds for the current index buffer.
+        void buildTopology() {
+            const size_t triangleCount = mesh.indexData.size() / 3;
+            vertexEdges.clear();
+            positionEdges.clear();
+            vertexEdges.reserve(triangleCount * 3);
+            positionEdges.reserve(triangleCount * 3);
+            for (size_t i = 0; i < mesh.indexData.size(); i += 3) {
+                for (size_t k = 0; k < 3; ++k) {
+                    const GLuint a = mesh.indexData[i + k], b = mesh.indexData[i + (k + 1) % 3];
+                    vertexEdges.insert(edgeKey(a, b));
+                    positionEdges.insert(edgeKey(positionOf[a], positionOf[b]));
+                }
+            }
+
+            // Triangles around each vertex, as offsets into one array.
+            triangleStart.assign(vertexCount + 1, 0);
+            for (const GLuint index : mesh.indexData) {
+                ++triangleStart[index + 1];
+            }
+            for (size_t i = 0; i < vertexCount; ++i) {
+                triangleStart[i + 1] += triangleStart[i];
+            }
+            vertexTriangles.resize(mesh.indexData.size());
+            std::vector<GLuint> fill(triangleStart.begin(), triangleStart.end() - 1);
+            for (size_t i = 0; i < mesh.indexData.size(); ++i) {
+                vertexTriangles[fill[mesh.indexData[i]]++] = static_cast<GLuint>(i / 3);
+            }
+
+            // Count open edges per vertex (vertex level) and per position (position level).
+            std::vector<uint8_t> openOut(vertexCount, 0), openIn(vertexCount, 0), borderOut(vertexCount, 0), borderIn(vertexCount, 0);
+            const auto bump = [](uint8_t& count) { count = static_cast<uint8_t>(std::min(count + 1, 255)); };
+            for (size_t i = 0; i < mesh.indexData.size(); i += 3) {
+                for (size_t k = 0; k < 3; ++k) {
+                    const GLuint a = mesh.indexData[i + k], b = mesh.indexData[i + (k + 1) % 3];
+                    if (!vertexEdges.count(edgeKey(b, a))) {
+                        bump(openOut[a]);
+                        bump(openIn[b]);
+                    }
+                    if (!positionEdges.count(edgeKey(positionOf[b], positionOf[a]))) {
+                        bump(borderOut[positionOf[a]]);
+                        bump(borderIn[positionOf[b]]);
+                    }
+                }
+            }
+
+            kinds.assign(vertexCount, VertexKind::LOCKED);
+            for (GLuint position = 0; position < vertexCount; ++position) {
+                if (positionOf[position] != position) {
+                    continue;
+                }
+                size_t wedges = 0;
+                size_t open = 0;
+                bool simpleSeam = true;
+                GLuint wedge = position;
+                do {
+                    ++wedges;
+                    open += openOut[wedge] + openIn[wedge];
+                    simpleSeam = simpleSeam && openOut[wedge] == 1 && openIn[wedge] == 1;
+                    wedge = nextWedge[wedge];
+                } while (wedge != position);
+
+                const bool border = borderOut[position] > 0 || borderIn[position] > 0;
+                if (wedges == 1 && open == 0) {
+                    kinds[position] = VertexKind::MANIFOLD;
+                }
+                else if (wedges == 1 && borderOut[position] == 1 && borderIn[position] == 1 && open == 2) {
+                    kinds[position] = VertexKind::BORDER;
+                }
+                else if (wedges == 2 && !border && simpleSeam) {
+                    kinds[position] = VertexKind::SEAM;
+                }
+            }
+        }
+
+        // Whether the edge between two positions is open at position level (a border).
+        bool isBorderEdge(const GLuint a, const GLuint b) const {
+            return !positionEdges.count(edgeKey(a, b)) || !positionEdges.count(edgeKey(b, a));
+        }
+
+        // Whether the edge between two positions separates vertices with different attributes.
+        bool isSeamEdge(const GLuint a, const GLuint b) const {
+            for (GLuint wa = a;;) {
+                for (GLuint wb = b;;) {
+                    const bool forward = vertexEdges.count(edgeKey(wa, wb)) > 0, backward = vertexEdges.count(edgeKey(wb, wa)) > 0;
+                    if (forward != backward) {
+                        return true;
+                    }
+                    if ((wb = nextWedge[wb]) == b) {
+                        break;
+                    }
+                }
+                if ((wa = nextWedge[wa]) == a) {
+                    break;
+                }
+            }
+            return false;
+        }
+
+        bool canCollapse(const GLuint from, const GLuint to) const {
+            switch (kinds[from]) {
+            case VertexKind::MANIFOLD:
+                return true;
+            case VertexKind::BORDER:
+                return (kinds[to] == VertexKind::BORDER || kinds[to] == VertexKind::LOCKED) && isBorderEdge(from, to);
+            case VertexKind::SEAM:
+                return (kinds[to] == VertexKind::SEAM || kinds[to] == VertexKind::LOCKED) && isSeamEdge(from, to);
+            default:
+                return false;
+            }
+        }
+
+        std::vector<Collapse> findCollapses(const double maxError) const {
+            std::vector<Collapse> collapses;
+            for (size_t i = 0; i < mesh.indexData.size(); i += 3) {
+                for (size_t k = 0; k < 3; ++k) {
+                    const GLuint a = positionOf[mesh.indexData[i + k]], b = positionOf[mesh.indexData[i + (k + 1) % 3]];
+                    // Interior edges show up once per side; only take them from one.
+                    if (a == b || (a > b && positionEdges.count(edgeKey(b, a)))) {
+                        continue;
+                    }
+                    Quadric combined = quadrics[a];
+                    combined += quadrics[b];
+                    Collapse best{ 0, 0, std::numeric_limits<double>::max() };
+                    if (canCollapse(a, b)) {
+                        best = { a, b, combined.error(positions[b]) };
+                    }
+                    if (canCollapse(b, a)) {
+                        const double cost = combined.error(positions[a]);
+                        if (cost < best.cost) {
+                            best = { b, a, cost };
+                        }
+                    }
+                    if (best.cost <= maxError) {
+                        collapses.push_back(best);
+                    }
+                }
+            }
+            return collapses;
+        }
+
+        // The vertex of position `to` that shares a triangle with vertex `from`, if any.
+        bool matchWedge(const GLuint from, const GLuint to, GLuint& match) const {
+            for (GLuint t = triangleStart[from]; t < triangleStart[from + 1]; ++t) {
+                const GLuint* triangle = &mesh.indexData[static_cast<size_t>(vertexTriangles[t]) * 3];
+                for (size_t k = 0; k < 3; ++k) {
+                    if (positionOf[triangle[k]] == to) {
+                        match = triangle[k];
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // Apply the cheapest collapses that don't touch each other. Returns false when none applied.
+        bool applyCollapses(const std::vector<Collapse>& collapses, const size_t budget, double& reached) {
+            std::vector<GLuint> remap(vertexCount);
+            for (GLuint i = 0; i < vertexCount; ++i) {
+                remap[i] = i;
+            }
+            std::vector<bool> locked(vertexCount, false);
+            size_t removed = 0;
+            size_t applied = 0;
+
+            for (const Collapse& collapse : collapses) {
+                if (removed >= budget) {
+                    break;
+                }
+                if (locked[collapse.from] || locked[collapse.to]) {
+                    continue;
+                }
+
+                // Every vertex of the position must have a partner at the target position.
+                GLuint matches[2];
+                size_t wedges = 0;
+                GLuint wedge = collapse.from;
+                do {
+                    if (wedges == 2 || !matchWedge(wedge, collapse.to, matches[wedges])) {
+                        break;
+                    }
+                    ++wedges;
+                    wedge = nextWedge[wedge];
+                } while (wedge != collapse.from);
+                if (wedge != collapse.from || wedges == 0 || flipsTriangle(collapse)) {
+                    continue;
+                }
+                wedge = collapse.from;
+                for (size_t i = 0; i < wedges; ++i, wedge = nextWedge[wedge]) {
+                    remap[wedge] = matches[i];
+                }
+
+                // Lock the one-ring so no other collapse this pass changes the same triangles.
+                wedge = collapse.from;
+                do {
+                    for (GLuint t = triangleStart[wedge]; t < triangleStart[wedge + 1]; ++t) {
+                        const GLuint* triangle = &mesh.indexData[static_cast<size_t>(vertexTriangles[t]) * 3];
+                        const bool shared = positionOf[triangle[0]] == collapse.to || positionOf[triangle[1]] == collapse.to || positionOf[triangle[2]] == collapse.to;
+                        removed += shared ? 1 : 0;
+                        for (size_t k = 0; k < 3; ++k) {
+                            locked[positionOf[triangle[k]]] = true;
+                        }
+                    }
+                    wedge = nextWedge[wedge];
+                } while (wedge != collapse.from);
+
+                quadrics[collapse.to] += quadrics[collapse.from];
+                reached = std::max(reached, collapse.cost);
+                ++applied;
+            }
+
+            if (applied == 0) {
+                return false;
+            }
+
+            // Rewrite the triangles and drop the ones that collapsed to a line.
+            size_t write = 0;
+            for (size_t i = 0; i < mesh.indexData.size(); i += 3) {
+                const GLuint a = remap[mesh.indexData[i]], b = remap[mesh.indexData[i + 1]], c = remap[mesh.indexData[i + 2]];
+                if (positionOf[a] == positionOf[b] || positionOf[b] == positionOf[c] || positionOf[c] == positionOf[a]) {
+                    continue;
+                }
+                mesh.indexData[write++] = a;
+                mesh.indexData[write++] = b;
+                mesh.indexData[write++] = c;
+            }
+            mesh.indexData.resize(write);
+            return true;
+        }
+
+        // Whether moving `from` onto `to` turns any surviving triangle around `from` over.
+        bool flipsTriangle(const Collapse& collapse) const {
+            GLuint wedge = collapse.from;
+            do {
+                for (GLuint t = triangleStart[wedge]; t < triangleStart[wedge + 1]; ++t) {
+                    const GLuint* triangle = &mesh.indexData[static_cast<size_t>(vertexTriangles[t]) * 3];
+                    glm::dvec3 before[3], after[3];
+                    bool removedByCollapse = false;
+                    for (size_t k = 0; k < 3; ++k) {
+                        const GLuint position = positionOf[triangle[k]];
+                        removedByCollapse = removedByCollapse || position == collapse.to;
+                        before[k] = positions[position];
+                        after[k] = position == collapse.from ? positions[collapse.to] : before[k];
+                    }
+                    if (removedByCollapse) {
+                        continue;
+                    }
+                    const glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                    const glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                    if (glm::dot(normalBefore, normalAfter) <= 0.0) {
+                        return true;
+                    }
+                }
+                wedge = nextWedge[wedge];
+            } while (wedge != collapse.from);
+            return false;
+        }
+
+        RichWerks::Mesh& mesh;
+        size_t vertexCount = 0;
+        std::vector<glm::dvec3> positions;
+        std::vector<GLuint> positionOf;       // First vertex with the same position
+        std::vector<GLuint> nextWedge;        // Next vertex with the same position (circular)
+        std::vector<Quadric> quadrics;        // Per position, stored at its first vertex
+        std::vector<VertexKind> kinds;        // Per position, stored at its first vertex
+        std::unordered_set<uint64_t> vertexEdges;
+        std::unordered_set<uint64_t> positionEdges;
+        std::vector<GLuint> triangleStart;
+        std::vector<GLuint> vertexTriangles;
+    };
+}
+
+namespace std {
+
+    GLfloat simplifyMesh(RichWerks::Mesh& mesh, const RichWerks::SimplifyOptions options) {
+        const size_t triangleCount = mesh.indexData.size() / 3;
+        const size_t targetTriangles = options.targetTriangles > 0 ? options.targetTriangles
+            : static_cast<size_t>(triangleCount * static_cast<double>(options.targetRatio));
+        if (triangleCount <= targetTriangles) {
+            return 0.0f;
+        }
+
+        Simplifier simplifier(mesh);
+        const double extent = simplifier.extent();
+        if (extent <= 0.0) {
+            return 0.0f;
+        }
+        const double maxError = options.targetError * extent;
+        const double reached = simplifier.run(targetTriangles, maxError * maxError);
+
+        // Drop the vertices that were collapsed away and restore cache-friendly order.
+        optimizeVertexCache(mesh);
+        optimizeVertexFetch(mesh);
+        computeMeshBounds(mesh);
+        if (!mesh.meshlets.empty()) {
+            buildMeshlets(mesh);
+        }
+        return static_cast<GLfloat>(std::sqrt(reached) / extent);
+    }
+
+    std::vector<RichWerks::Mesh> simplifyMeshes(const std::vector<RichWerks::Mesh>& meshes, const RichWerks::SimplifyOptions options, RichWerks::ThreadPool& pool) {
+        std::vector<RichWerks::Mesh> simplified(meshes.size());
+        pool.ParallelFor(meshes.size(), [&](const size_t i) {
+            simplified[i] = meshes[i];
+            // The copy would otherwise share (and later draw) the original's GPU buffer.
+            simplified[i].buffer.reset();
+            simplifyMesh(simplified[i], options);
+        });
+        return simplified;
+    }
+
+}
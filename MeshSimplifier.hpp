@@ -0,0 +1,35 @@
+/*
+ * File:          MeshSimplifier.hpp
+ * Description:   Quadric error metric (Garland-Heckbert) edge-collapse simplification
+ *                for any RichWerks::Mesh, including merged or imported geometry. Vertices
+ *                only ever collapse onto an existing neighbour, so kept vertices keep
+ *                their normals and texture coordinates. Vertices on a UV/normal seam or
+ *                an open border only slide along that seam or border, and anything
+ *                more complicated (corners, non-manifold spots) is locked.
+ */
+
+#include "MeshGenerator.hpp"
+#include "ThreadPool.hpp"
+
+#ifndef _MeshSimplifier_
+#define _MeshSimplifier_
+
+#pragma once
+namespace RichWerks {
+    // When simplifyMesh stops. It stops at whichever limit it reaches first.
+    struct SimplifyOptions {
+        GLfloat targetRatio = 0.5f;      // Fraction of the triangles to keep (used when targetTriangles is 0)
+        size_t targetTriangles = 0;      // Absolute triangle budget, overrides targetRatio when non-zero
+        GLfloat targetError = 0.01f;     // Largest deviation from the original surface, as a fraction of the bounding box diagonal
+    };
+}
+
+namespace std {
+    // Simplify a mesh in place. Returns the error reached, relative to the bounding box diagonal.
+    GLfloat simplifyMesh(RichWerks::Mesh& mesh, const RichWerks::SimplifyOptions options = RichWerks::SimplifyOptions());
+
+    // Simplified copies of several meshes, one mesh per task on the pool.
+    std::vector<RichWerks::Mesh> simplifyMeshes(const std::vector<RichWerks::Mesh>& meshes, const RichWerks::SimplifyOptions options = RichWerks::SimplifyOptions(),
+        RichWerks::ThreadPool& pool = RichWerks::ThreadPool::Shared());
+}
+#endif // !_MeshSimplifier_
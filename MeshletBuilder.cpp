@@ -0,0 +1,216 @@
+#include "MeshletBuilder.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // Normal cones narrower than this (smallest dot with the axis) are too wide to ever cull.
+    const float MIN_CONE_DOT = 0.1f;
+
+    inline glm::vec3 positionOf(const RichWerks::Mesh& mesh, const GLuint vertex) {
+        const GLfloat* data = &mesh.vertexData[static_cast<size_t>(vertex) * RichWerks::FLOATS_PER_MESH_VERTEX];
+        return glm::vec3(data[0], data[1], data[2]);
+    }
+
+    inline glm::vec3 normalOf(const RichWerks::Mesh& mesh, const GLuint vertex) {
+        const GLfloat* data = &mesh.vertexData[static_cast<size_t>(vertex) * RichWerks::FLOATS_PER_MESH_VERTEX];
+        return glm::vec3(data[3], data[4], data[5]);
+    }
+
+    // Bounding sphere and normal cone of the triangles in [first, first + 3 * triangleCount).
+    void computeMeshletBounds(const RichWerks::Mesh& mesh, RichWerks::Meshlet& meshlet) {
+        const GLuint* indices = &mesh.indexData[meshlet.firstIndex];
+        const size_t indexCount = static_cast<size_t>(meshlet.triangleCount) * 3;
+
+        glm::vec3 low(std::numeric_limits<float>::max()), high(-std::numeric_limits<float>::max());
+        glm::vec3 normalSum(0.0f);
+        for (size_t i = 0; i < indexCount; ++i) {
+            const glm::vec3 position = positionOf(mesh, indices[i]);
+            low = glm::min(low, position);
+            high = glm::max(high, position);
+            const glm::vec3 normal = normalOf(mesh, indices[i]);
+            const float length = glm::length(normal);
+            normalSum += length > 0.0f ? normal / length : normal;
+        }
+
+        meshlet.center = (low + high) * 0.5f;
+        float radiusSquared = 0.0f;
+        for (size_t i = 0; i < indexCount; ++i) {
+            const glm::vec3 offset = positionOf(mesh, indices[i]) - meshlet.center;
+            radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+        }
+        meshlet.radius = std::sqrt(radiusSquared);
+
+        // Vertex normals rather than face normals, so the cone doesn't depend on winding order.
+        meshlet.coneAxis = glm::vec3(0.0f);
+        meshlet.coneCutoff = 1.0f;
+        const float sumLength = glm::length(normalSum);
+        if (sumLength <= 0.0f) {
+            return;
+        }
+        const glm::vec3 axis = normalSum / sumLength;
+        float minDot = 1.0f;
+        for (size_t i = 0; i < indexCount; ++i) {
+            const glm::vec3 normal = normalOf(mesh, indices[i]);
+            const float length = glm::length(normal);
+            minDot = std::min(minDot, length > 0.0f ? glm::dot(normal / length, axis) : -1.0f);
+        }
+        meshlet.coneAxis = axis;
+        if (minDot > MIN_CONE_DOT) {
+            meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+    }
+}
+
+namespace std {
+
+    void buildMeshlets(RichWerks::Mesh& mesh) {
+        const size_t vertexCount = mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX;
+        const size_t triangleCount = mesh.indexData.size() / 3;
+        mesh.meshlets.clear();
+
+        // Triangles around each vertex, as offsets into one array.
+        std::vector<GLuint> triangleStart(vertexCount + 1, 0);
+        for (const GLuint index : mesh.indexData) {
+            ++triangleStart[index + 1];
+        }
+        for (size_t i = 0; i < vertexCount; ++i) {
+            triangleStart[i + 1] += triangleStart[i];
+        }
+        std::vector<GLuint> vertexTriangles(mesh.indexData.size());
+        std::vector<GLuint> fill(triangleStart.begin(), triangleStart.end() - 1);
+        for (size_t i = 0; i < mesh.indexData.size(); ++i) {
+            vertexTriangles[fill[mesh.indexData[i]]++] = static_cast<GLuint>(i / 3);
+        }
+
+        std::vector<glm::vec3> centroids(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            centroids[t] = (positionOf(mesh, mesh.indexData[t * 3]) + positionOf(mesh, mesh.indexData[t * 3 + 1]) + positionOf(mesh, mesh.indexData[t * 3 + 2])) / 3.0f;
+        }
+
+        const GLuint NONE = std::numeric_limits<GLuint>::max();
+        std::vector<GLuint> meshletOf(vertexCount, NONE);   // Last meshlet that used each vertex
+        std::vector<GLuint> unusedTriangles(vertexCount, 0); // Triangles around each vertex not yet placed
+        for (const GLuint index : mesh.indexData) {
+            ++unusedTriangles[index];
+        }
+        std::vector<bool> used(triangleCount, false);
+        std::vector<GLuint> reordered;
+        reordered.reserve(mesh.indexData.size());
+        std::vector<GLuint> meshletVertices;
+        meshletVertices.reserve(RichWerks::MESHLET_MAX_VERTICES);
+
+        size_t seed = 0;
+        while (true) {
+            // Start each meshlet at the first triangle left in the (cache-optimized) order.
+            while (seed < triangleCount && used[seed]) {
+                ++seed;
+            }
+            if (seed == triangleCount) {
+                break;
+            }
+
+            RichWerks::Meshlet meshlet;
+            meshlet.firstIndex = static_cast<GLuint>(reordered.size());
+            const GLuint id = static_cast<GLuint>(mesh.meshlets.size());
+            meshletVertices.clear();
+            glm::vec3 centroidSum(0.0f);
+
+            size_t triangle = seed;
+            while (triangle != NONE) {
+                used[triangle] = true;
+                for (size_t k = 0; k < 3; ++k) {
+                    const GLuint vertex = mesh.indexData[triangle * 3 + k];
+                    reordered.push_back(vertex);
+                    --unusedTriangles[vertex];
+                    if (meshletOf[vertex] != id) {
+                        meshletOf[vertex] = id;
+                        meshletVertices.push_back(vertex);
+                    }
+                }
+                centroidSum += centroids[triangle];
+                ++meshlet.triangleCount;
+                if (meshlet.triangleCount == RichWerks::MESHLET_MAX_TRIANGLES) {
+                    break;
+                }
+
+                // Grow by the neighbouring triangle that adds the fewest new vertices, then the
+                // one closest to the meshlet so far, which keeps the bounds tight.
+                const glm::vec3 center = centroidSum / static_cast<float>(meshlet.triangleCount);
+                triangle = NONE;
+                size_t bestNewVertices = 3;
+                float bestDistance = std::numeric_limits<float>::max();
+                for (const GLuint vertex : meshletVertices) {
+                    if (unusedTriangles[vertex] == 0) {
+                        continue;
+                    }
+                    for (GLuint i = triangleStart[vertex]; i < triangleStart[vertex + 1]; ++i) {
+                        const GLuint candidate = vertexTriangles[i];
+                        if (used[candidate]) {
+                            continue;
+                        }
+                        size_t newVertices = 0;
+                        for (size_t k = 0; k < 3; ++k) {
+                            newVertices += meshletOf[mesh.indexData[candidate * 3 + k]] != id ? 1 : 0;
+                        }
+                        if (meshletVertices.size() + newVertices > RichWerks::MESHLET_MAX_VERTICES) {
+                            continue;
+                        }
+                        const glm::vec3 offset = centroids[candidate] - center;
+                        const float distance = glm::dot(offset, offset);
+                        if (newVertices < bestNewVertices || (newVertices == bestNewVertices && distance < bestDistance)) {
+                            triangle = candidate;
+                            bestNewVertices = newVertices;
+                            bestDistance = distance;
+                        }
+                    }
+                }
+            }
+
+            meshlet.vertexCount = static_cast<GLuint>(meshletVertices.size());
+            mesh.meshlets.push_back(meshlet);
+        }
+
+        mesh.indexData.swap(reordered);
+        for (RichWerks::Meshlet& meshlet : mesh.meshlets) {
+            computeMeshletBounds(mesh, meshlet);
+        }
+    }
+
+    void cullMeshlets(const RichWerks::Mesh& mesh, const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3 cameraPosition,
+        std::vector<GLsizei>& counts, std::vector<GLuint>& firstIndices) {
+        // Frustum planes in model space (Gribb-Hartmann), normalized so distances are in model units.
+        const glm::mat4 clip = viewProjection * model;
+        glm::vec4 planes[6];
+        extractFrustumPlanes(clip, planes);
+        const glm::vec3 eye = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+
+        bool extending = false;
+        for (const RichWerks::Meshlet& meshlet : mesh.meshlets) {
+            bool visible = true;
+            for (const glm::vec4& plane : planes) {
+                if (glm::dot(glm::vec3(plane), meshlet.center) + plane.w < -meshlet.radius) {
+                    visible = false;
+                    break;
+                }
+            }
+            // Every normal in the cone points away from the eye, wherever in the sphere it sits.
+            if (visible && meshlet.coneCutoff < 1.0f) {
+                const glm::vec3 toCenter = meshlet.center - eye;
+                visible = glm::dot(toCenter, meshlet.coneAxis) < meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius;
+            }
+
+            if (!visible) {
+                extending = false;
+            }
+            else if (extending) {
+                counts.back() += static_cast<GLsizei>(meshlet.triangleCount * 3);
+            }
+            else {
+                counts.push_back(static_cast<GLsizei>(meshlet.triangleCount * 3));
+                firstIndices.push_back(meshlet.firstIndex);
+                extending = true;
+            }
+        }
+    }
+
+}
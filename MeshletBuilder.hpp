@@ -0,0 +1,34 @@
+/*
+ * File:          MeshletBuilder.hpp
+ * Description:   Splits a mesh into meshlets: runs of at most 64 vertices and 124
+ *                triangles, each with a bounding sphere and a normal cone. The index
+ *                buffer is reordered so every meshlet is one contiguous range, so the
+ *                renderer can skip off-screen and back-facing clusters and draw the
+ *                rest with one glMultiDrawElements instead of the whole mesh.
+ */
+
+#include "MeshGenerator.hpp"
+
+#ifndef _MeshletBuilder_
+#define _MeshletBuilder_
+
+#pragma once
+namespace RichWerks {
+    // Limits from the mesh shader sweet spot: 64 vertices fit in one warp's worth of
+    // shared memory and 124 triangles keeps the primitive count under 128 with padding.
+    constexpr size_t MESHLET_MAX_VERTICES = 64;
+    constexpr size_t MESHLET_MAX_TRIANGLES = 124;
+}
+
+namespace std {
+    // Reorder mesh.indexData into meshlets and fill mesh.meshlets. Triangles keep their order,
+    // so run it after optimizeMesh: cache-ordered triangles give tight, compact meshlets.
+    void buildMeshlets(RichWerks::Mesh& mesh);
+
+    // Append the index ranges of the meshlets that are inside the view frustum and not facing
+    // away from the camera. Adjacent visible meshlets are merged into one range.
+    // firstIndices are offsets into indexData (in indices, not bytes).
+    void cullMeshlets(const RichWerks::Mesh& mesh, const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3 cameraPosition,
+        std::vector<GLsizei>& counts, std::vector<GLuint>& firstIndices);
+}
+#endif // !_MeshletBuilder_
@@ -0,0 +1,104 @@
+#include "RenderQueue.hpp"
+#include <algorithm>
+using namespace RichWerks;
+
+namespace {
+    constexpr int PASS_SHIFT = 62;
+    constexpr int BUCKET_SHIFT = 58;
+    constexpr int SHADER_SHIFT = 48;
+    constexpr int TEXTURE_SHIFT = 36;
+    constexpr int VERTEX_ARRAY_SHIFT = 20;
+    constexpr uint64_t SHADER_MASK = 0x3FF;
+    constexpr uint64_t TEXTURE_MASK = 0xFFF;
+    constexpr uint64_t VERTEX_ARRAY_MASK = 0xFFFF;
+    constexpr uint64_t DEPTH_MASK = 0xFFFFF;
+    constexpr int BLENDED_DEPTH_SHIFT = 30;      // BLENDED: 32 bits of depth right below the pass
+    constexpr uint64_t BLENDED_DEPTH_MASK = 0xFFFFFFFF;
+}
+
+RenderQueue::RenderQueue(GLuint t_depthBuckets, GLfloat t_depthRange)
+    : depthBuckets(glm::clamp(t_depthBuckets, 1u, 1u << DEPTH_BUCKET_BITS)),
+    depthRange(t_depthRange) {
+}
+
+void RenderQueue::Begin(const FrameData& t_frame) {
+    items.clear();
+    entries.clear();
+    // Distance in front of the camera is minus the view-space z.
+    viewDepthRow = -glm::vec4(t_frame.view[0][2], t_frame.view[1][2], t_frame.view[2][2], t_frame.view[3][2]);
+}
+
+void RenderQueue::Submit(const RenderItem& t_item, RenderPass t_pass) {
+    const GLuint shader = t_item.prop->GetShader()->ID;
+    const GLuint texture = t_item.material != nullptr ? static_cast<GLuint>(t_item.material->texture) : 0;
+    const GLuint vertexArray = t_item.mesh != nullptr && t_item.mesh->buffer ? t_item.mesh->buffer->vao : 0;
+    const GLfloat viewDepth = glm::dot(viewDepthRow, glm::vec4(t_item.prop->GetWorldBounds().center, 1.0f));
+    entries.push_back({ MakeKey(t_pass, shader, texture, vertexArray, viewDepth), static_cast<GLuint>(items.size()) });
+    items.push_back(t_item);
+}
+
+void RenderQueue::Execute(const FrameData& t_frame) {
+    RadixSort(entries, scratch);
+    for (const std::pair<uint64_t, GLuint>& entry : entries) {
+        const RenderItem& item = items[entry.second];
+        item.prop->DrawMesh(item.mesh, item.material, item.objectIndex, t_frame);
+    }
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass t_pass, GLuint t_shader, GLuint t_texture, GLuint t_vertexArray, GLfloat t_viewDepth) const {
+    const GLfloat depth = glm::clamp(t_viewDepth / depthRange, 0.0f, 1.0f);
+    const uint64_t pass = static_cast<uint64_t>(t_pass) << PASS_SHIFT;
+    if (t_pass == RenderPass::BLENDED) {
+        const uint64_t farFirst = static_cast<uint64_t>((1.0 - depth) * static_cast<double>(BLENDED_DEPTH_MASK));
+        return pass | farFirst << BLENDED_DEPTH_SHIFT;
+    }
+    const uint64_t bucket = std::min(static_cast<GLuint>(depth * depthBuckets), depthBuckets - 1);
+    return pass
+        | bucket << BUCKET_SHIFT
+        | (t_shader & SHADER_MASK) << SHADER_SHIFT
+        | (t_texture & TEXTURE_MASK) << TEXTURE_SHIFT
+        | (t_vertexArray & VERTEX_ARRAY_MASK) << VERTEX_ARRAY_SHIFT
+        | static_cast<uint64_t>(depth * static_cast<GLfloat>(DEPTH_MASK));
+}
+
+// Stable LSD radix sort, 8 bits per pass. All eight histograms are built in one read of the keys.
+void RenderQueue::RadixSort(std::vector<std::pair<uint64_t, GLuint>>& t_entries, std::vector<std::pair<uint64_t, GLuint>>& t_scratch) {
+    const size_t count = t_entries.size();
+    if (count < 2) {
+        return;
+    }
+    size_t histograms[8][256] = {};
+    for (const std::pair<uint64_t, GLuint>& entry : t_entries) {
+        for (int byte = 0; byte < 8; ++byte) {
+            ++histograms[byte][(entry.first >> (byte * 8)) & 0xFF];
+        }
+    }
+
+    t_scratch.resize(count);
+    std::vector<std::pair<uint64_t, GLuint>>* source = &t_entries;
+    std::vector<std::pair<uint64_t, GLuint>>* target = &t_scratch;
+    for (int byte = 0; byte < 8; ++byte) {
+        size_t* histogram = histograms[byte];
+        const int shift = byte * 8;
+        if (histogram[((*source)[0].first >> shift) & 0xFF] == count) {
+            continue;   // Every key has the same byte here
+        }
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit) {
+            const size_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+        for (const std::pair<uint64_t, GLuint>& entry : *source) {
+            (*target)[histogram[(entry.first >> shift) & 0xFF]++] = entry;
+        }
+        std::swap(source, target);
+    }
+    if (source != &t_entries) {
+        t_entries.swap(t_scratch);
+    }
+}
+
+GLuint RenderQueue::GetItemCount() const {
+    return static_cast<GLuint>(items.size());
+}
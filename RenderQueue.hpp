@@ -0,0 +1,79 @@
+/*
+ * File:          RenderQueue.hpp
+ * Description:   Sorted submission of prop meshes. Each mesh a prop draws this frame is
+ *                queued with a 64-bit key; the queue is radix-sorted and drawn in key
+ *                order, so the draw order no longer depends on the order props were
+ *                created in. From the top bit down the key holds:
+ *
+ *                  63..62  pass            SOLID before BLENDED
+ *                  61..58  depth bucket    coarse view distance, near first
+ *                  57..48  shader          program name
+ *                  47..36  texture         texture name
+ *                  35..20  vertex array    vertex array name
+ *                  19..0   depth           fine view distance, near first
+ *
+ *                so solid meshes go roughly front to back (nearer surfaces fill the depth
+ *                buffer first and hide the fragments behind them), and within a depth
+ *                bucket meshes sharing a shader, texture and vertex array are drawn
+ *                together, which GLStateCache and the Shader upload filter then turn into
+ *                dropped calls. BLENDED meshes skip the state fields and go strictly back
+ *                to front. GL names are small integers, so the fields rarely wrap; a name
+ *                that does only groups less well.
+ */
+
+#include "UGLProp.hpp"
+#include <cstdint>
+
+#ifndef _RenderQueue_
+#define _RenderQueue_
+
+#pragma once
+namespace RichWerks {
+    // SOLID meshes are opaque and sorted for state and front to back; BLENDED are transparent
+    // and sorted back to front.
+    enum struct RenderPass : GLuint { SOLID, BLENDED };
+
+    // One mesh to draw: a mesh of a prop (nullptr for its procedural mesh) with its material
+    // and the prop's entry in FrameUniforms.
+    struct RenderItem {
+        UGLProp* prop = nullptr;
+        const Mesh* mesh = nullptr;
+        const Material* material = nullptr;     // nullptr leaves the material as it is
+        GLint objectIndex = 0;
+    };
+
+    class RenderQueue
+    {
+    public:
+        static constexpr GLuint DEPTH_BUCKET_BITS = 4;
+
+        // t_depthBuckets (1 to 16) coarse distance bands sort ahead of state; 1 orders by state
+        // only, with depth breaking ties. t_depthRange is the view distance spread over the
+        // depth fields; anything further shares the last value.
+        explicit RenderQueue(GLuint t_depthBuckets = 8, GLfloat t_depthRange = 100.0f);
+
+        // Start a frame's queue; the view is used for the depth fields.
+        void Begin(const FrameData& t_frame);
+        void Submit(const RenderItem& t_item, RenderPass t_pass = RenderPass::SOLID);
+        // Sort the queued items and draw them in key order.
+        void Execute(const FrameData& t_frame);
+
+        // Key of a mesh t_viewDepth in front of the camera.
+        uint64_t MakeKey(RenderPass t_pass, GLuint t_shader, GLuint t_texture, GLuint t_vertexArray, GLfloat t_viewDepth) const;
+        // Sort keys and their payloads by key, least significant byte first. Byte positions
+        // where every key holds the same value are skipped. t_scratch is resized as needed.
+        static void RadixSort(std::vector<std::pair<uint64_t, GLuint>>& t_entries, std::vector<std::pair<uint64_t, GLuint>>& t_scratch);
+
+        GLuint GetItemCount() const;
+
+    protected:
+        GLuint depthBuckets;
+        GLfloat depthRange;
+        glm::vec4 viewDepthRow = glm::vec4(0.0f);   // Dot with a world position gives its view distance
+        std::vector<RenderItem> items;
+        std::vector<std::pair<uint64_t, GLuint>> entries;   // (key, item index)
+        std::vector<std::pair<uint64_t, GLuint>> scratch;
+    };
+
+}
+#endif // !_RenderQueue_
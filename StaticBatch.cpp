@@ -0,0 +1,249 @@
+#include "StaticBatch.hpp"
+#include "GLStateCache.hpp"
+#include "MeshGenerator.hpp"
+#include <limits>
+using namespace RichWerks;
+
+// Bake a prop's meshes into the groups matching its shader and materials
+int StaticBatch::AddProp(const UGLProp& t_prop) {
+    const int propId = static_cast<int>(props.size());
+    props.emplace_back();
+    BakedProp& baked = props.back();
+    baked.model = t_prop.GetModelMatrix();
+
+    const std::vector<std::shared_ptr<const Mesh>>& meshes = t_prop.GetMeshes();
+    const std::vector<Material>& materials = t_prop.GetMaterials();
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh& mesh = *meshes[i];
+        const Material material = materials.empty() ? Material() : materials[std::min(i, materials.size() - 1)];
+
+        int groupIndex = 0;
+        while (groupIndex < static_cast<int>(groups.size())
+            && !(groups[groupIndex].shader == t_prop.GetShader() && sameMaterial(groups[groupIndex].material, material))) {
+            ++groupIndex;
+        }
+        if (groupIndex == static_cast<int>(groups.size())) {
+            groups.emplace_back();
+            groups.back().shader = t_prop.GetShader();
+            groups.back().uniforms.Resolve(*t_prop.GetShader());
+            groups.back().material = material;
+        }
+        Group& group = groups[groupIndex];
+
+        StaticBatchRange range;
+        range.group = groupIndex;
+        range.firstVertex = static_cast<GLuint>(group.mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX);
+        range.vertexCount = static_cast<GLuint>(mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX);
+        range.firstIndex = static_cast<GLuint>(group.mesh.indexData.size());
+        range.indexCount = static_cast<GLuint>(mesh.indexData.size());
+        range.localVertices = mesh.vertexData;
+
+        group.mesh.vertexData.resize(group.mesh.vertexData.size() + mesh.vertexData.size());
+        for (const GLuint index : mesh.indexData) {
+            group.mesh.indexData.push_back(range.firstVertex + index);
+        }
+        group.members.push_back({ propId, static_cast<int>(baked.ranges.size()) });
+        group.dirty = true;
+        baked.bounds = std::mergeBounds(baked.bounds, bakeRange(range, baked.model));
+        baked.ranges.push_back(std::move(range));
+    }
+    return propId;
+}
+
+// Upload the groups that changed since the last call
+void StaticBatch::BindMesh() {
+    for (Group& group : groups) {
+        if (!group.dirty) {
+            continue;
+        }
+        // World-space batches can span the scene, so they stay FLOAT32 rather than quantized.
+        group.mesh.vertexFormat = VertexFormat::FLOAT32;
+        std::computeMeshBounds(group.mesh);
+        UploadMesh(group.mesh);
+        group.dirty = false;
+    }
+}
+
+void StaticBatch::Render(FrameUniforms& t_frame) {
+    GLStateCache& state = GLStateCache::Current();
+    GLint worldObject = -1;     // Vertices are already in world space: one identity entry serves every group
+
+    // Props outside the view frustum are left out like hidden ones. Their baked bounds are
+    // already in world space, so each is tested once for all of its groups.
+    glm::vec4 planes[6];
+    std::extractFrustumPlanes(t_frame.GetFrameData().viewProjection, planes);
+    propsInView.resize(props.size());
+    for (size_t p = 0; p < props.size(); ++p) {
+        const BakedProp& prop = props[p];
+        propsInView[p] = prop.visible && !prop.bounds.IsEmpty() && std::isBoxInFrustum(prop.bounds.boxMin, prop.bounds.boxMax, planes);
+    }
+    for (const Group& group : groups) {
+        if (!group.mesh.buffer || group.mesh.buffer->indexCount == 0) {
+            continue;
+        }
+
+        // Visible ranges, with neighbours in the buffer merged into one run.
+        const size_t indexSize = group.mesh.buffer->indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        drawCounts.clear();
+        drawOffsets.clear();
+        GLuint runEnd = std::numeric_limits<GLuint>::max();
+        for (const std::pair<int, int>& member : group.members) {
+            const BakedProp& prop = props[member.first];
+            const StaticBatchRange& range = prop.ranges[member.second];
+            if (!propsInView[member.first] || range.indexCount == 0) {
+                continue;
+            }
+            if (range.firstIndex == runEnd) {
+                drawCounts.back() += range.indexCount;
+            }
+            else {
+                drawCounts.push_back(range.indexCount);
+                drawOffsets.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(range.firstIndex) * indexSize));
+            }
+            runEnd = range.firstIndex + range.indexCount;
+        }
+        if (drawCounts.empty()) {
+            continue;
+        }
+
+        state.UseProgram(group.shader->ID);
+        if (worldObject < 0) {
+            worldObject = t_frame.AddObject(glm::mat4(1.0f), glm::mat4(1.0f));
+        }
+        group.shader->set(group.uniforms.objectIndex, worldObject);
+        group.shader->set(group.uniforms.positionOffset, group.mesh.buffer->positionOffset);
+        group.shader->set(group.uniforms.positionScale, group.mesh.buffer->positionScale);
+        group.shader->set(group.uniforms.materialShininess, group.material.shininess);
+        group.shader->set(group.uniforms.materialEmission, group.material.emission);
+        state.BindTexture(0, GL_TEXTURE_2D, group.material.texture);
+
+        state.BindVertexArray(group.mesh.buffer->vao);
+        if (drawCounts.size() == 1) {
+            glDrawElements(GL_TRIANGLES, drawCounts[0], group.mesh.buffer->indexType, drawOffsets[0]);
+        }
+        else {
+            glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), group.mesh.buffer->indexType, drawOffsets.data(), static_cast<GLsizei>(drawCounts.size()));
+        }
+    }
+}
+
+// Move a baked prop: re-bake its ranges from the model-space source and update the GPU copies
+void StaticBatch::SetPropTransform(int t_prop, const glm::mat4& t_model) {
+    BakedProp& prop = props[t_prop];
+    prop.model = t_model;
+    prop.bounds = BoundingVolume();
+    for (const StaticBatchRange& range : prop.ranges) {
+        prop.bounds = std::mergeBounds(prop.bounds, bakeRange(range, t_model));
+        Group& group = groups[range.group];
+        if (group.mesh.buffer && !group.dirty) {
+            const size_t firstFloat = static_cast<size_t>(range.firstVertex) * RichWerks::FLOATS_PER_MESH_VERTEX;
+            GLStateCache::Current().BindBuffer(GL_ARRAY_BUFFER, group.mesh.buffer->vbos[0]);
+            glBufferSubData(GL_ARRAY_BUFFER, firstFloat * sizeof(GLfloat), range.localVertices.size() * sizeof(GLfloat), group.mesh.vertexData.data() + firstFloat);
+        }
+    }
+}
+
+void StaticBatch::SetPropVisible(int t_prop, bool t_visible) {
+    props[t_prop].visible = t_visible;
+}
+
+const glm::mat4& StaticBatch::GetPropTransform(int t_prop) const {
+    return props[t_prop].model;
+}
+
+const BoundingVolume& StaticBatch::GetPropBounds(int t_prop) const {
+    return props[t_prop].bounds;
+}
+
+bool StaticBatch::IsPropVisible(int t_prop) const {
+    return props[t_prop].visible;
+}
+
+// Ray against each visible prop's box, then its baked triangles (Moller-Trumbore)
+int StaticBatch::Pick(const glm::vec3 t_origin, const glm::vec3 t_direction, GLfloat* t_distance) const {
+    int closestProp = -1;
+    GLfloat closest = std::numeric_limits<GLfloat>::max();
+    for (size_t p = 0; p < props.size(); ++p) {
+        const BakedProp& prop = props[p];
+        if (!prop.visible || prop.bounds.IsEmpty()) {
+            continue;
+        }
+        // Slab test; a hit further than the closest triangle so far cannot win.
+        GLfloat entry = 0.0f;
+        GLfloat exit = closest;
+        for (int axis = 0; axis < 3 && entry <= exit; ++axis) {
+            if (t_direction[axis] == 0.0f) {
+                // Parallel to this slab: inside it or a miss.
+                if (t_origin[axis] < prop.bounds.boxMin[axis] || t_origin[axis] > prop.bounds.boxMax[axis]) {
+                    exit = -1.0f;
+                }
+                continue;
+            }
+            const GLfloat inverse = 1.0f / t_direction[axis];
+            GLfloat nearHit = (prop.bounds.boxMin[axis] - t_origin[axis]) * inverse;
+            GLfloat farHit = (prop.bounds.boxMax[axis] - t_origin[axis]) * inverse;
+            if (nearHit > farHit) {
+                std::swap(nearHit, farHit);
+            }
+            entry = std::max(entry, nearHit);
+            exit = std::min(exit, farHit);
+        }
+        if (entry > exit) {
+            continue;
+        }
+
+        for (const StaticBatchRange& range : prop.ranges) {
+            const Mesh& mesh = groups[range.group].mesh;
+            for (GLuint i = range.firstIndex; i + 2 < range.firstIndex + range.indexCount; i += 3) {
+                const GLfloat* a = &mesh.vertexData[static_cast<size_t>(mesh.indexData[i]) * RichWerks::FLOATS_PER_MESH_VERTEX];
+                const GLfloat* b = &mesh.vertexData[static_cast<size_t>(mesh.indexData[i + 1]) * RichWerks::FLOATS_PER_MESH_VERTEX];
+                const GLfloat* c = &mesh.vertexData[static_cast<size_t>(mesh.indexData[i + 2]) * RichWerks::FLOATS_PER_MESH_VERTEX];
+                const glm::vec3 v0(a[0], a[1], a[2]);
+                const glm::vec3 edge1 = glm::vec3(b[0], b[1], b[2]) - v0;
+                const glm::vec3 edge2 = glm::vec3(c[0], c[1], c[2]) - v0;
+                const glm::vec3 h = glm::cross(t_direction, edge2);
+                const GLfloat determinant = glm::dot(edge1, h);
+                if (std::abs(determinant) < 1.0e-12f) {
+                    continue;   // Ray parallel to the triangle
+                }
+                const glm::vec3 s = t_origin - v0;
+                const GLfloat u = glm::dot(s, h) / determinant;
+                const glm::vec3 q = glm::cross(s, edge1);
+                const GLfloat v = glm::dot(t_direction, q) / determinant;
+                const GLfloat t = glm::dot(edge2, q) / determinant;
+                if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t < closest) {
+                    closest = t;
+                    closestProp = static_cast<int>(p);
+                }
+            }
+        }
+    }
+    if (t_distance != nullptr && closestProp >= 0) {
+        *t_distance = closest;
+    }
+    return closestProp;
+}
+
+int StaticBatch::GetPropCount() const {
+    return static_cast<int>(props.size());
+}
+
+int StaticBatch::GetGroupCount() const {
+    return static_cast<int>(groups.size());
+}
+
+// The properties the shaders read. Material::color is not used by any of them.
+bool StaticBatch::sameMaterial(const Material& a, const Material& b) {
+    return a.texture == b.texture && a.shininess == b.shininess && a.emission == b.emission
+        && a.materialScatterG == b.materialScatterG && a.materialAlpha == b.materialAlpha;
+}
+
+// Write a range's world-space vertices into its group from the model-space source, returning their bounds
+BoundingVolume StaticBatch::bakeRange(const StaticBatchRange& range, const glm::mat4& model) {
+    Mesh world;
+    world.vertexData = range.localVertices;
+    std::transformMesh(world, model);
+    std::copy(world.vertexData.begin(), world.vertexData.end(),
+        groups[range.group].mesh.vertexData.begin() + static_cast<size_t>(range.firstVertex) * RichWerks::FLOATS_PER_MESH_VERTEX);
+    return world.bounds;
+}
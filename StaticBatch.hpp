@@ -0,0 +1,90 @@
+/*
+ * File:          StaticBatch.hpp
+ * Description:   Static batching. Props that never move on their own are baked once:
+ *                their meshes are transformed into world space and merged with every
+ *                other mesh drawn by the same shader with the same material, so each
+ *                shader/material pair becomes one vertex/index buffer and one draw call.
+ *                Each baked prop keeps an id and its range in the merged buffers, so it
+ *                can still be picked, hidden or moved (its range is re-baked in place).
+ */
+
+#include "UGLProp.hpp"
+
+#ifndef _StaticBatch_
+#define _StaticBatch_
+
+#pragma once
+namespace RichWerks {
+    // Where one mesh of a baked prop lives inside a batch group.
+    struct StaticBatchRange {
+        int group = 0;
+        GLuint firstIndex = 0;
+        GLuint indexCount = 0;
+        GLuint firstVertex = 0;
+        GLuint vertexCount = 0;
+        std::vector<GLfloat> localVertices;     // Model-space source the range is baked from
+    };
+
+    class StaticBatch
+    {
+    public:
+        StaticBatch() = default;
+        StaticBatch(const StaticBatch&) = delete;
+        StaticBatch& operator=(const StaticBatch&) = delete;
+
+        // Bake the full-detail meshes of a prop under its current model matrix and return the
+        // prop's id in this batch. Mesh i uses material i (or the last material), like
+        // UGLProp::Render. LODs, meshlets and procedural meshes are not carried over, so only
+        // bake props whose full-detail meshes are what should be drawn.
+        int AddProp(const UGLProp& t_prop);
+        // Upload the groups changed by AddProp. Call after the last prop is added.
+        void BindMesh();
+        // One draw per group; hidden props and props outside the view frustum are skipped with a
+        // multi-draw over the remaining ranges.
+        void Render(FrameUniforms& t_frame);
+
+        // Editing by prop id. A new transform re-bakes the prop's ranges and updates them on the GPU.
+        void SetPropTransform(int t_prop, const glm::mat4& t_model);
+        void SetPropVisible(int t_prop, bool t_visible);
+        const glm::mat4& GetPropTransform(int t_prop) const;
+        const BoundingVolume& GetPropBounds(int t_prop) const;
+        bool IsPropVisible(int t_prop) const;
+
+        // Id of the closest visible prop whose triangles the ray hits, or -1. The hit distance is
+        // in units of t_direction's length.
+        int Pick(const glm::vec3 t_origin, const glm::vec3 t_direction, GLfloat* t_distance = nullptr) const;
+
+        int GetPropCount() const;
+        // Draw calls per frame while every prop is visible.
+        int GetGroupCount() const;
+
+    protected:
+        // Everything drawn by one shader with one material.
+        struct Group {
+            Shader* shader = nullptr;
+            PropUniforms uniforms;                      // Resolved for shader when the group is created
+            Material material;
+            Mesh mesh;                                  // World space
+            std::vector<std::pair<int, int>> members;   // (prop id, range index), in buffer order
+            bool dirty = true;                          // Changed since the last upload
+        };
+
+        struct BakedProp {
+            std::vector<StaticBatchRange> ranges;
+            glm::mat4 model = glm::mat4(1.0f);
+            BoundingVolume bounds;      // World space
+            bool visible = true;
+        };
+
+        static bool sameMaterial(const Material& a, const Material& b);
+        BoundingVolume bakeRange(const StaticBatchRange& range, const glm::mat4& model);
+
+        std::vector<Group> groups;
+        std::vector<BakedProp> props;
+        std::vector<bool> propsInView;          // Scratch: visible and inside the frustum this frame
+        std::vector<GLsizei> drawCounts;        // Scratch for the visible runs of one group
+        std::vector<const void*> drawOffsets;
+    };
+
+}
+#endif // !_StaticBatch_
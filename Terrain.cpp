@@ -0,0 +1,438 @@
+#include "Terrain.hpp"
+#include "GLStateCache.hpp"
+#include "MeshGenerator.hpp"
+#include <algorithm>
+#include <limits>
+#include <queue>
+using namespace RichWerks;
+
+namespace {
+    // Key of the root tile, which is never evicted so there is always something to draw.
+    const uint64_t ROOT_TILE = 0;
+
+    // A split tile stays split until the camera is this much further than the split distance,
+    // so hovering at a boundary does not rebuild the same tiles every frame.
+    const GLfloat SPLIT_HYSTERESIS = 1.15f;
+}
+
+Terrain::Terrain(HeightFunction t_height, TerrainSettings t_settings)
+    : height(std::move(t_height)), settings(t_settings) {
+    settings.tileDivisions = std::max(1, std::min(settings.tileDivisions, 250));
+    settings.maxDepth = std::max(0, std::min(settings.maxDepth, 20));
+    settings.tileSlots = std::max(settings.tileSlots, 8);
+    settings.tilesPerFrame = std::max(settings.tilesPerFrame, 1);
+
+    // A generatePlane grid plus one skirt vertex below every edge vertex.
+    const GLint divisions = settings.tileDivisions;
+    const MeshCounts grid = std::countPlane(divisions);
+    verticesPerTile = static_cast<GLint>(grid.vertexCount) + 4 * (divisions + 1);
+    indicesPerTile = static_cast<GLint>(grid.indexCount) + 4 * divisions * 6;
+}
+
+Terrain::~Terrain() {
+    // Workers write into the mapped buffer, so they must be done before it goes away.
+    for (auto& entry : tiles) {
+        if (entry.second.pending.valid()) {
+            entry.second.pending.wait();
+        }
+    }
+    for (RetiredSlot& retired : retiredSlots) {
+        if (retired.pending.valid()) {
+            retired.pending.wait();
+        }
+        glDeleteSync(retired.fence);
+    }
+    if (vao != 0) {
+        GLStateCache& state = GLStateCache::Current();
+        state.BindBuffer(GL_ARRAY_BUFFER, vbos[0]);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        state.DeleteVertexArrays(1, &vao);
+        state.DeleteBuffers(2, vbos);
+    }
+}
+
+void Terrain::AttachShader(Shader& t_shader) {
+    shader = &t_shader;
+    uniforms.Resolve(t_shader);
+}
+
+void Terrain::SetMaterial(Material t_material) {
+    material = t_material;
+}
+
+// Allocate the slot pool and the shared index buffer, then build the root tile on this thread.
+void Terrain::BindMesh() {
+    const GLint divisions = settings.tileDivisions;
+    const GLint gridVertices = (divisions + 1) * (divisions + 1);
+
+    // Every tile has the same topology, so one index list serves them all with a base vertex.
+    std::vector<GLfloat> scratchVertices(static_cast<size_t>(gridVertices) * RichWerks::FLOATS_PER_MESH_VERTEX);
+    std::vector<GLuint> gridIndices(std::countPlane(divisions).indexCount);
+    std::generatePlane(1.0f, 1.0f, divisions, scratchVertices.data(), gridIndices.data());
+    std::vector<GLushort> indices(gridIndices.begin(), gridIndices.end());
+    indices.reserve(indicesPerTile);
+    for (int edge = 0; edge < 4; ++edge) {
+        const GLushort skirt = static_cast<GLushort>(gridVertices + edge * (divisions + 1));
+        for (int k = 0; k < divisions; ++k) {
+            // Edges: first row, last row, first column, last column.
+            const auto gridIndex = [&](int i) {
+                return static_cast<GLushort>(edge == 0 ? i : edge == 1 ? divisions * (divisions + 1) + i
+                    : edge == 2 ? i * (divisions + 1) : i * (divisions + 1) + divisions);
+            };
+            const GLushort a = gridIndex(k);
+            const GLushort b = gridIndex(k + 1);
+            const GLushort below = static_cast<GLushort>(skirt + k);
+            indices.insert(indices.end(), { a, b, below, b, static_cast<GLushort>(below + 1), below });
+        }
+    }
+
+    const GLsizeiptr vertexBytes = static_cast<GLsizeiptr>(settings.tileSlots) * verticesPerTile * RichWerks::FLOATS_PER_MESH_VERTEX * sizeof(GLfloat);
+    const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(2, vbos);
+    GLStateCache& state = GLStateCache::Current();
+    state.BindVertexArray(vao);
+    state.BindBuffer(GL_ARRAY_BUFFER, vbos[0]);
+    glBufferStorage(GL_ARRAY_BUFFER, vertexBytes, nullptr, mapFlags);
+    mappedVertices = static_cast<GLfloat*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, vertexBytes, mapFlags));
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbos[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+
+    const GLsizei stride = sizeof(float) * RichWerks::FLOATS_PER_MESH_VERTEX;
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, 0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 3));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 6));
+    glEnableVertexAttribArray(2);
+
+    freeSlots.clear();
+    for (GLint slot = settings.tileSlots - 1; slot >= 0; --slot) {
+        freeSlots.push_back(slot);
+    }
+
+    Tile& root = tiles[ROOT_TILE];
+    root.slot = acquireSlot();
+    const glm::vec2 range = buildTile(ROOT_TILE, root.slot);
+    root.resident = true;
+    root.minHeight = range.x;
+    root.maxHeight = range.y;
+}
+
+void Terrain::Update(const glm::vec3 t_cameraPosition) {
+    if (vao == 0) {
+        return;
+    }
+    ++frame;
+    reclaimSlots();
+    for (auto& entry : tiles) {
+        Tile& tile = entry.second;
+        if (tile.pending.valid() && tile.pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            const glm::vec2 range = tile.pending.get();
+            tile.resident = true;
+            tile.minHeight = range.x;
+            tile.maxHeight = range.y;
+        }
+    }
+
+    refine(t_cameraPosition);
+    drawTiles.clear();
+    cover(ROOT_TILE, splitNodes.count(ROOT_TILE) == 0);
+    for (const uint64_t key : drawTiles) {
+        tiles[key].lastUsedFrame = frame;
+    }
+    for (const uint64_t key : desiredLeaves) {
+        auto it = tiles.find(key);
+        if (it != tiles.end()) {
+            it->second.lastUsedFrame = frame;
+        }
+    }
+    requestTiles();
+}
+
+void Terrain::Render(FrameUniforms& t_frame) {
+    const FrameData& frame = t_frame.GetFrameData();
+    Update(frame.cameraPosition);
+    if (drawTiles.empty()) {
+        return;
+    }
+    GLStateCache& state = GLStateCache::Current();
+    state.UseProgram(shader->ID);
+    // Tiles are built in world space.
+    shader->set(uniforms.objectIndex, t_frame.AddObject(glm::mat4(1.0f), glm::mat4(1.0f)));
+    shader->set(uniforms.positionOffset, glm::vec3(0.0f));
+    shader->set(uniforms.positionScale, glm::vec3(1.0f));
+    shader->set(uniforms.materialShininess, material.shininess);
+    shader->set(uniforms.materialEmission, material.emission);
+    state.BindTexture(0, GL_TEXTURE_2D, material.texture);
+
+    // One draw for every visible tile, each offset to its slot by the base vertex.
+    glm::vec4 planes[6];
+    std::extractFrustumPlanes(frame.viewProjection, planes);
+    drawCounts.clear();
+    drawOffsets.clear();
+    drawBaseVertices.clear();
+    for (const uint64_t key : drawTiles) {
+        const Tile& tile = tiles[key];
+        int level, x, z;
+        tileCoordinates(key, level, x, z);
+        const glm::vec2 corner = tileMin(key);
+        const GLfloat size = tileSize(level);
+        if (!std::isBoxInFrustum(glm::vec3(corner.x, tile.minHeight, corner.y), glm::vec3(corner.x + size, tile.maxHeight, corner.y + size), planes)) {
+            continue;
+        }
+        drawCounts.push_back(indicesPerTile);
+        drawOffsets.push_back(nullptr);
+        drawBaseVertices.push_back(tile.slot * verticesPerTile);
+    }
+    if (drawCounts.empty()) {
+        return;
+    }
+    state.BindVertexArray(vao);
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_SHORT, drawOffsets.data(),
+        static_cast<GLsizei>(drawCounts.size()), drawBaseVertices.data());
+}
+
+GLfloat Terrain::GetHeight(GLfloat x, GLfloat z) const {
+    return height(x, z);
+}
+
+size_t Terrain::GetGpuBytes() const {
+    return static_cast<size_t>(settings.tileSlots) * verticesPerTile * RichWerks::FLOATS_PER_MESH_VERTEX * sizeof(GLfloat)
+        + static_cast<size_t>(indicesPerTile) * sizeof(GLushort);
+}
+
+int Terrain::GetResidentTileCount() const {
+    int count = 0;
+    for (const auto& entry : tiles) {
+        count += entry.second.resident ? 1 : 0;
+    }
+    return count;
+}
+
+int Terrain::GetDrawnTileCount() const {
+    return static_cast<int>(drawTiles.size());
+}
+
+// Level in the top bits, then the tile's column and row (each under 2^24) at that level.
+uint64_t Terrain::tileKey(int level, int x, int z) {
+    return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(x) << 24) | static_cast<uint64_t>(z);
+}
+
+void Terrain::tileCoordinates(uint64_t key, int& level, int& x, int& z) {
+    level = static_cast<int>(key >> 48);
+    x = static_cast<int>((key >> 24) & 0xFFFFFF);
+    z = static_cast<int>(key & 0xFFFFFF);
+}
+
+GLfloat Terrain::tileSize(int level) const {
+    return settings.extent / static_cast<GLfloat>(1 << level);
+}
+
+// Corner of the tile with the smallest x and z.
+glm::vec2 Terrain::tileMin(uint64_t key) const {
+    int level, x, z;
+    tileCoordinates(key, level, x, z);
+    const GLfloat size = tileSize(level);
+    return glm::vec2(-0.5f * settings.extent + x * size, -0.5f * settings.extent + z * size);
+}
+
+// Distance from a point to the tile's box. The height range comes from the tile, or from its
+// closest resident ancestor while it has not been built.
+GLfloat Terrain::tileDistance(uint64_t key, const glm::vec3 position) const {
+    int level, x, z;
+    tileCoordinates(key, level, x, z);
+    glm::vec2 range(0.0f);
+    for (int ancestor = level; ancestor >= 0; --ancestor) {
+        auto it = tiles.find(tileKey(ancestor, x >> (level - ancestor), z >> (level - ancestor)));
+        if (it != tiles.end() && it->second.resident) {
+            range = glm::vec2(it->second.minHeight, it->second.maxHeight);
+            break;
+        }
+    }
+    const glm::vec2 corner = tileMin(key);
+    const GLfloat size = tileSize(level);
+    const glm::vec3 boxMin(corner.x, range.x, corner.y);
+    const glm::vec3 boxMax(corner.x + size, range.y, corner.y + size);
+    return glm::length(position - glm::clamp(position, boxMin, boxMax));
+}
+
+// Return slots whose tile was evicted once the GPU is past the fence and no worker still writes them.
+void Terrain::reclaimSlots() {
+    size_t kept = 0;
+    for (RetiredSlot& retired : retiredSlots) {
+        const bool workerDone = !retired.pending.valid() || retired.pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        const GLenum status = workerDone ? glClientWaitSync(retired.fence, 0, 0) : GL_TIMEOUT_EXPIRED;
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            glDeleteSync(retired.fence);
+            freeSlots.push_back(retired.slot);
+        }
+        else {
+            retiredSlots[kept++] = std::move(retired);
+        }
+    }
+    retiredSlots.erase(retiredSlots.begin() + kept, retiredSlots.end());
+}
+
+// Choose the cut through the quadtree: tiles split while the camera is within lodDistance of
+// their size, most needed first, until the leaves would take more than half the slots. The
+// other half holds the tiles drawn in place of leaves that are still being built.
+void Terrain::refine(const glm::vec3 position) {
+    std::unordered_set<uint64_t> previous;
+    previous.swap(splitNodes);
+    desiredLeaves.clear();
+
+    using Candidate = std::pair<GLfloat, uint64_t>;     // Distance over size, key
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    candidates.push({ tileDistance(ROOT_TILE, position) / tileSize(0), ROOT_TILE });
+    const int maxLeaves = settings.tileSlots / 2;
+    int leafCount = 1;
+    while (!candidates.empty()) {
+        const Candidate candidate = candidates.top();
+        candidates.pop();
+        int level, x, z;
+        tileCoordinates(candidate.second, level, x, z);
+        const GLfloat threshold = settings.lodDistance * (previous.count(candidate.second) != 0 ? SPLIT_HYSTERESIS : 1.0f);
+        if (level < settings.maxDepth && candidate.first < threshold && leafCount + 3 <= maxLeaves) {
+            splitNodes.insert(candidate.second);
+            leafCount += 3;
+            for (int child = 0; child < 4; ++child) {
+                const uint64_t childKey = tileKey(level + 1, x * 2 + (child & 1), z * 2 + (child >> 1));
+                candidates.push({ tileDistance(childKey, position) / tileSize(level + 1), childKey });
+            }
+        }
+        else {
+            desiredLeaves.push_back(candidate.second);
+        }
+    }
+}
+
+// Add resident tiles covering the tile's area to drawTiles. Above the cut the children are
+// preferred and the tile itself stands in for them until they are all ready; at or below it
+// the tile is drawn if ready, else its resident children (from a finer cut) are.
+bool Terrain::cover(uint64_t key, bool atOrBelowCut) {
+    int level, x, z;
+    tileCoordinates(key, level, x, z);
+    auto it = tiles.find(key);
+    const bool ready = it != tiles.end() && it->second.resident;
+    const size_t mark = drawTiles.size();
+
+    if (atOrBelowCut && ready) {
+        drawTiles.push_back(key);
+        return true;
+    }
+    if (level < settings.maxDepth) {
+        bool covered = true;
+        for (int child = 0; child < 4 && covered; ++child) {
+            const uint64_t childKey = tileKey(level + 1, x * 2 + (child & 1), z * 2 + (child >> 1));
+            if (atOrBelowCut) {
+                covered = tiles.count(childKey) != 0 && cover(childKey, true);
+            }
+            else {
+                covered = cover(childKey, splitNodes.count(childKey) == 0);
+            }
+        }
+        if (covered) {
+            return true;
+        }
+        drawTiles.resize(mark);
+    }
+    if (!atOrBelowCut && ready) {
+        drawTiles.push_back(key);
+        return true;
+    }
+    return false;
+}
+
+// Hand the most needed missing leaves to the workers, a few per frame.
+void Terrain::requestTiles() {
+    int requested = 0;
+    for (const uint64_t key : desiredLeaves) {
+        if (requested == settings.tilesPerFrame) {
+            break;
+        }
+        if (tiles.count(key) != 0) {
+            continue;
+        }
+        ++requested;
+        const GLint slot = acquireSlot();
+        if (slot < 0) {
+            continue;
+        }
+        Tile& tile = tiles[key];
+        tile.slot = slot;
+        tile.lastUsedFrame = frame;
+        tile.pending = ThreadPool::Shared().Submit([this, key, slot]() { return buildTile(key, slot); });
+    }
+}
+
+// A free slot, or -1 after evicting the least recently used tile that is not needed this frame.
+// The evicted tile's slot comes back through reclaimSlots once the GPU is done with it.
+GLint Terrain::acquireSlot() {
+    if (!freeSlots.empty()) {
+        const GLint slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+    auto oldest = tiles.end();
+    for (auto it = tiles.begin(); it != tiles.end(); ++it) {
+        if (it->first != ROOT_TILE && it->second.lastUsedFrame < frame
+            && (oldest == tiles.end() || it->second.lastUsedFrame < oldest->second.lastUsedFrame)) {
+            oldest = it;
+        }
+    }
+    if (oldest != tiles.end()) {
+        retiredSlots.push_back({ oldest->second.slot, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(oldest->second.pending) });
+        tiles.erase(oldest);
+    }
+    return -1;
+}
+
+// Build a tile into its slot (runs on a worker): a generatePlane grid moved to the tile,
+// displaced by the height function, with central-difference normals, world-space texture
+// coordinates and the skirts. Returns the tile's height range, skirts included.
+glm::vec2 Terrain::buildTile(uint64_t key, GLint slot) const {
+    int level, x, z;
+    tileCoordinates(key, level, x, z);
+    const GLint divisions = settings.tileDivisions;
+    const GLint gridVertices = (divisions + 1) * (divisions + 1);
+    const GLfloat size = tileSize(level);
+    const GLfloat spacing = size / divisions;
+    const glm::vec2 center = tileMin(key) + glm::vec2(0.5f * size);
+
+    GLfloat* vertices = mappedVertices + static_cast<size_t>(slot) * verticesPerTile * RichWerks::FLOATS_PER_MESH_VERTEX;
+    thread_local std::vector<GLuint> scratchIndices;
+    scratchIndices.resize(std::countPlane(divisions).indexCount);
+    std::generatePlane(size, size, divisions, vertices, scratchIndices.data());
+
+    glm::vec2 range(std::numeric_limits<GLfloat>::max(), std::numeric_limits<GLfloat>::lowest());
+    for (GLint i = 0; i < gridVertices; ++i) {
+        GLfloat* vertex = vertices + i * RichWerks::FLOATS_PER_MESH_VERTEX;
+        const GLfloat worldX = vertex[0] + center.x;
+        const GLfloat worldZ = vertex[2] + center.y;
+        const GLfloat y = height(worldX, worldZ);
+        const GLfloat slopeX = height(worldX + spacing, worldZ) - height(worldX - spacing, worldZ);
+        const GLfloat slopeZ = height(worldX, worldZ + spacing) - height(worldX, worldZ - spacing);
+        const glm::vec3 normal = glm::normalize(glm::vec3(-slopeX, 2.0f * spacing, -slopeZ));
+        range = glm::vec2(std::min(range.x, y), std::max(range.y, y));
+        // Same texture orientation as the plane generator, repeating every textureScale units.
+        const GLfloat attributes[8] = { worldX, y, worldZ, normal.x, normal.y, normal.z,
+            worldX / settings.textureScale + 0.5f, 0.5f - worldZ / settings.textureScale };
+        std::copy(attributes, attributes + 8, vertex);
+    }
+
+    // Skirts: a copy of each edge row/column, lowered. Same edge order as the index buffer.
+    const GLfloat skirtDepth = settings.skirtDepth * size;
+    GLfloat* skirt = vertices + static_cast<size_t>(gridVertices) * RichWerks::FLOATS_PER_MESH_VERTEX;
+    for (int edge = 0; edge < 4; ++edge) {
+        for (int k = 0; k <= divisions; ++k) {
+            const int source = edge == 0 ? k : edge == 1 ? divisions * (divisions + 1) + k
+                : edge == 2 ? k * (divisions + 1) : k * (divisions + 1) + divisions;
+            std::copy(vertices + source * RichWerks::FLOATS_PER_MESH_VERTEX, vertices + (source + 1) * RichWerks::FLOATS_PER_MESH_VERTEX, skirt);
+            skirt[1] -= skirtDepth;
+            skirt += RichWerks::FLOATS_PER_MESH_VERTEX;
+        }
+    }
+    range.x -= skirtDepth;
+    return range;
+}
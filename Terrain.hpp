@@ -0,0 +1,123 @@
+/*
+ * File:          Terrain.hpp
+ * Description:   Streaming heightfield terrain (chunked LOD). The terrain is a quadtree of
+ *                square tiles; every tile is a generatePlane grid of the same resolution,
+ *                displaced by a height function, so a tile one level down has four times
+ *                the density over a quarter of the area. Each frame the tree is refined
+ *                around the camera and missing tiles are built on the shared thread pool,
+ *                straight into a fixed pool of slots in one persistently mapped vertex
+ *                buffer. GPU memory never grows past that pool, and nothing is generated
+ *                or uploaded on the render thread: until a tile is ready its resident
+ *                parent (or children) keep being drawn in its place. Skirts hang from
+ *                every tile edge to hide the cracks between neighbouring levels.
+ */
+
+#include "UGLProp.hpp"
+#include "ThreadPool.hpp"
+#include <unordered_map>
+#include <unordered_set>
+
+#ifndef _Terrain_
+#define _Terrain_
+
+#pragma once
+namespace RichWerks {
+    // World-space height at (x, z). Called from worker threads, so it must be thread-safe.
+    using HeightFunction = std::function<GLfloat(GLfloat x, GLfloat z)>;
+
+    struct TerrainSettings {
+        GLfloat extent = 512.0f;        // Side of the square terrain, centered on the origin
+        GLint tileDivisions = 32;       // Quads along a tile side (at most 250, for 16-bit indices)
+        GLint maxDepth = 6;             // Quadtree levels below the root tile
+        GLfloat lodDistance = 2.5f;     // A tile splits while the camera is within lodDistance * its size
+        GLint tileSlots = 192;          // Resident tiles; this fixes the GPU memory used
+        GLint tilesPerFrame = 4;        // Most tiles handed to the workers per frame
+        GLfloat skirtDepth = 0.02f;     // Skirt length as a fraction of the tile size
+        GLfloat textureScale = 40.0f;   // World units per texture repeat
+    };
+
+    class Terrain
+    {
+    public:
+        Terrain(HeightFunction t_height, TerrainSettings t_settings = TerrainSettings());
+        Terrain(const Terrain&) = delete;
+        Terrain& operator=(const Terrain&) = delete;
+        // Waits for tiles still being built before releasing the buffers.
+        ~Terrain();
+
+        // Same lighting setup as UGLProp: attach a shader built from shaders/phong_shader.vs.
+        void AttachShader(Shader& t_shader);
+        void SetMaterial(Material t_material);
+        // Create the GPU buffers and build the root tile. Needs a current context.
+        void BindMesh();
+
+        // Refine the tree around the camera, pick up finished tiles and queue missing ones.
+        // Render calls this; call it directly to stream without drawing.
+        void Update(const glm::vec3 t_cameraPosition);
+        // Call between t_frame.Begin and t_frame.End.
+        void Render(FrameUniforms& t_frame);
+
+        GLfloat GetHeight(GLfloat x, GLfloat z) const;
+        // Bytes of vertex and index data on the GPU, fixed once BindMesh has run.
+        size_t GetGpuBytes() const;
+        int GetResidentTileCount() const;
+        int GetDrawnTileCount() const;
+
+    protected:
+        struct Tile {
+            GLint slot = -1;
+            std::future<glm::vec2> pending;     // Worker filling the slot; returns the height range
+            bool resident = false;
+            GLfloat minHeight = 0.0f;
+            GLfloat maxHeight = 0.0f;
+            unsigned long long lastUsedFrame = 0;
+        };
+
+        // Slot of an evicted tile, free again once the worker (if any) is done with it and the
+        // GPU has finished the draws issued before the eviction.
+        struct RetiredSlot {
+            GLint slot;
+            GLsync fence;
+            std::future<glm::vec2> pending;
+        };
+
+        static uint64_t tileKey(int level, int x, int z);
+        static void tileCoordinates(uint64_t key, int& level, int& x, int& z);
+        GLfloat tileSize(int level) const;
+        glm::vec2 tileMin(uint64_t key) const;
+        GLfloat tileDistance(uint64_t key, const glm::vec3 position) const;
+
+        void reclaimSlots();
+        void refine(const glm::vec3 position);
+        bool cover(uint64_t key, bool atOrBelowCut);
+        void requestTiles();
+        GLint acquireSlot();
+        glm::vec2 buildTile(uint64_t key, GLint slot) const;
+
+        HeightFunction height;
+        TerrainSettings settings;
+        GLint verticesPerTile = 0;
+        GLint indicesPerTile = 0;
+
+        std::unordered_map<uint64_t, Tile> tiles;
+        std::unordered_set<uint64_t> splitNodes;    // Internal nodes of the current cut
+        std::vector<uint64_t> desiredLeaves;        // Leaves of the current cut, most needed first
+        std::vector<uint64_t> drawTiles;            // Resident tiles covering the terrain this frame
+        std::vector<GLint> freeSlots;
+        std::vector<RetiredSlot> retiredSlots;
+        unsigned long long frame = 0;
+
+        GLuint vao = 0;
+        GLuint vbos[2] = { 0, 0 };
+        GLfloat* mappedVertices = nullptr;          // Persistently mapped; written by the workers
+        std::vector<GLsizei> drawCounts;
+        std::vector<const void*> drawOffsets;
+        std::vector<GLint> drawBaseVertices;
+
+        Material material;
+        Shader* shader = nullptr;
+        PropUniforms uniforms;      // Resolved by AttachShader
+    };
+
+}
+#endif // !_Terrain_
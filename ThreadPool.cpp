@@ -0,0 +1,106 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+using namespace RichWerks;
+
+// Start the workers
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+// Drain the queue and join the workers
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::ParallelFor(const size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    // Shared so helpers that only get scheduled after the loop has finished (e.g. when called
+    // from inside another task) find no chunks left and return without touching the caller.
+    struct Loop {
+        const std::function<void(size_t)>* body;
+        size_t count;
+        size_t chunkSize;
+        size_t chunkCount;
+        std::atomic<size_t> nextChunk{ 0 };
+        std::atomic<size_t> finishedChunks{ 0 };
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto loop = std::make_shared<Loop>();
+    loop->body = &body;
+    loop->count = count;
+    // A few chunks per thread balances uneven items without a queue entry per item.
+    loop->chunkCount = std::min(count, (workers.size() + 1) * 4);
+    loop->chunkSize = (count + loop->chunkCount - 1) / loop->chunkCount;
+    loop->chunkCount = (count + loop->chunkSize - 1) / loop->chunkSize;
+
+    const auto runChunks = [loop]() {
+        for (size_t chunk = loop->nextChunk++; chunk < loop->chunkCount; chunk = loop->nextChunk++) {
+            const size_t end = std::min(loop->count, (chunk + 1) * loop->chunkSize);
+            for (size_t i = chunk * loop->chunkSize; i < end; ++i) {
+                (*loop->body)(i);
+            }
+            if (++loop->finishedChunks == loop->chunkCount) {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->finished.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(workers.size(), loop->chunkCount - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        Enqueue(runChunks);
+    }
+    runChunks();
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&loop]() { return loop->finishedChunks == loop->chunkCount; });
+}
+
+size_t ThreadPool::GetThreadCount() const {
+    return workers.size();
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,67 @@
+/*
+ * File:          ThreadPool.hpp
+ * Description:   Fixed set of worker threads for CPU-side mesh work (simplification,
+ *                generation, terrain streaming). Tasks are queued and picked up in
+ *                order; Submit returns a future for the task's result.
+ */
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#ifndef _ThreadPool_
+#define _ThreadPool_
+
+#pragma once
+namespace RichWerks {
+
+    class ThreadPool
+    {
+    public:
+        // Start threadCount workers; 0 uses one per hardware thread.
+        explicit ThreadPool(unsigned int threadCount = 0);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        // Finishes every queued task before joining the workers.
+        ~ThreadPool();
+
+        // Queue a task and return a future for its result.
+        template <class F>
+        std::future<std::invoke_result_t<F>> Submit(F task);
+
+        // Run body(i) for every i in [0, count) across the workers and wait for all of them.
+        // Work is handed out in contiguous chunks; the calling thread takes part too, so it is
+        // safe to call from inside a task. body must not throw.
+        void ParallelFor(const size_t count, const std::function<void(size_t)>& body);
+
+        size_t GetThreadCount() const;
+
+        // Pool shared by the mesh tools, sized to the machine.
+        static ThreadPool& Shared();
+
+    protected:
+        void Enqueue(std::function<void()> task);
+        void WorkerLoop();
+
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+    };
+
+    template <class F>
+    std::future<std::invoke_result_t<F>> ThreadPool::Submit(F task) {
+        // packaged_task is move-only and std::function needs copyable targets, so share it.
+        auto packaged = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::move(task));
+        std::future<std::invoke_result_t<F>> result = packaged->get_future();
+        Enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+}
+#endif // !_ThreadPool_
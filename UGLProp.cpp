@@ -1,4 +1,10 @@
 #include "UGLProp.hpp"
+#include "GLStateCache.hpp"
+#include "MeshGenerator.hpp"
+#include "MeshLOD.hpp"
+#include "MeshletBuilder.hpp"
+#include "MeshSimplifier.hpp"
+#include "RenderQueue.hpp"
 using namespace RichWerks;
 
 // Default constructor
@@ -24,25 +30,25 @@ UGLProp::UGLProp(glm::vec3 t_position, glm::vec3 t_direction) {
 // Constructor with mesh and material parameters
 UGLProp::UGLProp(Mesh t_mesh, Material t_material) {
     UGLObject(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f)); // Call UGLObject constructor with default position and direction
-    meshVector.push_back(t_mesh);
     materialVector.push_back(t_material);
     model = glm::mat4(1.0f);
     rotation = glm::rotate(glm::radians(0.0f), glm::vec3(0.0f, 0.0f, 0.0f));
     scale = glm::scale(glm::vec3(1.0f, 1.0f, 1.0f));
     translation = glm::translate(position);
     model = translation * rotation * scale;
+    AddMesh(t_mesh);
 }
 
 // Constructor with position, direction, mesh, and material parameters
 UGLProp::UGLProp(glm::vec3 t_position, glm::vec3 t_direction, Mesh t_mesh, Material t_material) {
     UGLObject(t_position, t_direction); // Call UGLObject constructor with parameters
     materialVector.push_back(t_material);
-    meshVector.push_back(t_mesh);
     model = glm::mat4(1.0f);
     rotation = glm::rotate(glm::radians(0.0f), glm::vec3(0.0f, 0.0f, 0.0f));
     scale = glm::scale(glm::vec3(1.0f, 1.0f, 1.0f));
     translation = glm::translate(position);
     model = translation * rotation * scale;
+    AddMesh(t_mesh);
 }
 
 // Copy constructor
@@ -55,8 +61,17 @@ UGLProp::UGLProp(UGLProp&& prop) noexcept
     : UGLObject(std::move(prop)), // Call base class move constructor
     materialVector(std::move(prop.materialVector)),
     meshVector(std::move(prop.meshVector)),
+    lodVector(std::move(prop.lodVector)),
+    proceduralMesh(std::move(prop.proceduralMesh)),
+    tessellated(prop.tessellated),
+    pixelsPerSegment(prop.pixelsPerSegment),
+    localBounds(prop.localBounds),
+    worldBounds(prop.worldBounds),
+    currentLOD(prop.currentLOD),
     shader(prop.shader),
+    uniforms(prop.uniforms),
     model(prop.model),
+    normalMatrix(prop.normalMatrix),
     scale(prop.scale),
     rotation(prop.rotation),
     translation(prop.translation) {
@@ -90,8 +105,17 @@ UGLProp& UGLProp::operator=(UGLProp&& prop) noexcept {
         // Move resources from the other object
         materialVector = std::move(prop.materialVector);
         meshVector = std::move(prop.meshVector);
+        lodVector = std::move(prop.lodVector);
+        proceduralMesh = std::move(prop.proceduralMesh);
+        tessellated = prop.tessellated;
+        pixelsPerSegment = prop.pixelsPerSegment;
+        localBounds = prop.localBounds;
+        worldBounds = prop.worldBounds;
+        currentLOD = prop.currentLOD;
         shader = prop.shader;
+        uniforms = prop.uniforms;
         model = prop.model;
+        normalMatrix = prop.normalMatrix;
         scale = prop.scale;
         rotation = prop.rotation;
         translation = prop.translation;
@@ -106,8 +130,17 @@ UGLProp& UGLProp::operator=(UGLProp&& prop) noexcept {
 void UGLProp::Copy(const UGLProp& prop) {
     materialVector = prop.materialVector;
     meshVector = prop.meshVector;
+    lodVector = prop.lodVector;
+    proceduralMesh = prop.proceduralMesh;
+    tessellated = prop.tessellated;
+    pixelsPerSegment = prop.pixelsPerSegment;
+    localBounds = prop.localBounds;
+    worldBounds = prop.worldBounds;
+    currentLOD = prop.currentLOD;
     shader = prop.shader;
+    uniforms = prop.uniforms;
     model = prop.model;
+    normalMatrix = prop.normalMatrix;
     scale = prop.scale;
     rotation = prop.rotation;
     translation = prop.translation;
@@ -116,6 +149,21 @@ void UGLProp::Copy(const UGLProp& prop) {
 // Attach a shader to the object
 void UGLProp::AttachShader(Shader& t_shader) {
     shader = &t_shader;
+    uniforms.Resolve(t_shader);
+}
+
+// Look up the per-draw uniforms once instead of by name on every frame
+void PropUniforms::Resolve(const Shader& t_shader) {
+    objectIndex = t_shader.getUniform<int>("objectIndex");
+    positionOffset = t_shader.getUniform<glm::vec3>("positionOffset");
+    positionScale = t_shader.getUniform<glm::vec3>("positionScale");
+    materialShininess = t_shader.getUniform<int>("materialShininess");
+    materialEmission = t_shader.getUniform<glm::vec3>("materialEmission");
+    proceduralShape = t_shader.getUniform<int>("proceduralShape");
+    proceduralParameters = t_shader.getUniform<glm::vec3>("proceduralParameters");
+    proceduralSegments = t_shader.getUniform<int>("proceduralSegments");
+    useInstanceTransforms = t_shader.getUniform<bool>("useInstanceTransforms");
+    pixelsPerSegment = t_shader.getUniform<float>("pixelsPerSegment");
 }
 
 // Get the shader ID
@@ -125,7 +173,7 @@ GLint UGLProp::GetShaderID() {
 
 // Use the attached shader
 void UGLProp::UseShader() {
-    shader->use();
+    GLStateCache::Current().UseProgram(shader->ID);
 }
 
 // Set shader uniform using different data types
@@ -140,6 +188,9 @@ void UGLProp::SetShaderUniform(T const& t_data, const char* t_name) {
     else if constexpr (std::is_same_v<T, int> || std::is_same_v<T, GLint>) {
         shader->setInt(t_name, t_data);
     }
+    else if constexpr (std::is_same_v<T, glm::vec2>) {
+        shader->setVec2(t_name, t_data);
+    }
     else if constexpr (std::is_same_v<T, glm::vec3>) {
         shader->setVec3(t_name, t_data);
     }
@@ -150,11 +201,75 @@ void UGLProp::SetShaderUniform(T const& t_data, const char* t_name) {
 
 // Add a mesh to the mesh vector
 void UGLProp::AddMesh(Mesh t_mesh) {
-    meshVector.push_back(t_mesh);
+    // Meshes assembled by hand (not through a generator) have no bounds yet.
+    if (t_mesh.bounds.IsEmpty()) {
+        std::computeMeshBounds(t_mesh);
+    }
+    AddMesh(std::make_shared<const Mesh>(std::move(t_mesh)));
+}
+
+// Add a shared mesh to the mesh vector without copying it
+void UGLProp::AddMesh(std::shared_ptr<const Mesh> t_mesh) {
+    if (t_mesh->bounds.IsEmpty()) {
+        Mesh bounded = *t_mesh;
+        std::computeMeshBounds(bounded);
+        t_mesh = std::make_shared<const Mesh>(std::move(bounded));
+    }
+    localBounds = std::mergeBounds(localBounds, t_mesh->bounds);
+    worldBounds = std::transformBounds(localBounds, model);
+    meshVector.push_back(std::move(t_mesh));
+}
+
+// Add a coarser level of detail
+void UGLProp::AddLOD(std::vector<std::shared_ptr<const Mesh>> t_meshes, GLfloat t_screenSize) {
+    lodVector.push_back({ std::move(t_meshes), t_screenSize });
+}
+
+// Simplify the full-detail meshes into a chain of LODs
+void UGLProp::GenerateLODs(const std::vector<GLfloat>& t_triangleRatios, const std::vector<GLfloat>& t_screenSizes, GLfloat t_maxError) {
+    const size_t levelCount = std::min(t_triangleRatios.size(), t_screenSizes.size());
+    std::vector<LODLevel> levels(levelCount);
+    const size_t meshCount = meshVector.size();
+    for (size_t level = 0; level < levelCount; ++level) {
+        levels[level].meshes.resize(meshCount);
+        levels[level].screenSize = t_screenSizes[level];
+    }
+
+    // Every (level, mesh) pair is independent, so simplify them all at once.
+    ThreadPool::Shared().ParallelFor(levelCount * meshCount, [&](const size_t task) {
+        Mesh mesh = *meshVector[task % meshCount];
+        mesh.buffer.reset();
+        SimplifyOptions options;
+        options.targetRatio = t_triangleRatios[task / meshCount];
+        options.targetError = t_maxError;
+        std::simplifyMesh(mesh, options);
+        levels[task / meshCount].meshes[task % meshCount] = std::make_shared<const Mesh>(std::move(mesh));
+    });
+
+    for (LODLevel& level : levels) {
+        lodVector.push_back(std::move(level));
+    }
+}
+
+// Draw a procedural mesh instead of the mesh vector
+void UGLProp::SetProceduralMesh(ProceduralMesh t_mesh) {
+    t_mesh.bounds = std::computeProceduralBounds(t_mesh);
+    localBounds = t_mesh.bounds;
+    worldBounds = std::transformBounds(localBounds, model);
+    proceduralMesh = std::move(t_mesh);
+}
+
+// Draw the procedural mesh through the tessellation stages when the context supports them
+void UGLProp::EnableTessellation(Shader& t_tessellationShader, GLfloat t_pixelsPerSegment) {
+    pixelsPerSegment = t_pixelsPerSegment;
+    tessellated = TessellationSupported() && t_tessellationShader.success;
+    if (tessellated) {
+        AttachShader(t_tessellationShader);
+    }
 }
 
 // Get a reference to the mesh vector
-std::vector<Mesh>& UGLProp::GetMeshVectorReference() {
+std::vector<std::shared_ptr<const Mesh>>& UGLProp::GetMeshVectorReference() {
     return meshVector;
 }
 
@@ -182,82 +297,379 @@ void UGLProp::Scale(glm::vec3 t_scale) {
     updateModel();
 }
 
-// Bind the mesh data
-void UGLProp::BindMesh() {
+// Release the GL objects of a mesh buffer
+MeshBuffer::~MeshBuffer() {
+    GLStateCache::Current().DeleteVertexArrays(1, &vao);
+    GLStateCache::Current().DeleteBuffers(2, vbos);
+}
+
+// Upload the mesh data to the GPU
+void RichWerks::UploadMesh(const Mesh& mesh) {
     const GLuint FLOATS_PER_VERTEX = 3;
     const GLuint FLOATS_PER_NORMAL = 3;
     const GLuint FLOATS_PER_TEX_COORD = 2;
-    for (Mesh& mesh : meshVector) {
-        glGenVertexArrays(1, &mesh.vao);
-        glBindVertexArray(mesh.vao);
 
-        glGenBuffers(2, mesh.vbos); // Creates 2 buffers
-        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbos[0]); // Activates the buffer
+    mesh.buffer = std::make_shared<MeshBuffer>();
+    glGenVertexArrays(1, &mesh.buffer->vao);
+    GLStateCache& state = GLStateCache::Current();
+    state.BindVertexArray(mesh.buffer->vao);
+
+    glGenBuffers(2, mesh.buffer->vbos); // Creates 2 buffers
+    state.BindBuffer(GL_ARRAY_BUFFER, mesh.buffer->vbos[0]); // Activates the buffer
+    const size_t vertexCount = mesh.vertexData.size() / (FLOATS_PER_VERTEX + FLOATS_PER_NORMAL + FLOATS_PER_TEX_COORD);
+    if (mesh.vertexFormat == VertexFormat::COMPACT) {
+        // Quantize against the mesh bounds; the vertex shader undoes it with positionOffset/positionScale.
+        glm::vec3 boundsMin, boundsMax;
+        std::computeVertexBounds(mesh.vertexData.data(), vertexCount, boundsMin, boundsMax);
+        std::vector<CompactVertex> compactData(vertexCount);
+        std::packCompactVertices(mesh.vertexData.data(), vertexCount, boundsMin, boundsMax, compactData.data());
+        mesh.buffer->positionOffset = (boundsMin + boundsMax) * 0.5f;
+        mesh.buffer->positionScale = (boundsMax - boundsMin) * 0.5f;
+        glBufferData(GL_ARRAY_BUFFER, compactData.size() * sizeof(CompactVertex), compactData.data(), GL_STATIC_DRAW);
+    }
+    else {
         glBufferData(GL_ARRAY_BUFFER, mesh.vertexData.size() * sizeof(mesh.vertexData[0]), &mesh.vertexData.front(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+    }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vbos[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexData.size() * sizeof(mesh.indexData[0]), &mesh.indexData.front(), GL_STATIC_DRAW);
-
-        // Stride of each vertex coordinate in array
-        GLint stride = sizeof(float) * (FLOATS_PER_VERTEX + FLOATS_PER_NORMAL + FLOATS_PER_TEX_COORD);
+    // Use the narrowest index type that can address every vertex.
+    mesh.buffer->indexCount = static_cast<GLsizei>(mesh.indexData.size());
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.buffer->vbos[1]);
+    if (vertexCount <= 0x10000) {
+        std::vector<GLushort> shortIndices(mesh.indexData.begin(), mesh.indexData.end());
+        mesh.buffer->indexType = GL_UNSIGNED_SHORT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(GLushort), shortIndices.data(), GL_STATIC_DRAW);
+    }
+    else {
+        mesh.buffer->indexType = GL_UNSIGNED_INT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexData.size() * sizeof(GLuint), mesh.indexData.data(), GL_STATIC_DRAW);
+    }
 
-        // Send vertex coordinates to GPU
-        glVertexAttribPointer(0, FLOATS_PER_VERTEX, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    if (mesh.vertexFormat == VertexFormat::COMPACT) {
+        const GLint stride = sizeof(CompactVertex);
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (void*)offsetof(CompactVertex, position));
         glEnableVertexAttribArray(0);
 
-        glVertexAttribPointer(1, FLOATS_PER_NORMAL, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(GLfloat) * FLOATS_PER_VERTEX));
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(CompactVertex, normal));
         glEnableVertexAttribArray(1);
 
-        glVertexAttribPointer(2, FLOATS_PER_TEX_COORD, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(GLfloat) * (FLOATS_PER_NORMAL + FLOATS_PER_VERTEX)));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(CompactVertex, texCoord));
         glEnableVertexAttribArray(2);
+        return;
     }
+
+    // Stride of each vertex coordinate in array
+    GLint stride = sizeof(float) * (FLOATS_PER_VERTEX + FLOATS_PER_NORMAL + FLOATS_PER_TEX_COORD);
+
+    // Send vertex coordinates to GPU
+    glVertexAttribPointer(0, FLOATS_PER_VERTEX, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, FLOATS_PER_NORMAL, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(GLfloat) * FLOATS_PER_VERTEX));
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(2, FLOATS_PER_TEX_COORD, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(GLfloat) * (FLOATS_PER_NORMAL + FLOATS_PER_VERTEX)));
+    glEnableVertexAttribArray(2);
 }
 
-// Destroy mesh data and release resources
-void UGLProp::DestroyMeshVector() {
-    for (Mesh mesh : meshVector) {
-        glDeleteVertexArrays(1, &mesh.vao);
-        glDeleteBuffers(2, mesh.vbos);
+// Release the instance transform buffer
+InstanceBuffer::~InstanceBuffer() {
+    GLStateCache::Current().DeleteBuffers(1, &ssbo);
+}
+
+ProceduralMesh ProceduralMesh::Plane(const float length, const float width) {
+    ProceduralMesh mesh;
+    mesh.shape = ProceduralShape::PLANE;
+    mesh.parameters = glm::vec3(length, width, 0.0f);
+    return mesh;
+}
+
+ProceduralMesh ProceduralMesh::Cylinder(const float radius, const float height, const int segments) {
+    ProceduralMesh mesh;
+    mesh.shape = ProceduralShape::CYLINDER;
+    mesh.parameters = glm::vec3(radius, height, 0.0f);
+    mesh.segments = segments;
+    return mesh;
+}
+
+ProceduralMesh ProceduralMesh::Sphere(const float radius, const int divisions) {
+    ProceduralMesh mesh;
+    mesh.shape = ProceduralShape::SPHERE;
+    mesh.parameters = glm::vec3(radius, 0.0f, 0.0f);
+    mesh.segments = divisions;
+    return mesh;
+}
+
+ProceduralMesh ProceduralMesh::Torus(const float outerRadius, const float innerRadius, const int segments) {
+    ProceduralMesh mesh;
+    mesh.shape = ProceduralShape::TORUS;
+    mesh.parameters = glm::vec3(outerRadius, innerRadius, 0.0f);
+    mesh.segments = segments;
+    return mesh;
+}
+
+GLsizei ProceduralMesh::GetVertexCount() const {
+    return GetVertexCount(segments);
+}
+
+// Must match the vertex counts in shaders/procedural_shader.vs.
+GLsizei ProceduralMesh::GetVertexCount(const GLint segments) const {
+    switch (shape) {
+    case ProceduralShape::PLANE:
+        return 6;
+    case ProceduralShape::CYLINDER:
+        // Body quads plus a fan triangle per segment in each cap.
+        return 12 * segments;
+    case ProceduralShape::SPHERE:
+    case ProceduralShape::TORUS:
+        return 6 * segments * segments;
+    default:
+        return 0;
     }
 }
 
-// Render the object
-void UGLProp::Render(Camera t_camera, glm::mat4 t_projection, int num_lights) {
-    GLint activeShader;
-    glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&activeShader);
-    if (activeShader != shader->ID) {
-        shader->use();
+// Must match the patch grid in shaders/tessellation_shader.vs.
+GLsizei ProceduralMesh::GetPatchCount() const {
+    switch (shape) {
+    case ProceduralShape::PLANE:
+        return 1;
+    case ProceduralShape::CYLINDER:
+        // 4 around the body and each cap.
+        return 12;
+    case ProceduralShape::SPHERE:
+    case ProceduralShape::TORUS:
+        return 32;
+    default:
+        return 0;
     }
-    model = translation * rotation * scale;
-    glm::mat4 view = t_camera.GetViewMatrix();
-    glm::mat4 projection = t_projection;
-    SetShaderUniform(num_lights, "num_lights");
-    SetShaderUniform(t_camera.Position, "cameraPosition");
-    SetShaderUniform(model, "model");
-    SetShaderUniform(view, "view");
-    SetShaderUniform(projection, "projection");
-
-    Material currentMaterial;
-    int i = 0;
-    for (const RichWerks::Mesh& mesh : meshVector) {
-        glBindVertexArray(mesh.vao);
-        if (i < materialVector.size()) {
-            currentMaterial = materialVector[i];
-            SetShaderUniform(currentMaterial.shininess, "materialShininess");
-            SetShaderUniform(currentMaterial.emission, "materialEmission");
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, currentMaterial.texture);
-            i++;
+}
+
+// Check for tessellation shader support
+bool RichWerks::TessellationSupported() {
+    return GLEW_VERSION_4_0 || GLEW_ARB_tessellation_shader;
+}
+
+// Upload the instance transforms of a procedural mesh
+void RichWerks::UploadProceduralMesh(ProceduralMesh& mesh) {
+    if (mesh.instanceTransforms.empty()) {
+        return;
+    }
+    mesh.buffer = std::make_shared<InstanceBuffer>();
+    mesh.buffer->instanceCount = static_cast<GLsizei>(mesh.instanceTransforms.size());
+    std::vector<glm::mat4> instances;
+    instances.reserve(mesh.instanceTransforms.size() * 2);
+    for (const glm::mat4& transform : mesh.instanceTransforms) {
+        instances.push_back(transform);
+        instances.push_back(FrameUniforms::NormalMatrix(transform));
+    }
+    glGenBuffers(1, &mesh.buffer->ssbo);
+    GLStateCache::Current().BindBuffer(GL_SHADER_STORAGE_BUFFER, mesh.buffer->ssbo);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, instances.size() * sizeof(glm::mat4), instances.data(), GL_STATIC_DRAW);
+}
+
+namespace {
+    // Procedural draws read no attributes, but a core profile context still needs a VAO bound.
+    // Upload a mesh that has no buffer yet into its shared object, so every prop holding the
+    // mesh draws from the one buffer.
+    void bindShared(const std::shared_ptr<const Mesh>& t_mesh) {
+        if (!t_mesh->buffer) {
+            UploadMesh(*t_mesh);
+        }
+    }
+
+    GLuint emptyVertexArray() {
+        static GLuint vao = 0;
+        if (vao == 0) {
+            glGenVertexArrays(1, &vao);
+        }
+        return vao;
+    }
+}
+
+// Bind the mesh data. Meshes that already have a buffer (e.g. from a MeshCache) are shared as-is.
+void UGLProp::BindMesh() {
+    if (proceduralMesh.shape != ProceduralShape::NONE && !proceduralMesh.buffer) {
+        UploadProceduralMesh(proceduralMesh);
+    }
+    for (const std::shared_ptr<const Mesh>& mesh : meshVector) {
+        bindShared(mesh);
+    }
+    for (LODLevel& level : lodVector) {
+        for (const std::shared_ptr<const Mesh>& mesh : level.meshes) {
+            bindShared(mesh);
         }
-        glDrawElements(GL_TRIANGLES, mesh.indexData.size() * sizeof(GLshort), GL_UNSIGNED_SHORT, NULL);
+    }
+}
+
+// Release this prop's references to its meshes and their buffers
+void UGLProp::DestroyMeshVector() {
+    meshVector.clear();
+    lodVector.clear();
+    proceduralMesh.buffer.reset();
+}
+
+// Render the object
+void UGLProp::Render(FrameUniforms& t_frame) {
+    const FrameData& frame = t_frame.GetFrameData();
+    const GLint objectIndex = t_frame.AddObject(model, normalMatrix);
+    if (IsProcedural()) {
+        DrawMesh(nullptr, materialVector.empty() ? nullptr : &materialVector[0], objectIndex, frame);
+        return;
+    }
+    const std::vector<std::shared_ptr<const Mesh>>& meshes = SelectLOD(frame);
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        DrawMesh(meshes[i].get(), meshMaterial(i), objectIndex, frame);
+    }
+}
+
+// Queue the meshes Render would draw, to be drawn in sorted order by the queue
+void UGLProp::Submit(RenderQueue& t_queue, FrameUniforms& t_frame) {
+    RenderItem item;
+    item.prop = this;
+    item.objectIndex = t_frame.AddObject(model, normalMatrix);
+    if (IsProcedural()) {
+        item.material = materialVector.empty() ? nullptr : &materialVector[0];
+        t_queue.Submit(item);
+        return;
+    }
+    const std::vector<std::shared_ptr<const Mesh>>& meshes = SelectLOD(t_frame.GetFrameData());
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        item.mesh = meshes[i].get();
+        item.material = meshMaterial(i);
+        t_queue.Submit(item);
+    }
+}
+
+// Draw one mesh, or the procedural mesh, with the prop's ObjectBuffer entry
+void UGLProp::DrawMesh(const Mesh* t_mesh, const Material* t_material, GLint t_objectIndex, const FrameData& t_frame) {
+    // Consecutive draws with the same shader, textures or meshes only bind what changed.
+    GLStateCache& state = GLStateCache::Current();
+    state.UseProgram(shader->ID);
+    shader->set(uniforms.objectIndex, t_objectIndex);
+    if (t_material != nullptr) {
+        shader->set(uniforms.materialShininess, t_material->shininess);
+        shader->set(uniforms.materialEmission, t_material->emission);
+        state.BindTexture(0, GL_TEXTURE_2D, t_material->texture);
+    }
+    if (t_mesh == nullptr) {
+        RenderProcedural(t_frame);
+        return;
+    }
+
+    const Mesh& mesh = *t_mesh;
+    state.BindVertexArray(mesh.buffer->vao);
+    shader->set(uniforms.positionOffset, mesh.buffer->positionOffset);
+    shader->set(uniforms.positionScale, mesh.buffer->positionScale);
+    if (mesh.meshlets.empty()) {
+        glDrawElements(GL_TRIANGLES, mesh.buffer->indexCount, mesh.buffer->indexType, NULL);
+        return;
+    }
+    // Skip off-screen and back-facing meshlets and draw the rest as merged index ranges.
+    drawCounts.clear();
+    drawFirstIndices.clear();
+    std::cullMeshlets(mesh, model, t_frame.viewProjection, t_frame.cameraPosition, drawCounts, drawFirstIndices);
+    const size_t indexSize = mesh.buffer->indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    drawOffsets.resize(drawFirstIndices.size());
+    for (size_t range = 0; range < drawFirstIndices.size(); ++range) {
+        drawOffsets[range] = reinterpret_cast<const void*>(static_cast<uintptr_t>(drawFirstIndices[range]) * indexSize);
+    }
+    if (!drawCounts.empty()) {
+        glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), mesh.buffer->indexType, drawOffsets.data(), static_cast<GLsizei>(drawCounts.size()));
+    }
+}
+
+// Material of mesh i: material i, or the last one when there are fewer materials than meshes
+const Material* UGLProp::meshMaterial(size_t i) const {
+    if (materialVector.empty()) {
+        return nullptr;
+    }
+    return &materialVector[std::min(i, materialVector.size() - 1)];
+}
 
-        glBindVertexArray(0);
+// Pick the level of detail from the projected size of the bounding sphere
+const std::vector<std::shared_ptr<const Mesh>>& UGLProp::SelectLOD(const FrameData& t_frame) {
+    if (lodVector.empty()) {
+        return meshVector;
+    }
+    const GLfloat screenSize = std::projectedScreenSize(worldBounds.center, worldBounds.radius, t_frame.view, t_frame.projection);
+    currentLOD = std::selectLOD(lodVector, screenSize, currentLOD);
+    return currentLOD > 0 ? lodVector[currentLOD - 1].meshes : meshVector;
+}
+
+// Draw the procedural mesh: no vertex data, one instanced draw for every copy
+void UGLProp::RenderProcedural(const FrameData& t_frame) {
+    GLStateCache& state = GLStateCache::Current();
+    shader->set(uniforms.proceduralShape, static_cast<int>(proceduralMesh.shape));
+    shader->set(uniforms.proceduralParameters, proceduralMesh.parameters);
+
+    // The tessellation control shader picks its own levels; otherwise the segment count is fixed,
+    // or picked here from the projected size when tessellation was asked for but is unavailable.
+    GLint segments = proceduralMesh.segments;
+    if (tessellated) {
+        shader->set(uniforms.pixelsPerSegment, pixelsPerSegment);
+    }
+    else if (pixelsPerSegment > 0.0f && proceduralMesh.shape != ProceduralShape::PLANE) {
+        const GLfloat screenSize = std::projectedScreenSize(worldBounds.center, worldBounds.radius, t_frame.view, t_frame.projection);
+        segments = std::proceduralSegments(screenSize, static_cast<GLint>(t_frame.viewportSize.y), pixelsPerSegment, proceduralMesh.segments);
+    }
+    shader->set(uniforms.proceduralSegments, static_cast<int>(segments));
+
+    GLsizei instanceCount = 1;
+    const bool instanced = proceduralMesh.buffer != nullptr;
+    shader->set(uniforms.useInstanceTransforms, instanced);
+    if (instanced) {
+        state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, proceduralMesh.buffer->ssbo);
+        instanceCount = proceduralMesh.buffer->instanceCount;
+    }
+    state.BindVertexArray(emptyVertexArray());
+    if (tessellated) {
+        glPatchParameteri(GL_PATCH_VERTICES, 4);
+        glDrawArraysInstanced(GL_PATCHES, 0, 4 * proceduralMesh.GetPatchCount(), instanceCount);
+    }
+    else {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, proceduralMesh.GetVertexCount(segments), instanceCount);
     }
 }
 
 // Update the model matrix
 void UGLProp::updateModel() {
     model = translation * rotation * scale;
+    normalMatrix = FrameUniforms::NormalMatrix(model);
+    worldBounds = std::transformBounds(localBounds, model);
+}
+
+// Get the normal matrix matching the model matrix
+const glm::mat4& UGLProp::GetNormalMatrix() const {
+    return normalMatrix;
+}
+
+// Whether the prop draws a procedural mesh instead of its mesh vector
+bool UGLProp::IsProcedural() const {
+    return proceduralMesh.shape != ProceduralShape::NONE;
+}
+
+// Get the world-space bounds of the object
+const BoundingVolume& UGLProp::GetWorldBounds() const {
+    return worldBounds;
+}
+
+// Get the model matrix (translation * rotation * scale)
+const glm::mat4& UGLProp::GetModelMatrix() const {
+    return model;
+}
+
+// Get the full-detail meshes
+const std::vector<std::shared_ptr<const Mesh>>& UGLProp::GetMeshes() const {
+    return meshVector;
+}
+
+// Get the materials, one per mesh
+const std::vector<Material>& UGLProp::GetMaterials() const {
+    return materialVector;
+}
+
+// Get the attached shader
+Shader* UGLProp::GetShader() const {
+    return shader;
 }
 
 // Get the position of the object
@@ -265,13 +677,18 @@ glm::vec3 UGLProp::GetPosition() {
     return position;
 }
 
+// Get the level of detail drawn last frame (0 is full detail)
+int UGLProp::GetLOD() {
+    return currentLOD;
+}
+
 // Get the mesh at a specific index
-Mesh UGLProp::GetMesh(int idx) {
+const Mesh& UGLProp::GetMesh(int idx) {
     if (idx < meshVector.size()) {
-        return meshVector[idx];
+        return *meshVector[idx];
     }
     else {
-        return meshVector.back();
+        return *meshVector.back();
     }
 }
 
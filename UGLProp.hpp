@@ -1,18 +1,78 @@
 #include "UGLObject.hpp"
+#include "FrameUniforms.hpp"
 #include <learnOpengl/camera.h>
+#include <memory>
 
 #ifndef _UGLProp_
 #define _UGLProp_
 
 #pragma once
 namespace RichWerks {
+    class RenderQueue;
+
+    // GPU copy of a mesh. Owned through a shared_ptr so identical meshes can share one
+    // VAO/VBO pair; the GL objects are released when the last owner lets go.
+    struct MeshBuffer {
+        GLuint vao = 0;
+        GLuint vbos[2] = { 0, 0 };
+        GLenum indexType = GL_UNSIGNED_INT;   // GL_UNSIGNED_SHORT when every index fits in 16 bits
+        GLsizei indexCount = 0;
+        glm::vec3 positionOffset = glm::vec3(0.0f);  // Dequantization of compact positions:
+        glm::vec3 positionScale = glm::vec3(1.0f);   // position = offset + stored * scale
+
+        MeshBuffer() = default;
+        MeshBuffer(const MeshBuffer&) = delete;
+        MeshBuffer& operator=(const MeshBuffer&) = delete;
+        ~MeshBuffer();
+    };
+
+    // Layout a mesh is uploaded with.
+    // FLOAT32: 8 floats per vertex (32 bytes).
+    // COMPACT: 16-bit normalized positions relative to the mesh bounds, GL_INT_2_10_10_10_REV
+    //          normals and half-float texture coordinates (16 bytes).
+    enum struct VertexFormat : GLint { FLOAT32, COMPACT };
+
+    // One vertex in the COMPACT layout.
+    struct CompactVertex {
+        GLshort position[4];     // xyz as snorm16 in [-1, 1] over the bounds, w is padding
+        GLuint normal;           // xyz as snorm10, packed GL_INT_2_10_10_10_REV
+        GLushort texCoord[2];    // uv as half floats
+    };
+    static_assert(sizeof(CompactVertex) == 16, "CompactVertex must stay 16 bytes");
+
+    // Contiguous run of a mesh's triangles (at most 64 vertices / 124 triangles, see
+    // MeshletBuilder.hpp) with the bounds used to cull it before drawing.
+    struct Meshlet {
+        GLuint firstIndex = 0;                  // Offset into indexData
+        GLuint triangleCount = 0;
+        GLuint vertexCount = 0;                 // Distinct vertices referenced
+        glm::vec3 center = glm::vec3(0.0f);     // Bounding sphere, model space
+        GLfloat radius = 0.0f;
+        glm::vec3 coneAxis = glm::vec3(0.0f);   // Average vertex normal direction
+        GLfloat coneCutoff = 1.0f;              // Sine of the cone's half angle; 1 never culls
+    };
+
+    // Exact axis-aligned box and a bounding sphere of a set of positions. A negative radius
+    // marks an empty volume (no vertices yet).
+    struct BoundingVolume {
+        glm::vec3 boxMin = glm::vec3(0.0f);
+        glm::vec3 boxMax = glm::vec3(0.0f);
+        glm::vec3 center = glm::vec3(0.0f);
+        GLfloat radius = -1.0f;
+        bool IsEmpty() const {
+            return radius < 0.0f;
+        }
+    };
+
     struct Mesh {
         std::vector<GLfloat> vertexData;
-        std::vector<GLshort> indexData;
+        std::vector<GLuint> indexData;
         glm::vec3 position = glm::vec3(0.0f);
         glm::vec3 size;
-        GLuint vao;
-        GLuint vbos[2];
+        mutable std::shared_ptr<MeshBuffer> buffer;     // Set by UploadMesh, also on a mesh shared as const
+        VertexFormat vertexFormat = VertexFormat::FLOAT32;   // Layout UploadMesh sends to the GPU
+        std::vector<Meshlet> meshlets;          // Optional; when set, Render culls and draws per meshlet
+        BoundingVolume bounds;                  // Model space; kept current by the generators and transformMesh
         GLfloat getHeight() {
             return size.y;
         }
@@ -24,8 +84,71 @@ namespace RichWerks {
         }
     };
 
+    // Upload the vertex and index data of a mesh into a new MeshBuffer in its vertexFormat.
+    // Indices are stored on the GPU as 16-bit when the mesh has at most 65536 vertices and
+    // as 32-bit otherwise. Only the buffer is written, so meshes shared as const can be uploaded.
+    void UploadMesh(const Mesh& mesh);
+
+    // One coarser level of a prop. Levels are kept finest first, and each holds the same
+    // number of meshes as the full-detail level so materials still line up by index.
+    struct LODLevel {
+        std::vector<std::shared_ptr<const Mesh>> meshes;
+        GLfloat screenSize = 0.0f;     // Drawn once the prop covers less than this fraction of the viewport height
+    };
+
+    // Default margin around each LOD threshold, as a fraction of the threshold.
+    constexpr GLfloat LOD_HYSTERESIS = 0.15f;
+
+    // Parametric shapes shaders/procedural_shader.vs builds from gl_VertexID.
+    enum struct ProceduralShape : GLint { NONE, PLANE, CYLINDER, SPHERE, TORUS };
+
+    // GPU copy of a procedural mesh's instance transforms (a shader storage buffer at
+    // binding 1), shared like MeshBuffer.
+    struct InstanceBuffer {
+        GLuint ssbo = 0;
+        GLsizei instanceCount = 0;
+
+        InstanceBuffer() = default;
+        InstanceBuffer(const InstanceBuffer&) = delete;
+        InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+        ~InstanceBuffer();
+    };
+
+    // A plane, cylinder, sphere or torus drawn with glDrawArraysInstanced and no vertex or
+    // index buffer: the vertex shader rebuilds position, normal and UV from gl_VertexID, the
+    // generator arguments and the segment count, following the matching MeshGenerator layout.
+    // With instance transforms, one draw places a copy at each transform (times the prop's model).
+    struct ProceduralMesh {
+        ProceduralShape shape = ProceduralShape::NONE;
+        glm::vec3 parameters = glm::vec3(0.0f);     // Generator arguments in declaration order
+        GLint segments = 0;                         // Segment/division count (unused by PLANE)
+        std::vector<glm::mat4> instanceTransforms;  // Empty draws a single instance
+        std::shared_ptr<InstanceBuffer> buffer;
+        BoundingVolume bounds;                      // Model space, over every instance
+
+        static ProceduralMesh Plane(const float length, const float width);
+        static ProceduralMesh Cylinder(const float radius, const float height, const int segments);
+        static ProceduralMesh Sphere(const float radius, const int divisions);
+        static ProceduralMesh Torus(const float outerRadius, const float innerRadius, const int segments);
+
+        // Vertices glDrawArrays needs for one instance (non-indexed triangles), at the mesh's own
+        // segment count or at t_segments.
+        GLsizei GetVertexCount() const;
+        GLsizei GetVertexCount(const GLint t_segments) const;
+        // Coarse quad patches the tessellation path submits for one instance (4 vertices each).
+        GLsizei GetPatchCount() const;
+    };
+
+    // Whether the context can run tessellation shaders (OpenGL 4.0 or ARB_tessellation_shader).
+    bool TessellationSupported();
+
+    // Upload the instance transforms of a procedural mesh, if it has any, each followed by its
+    // normal matrix (the InstanceData layout of the procedural shaders).
+    void UploadProceduralMesh(ProceduralMesh& mesh);
+
     struct Material {
         int texture;
+        glm::ivec2 textureSize = glm::ivec2(0);     // Level 0 of texture, recorded when it is loaded
         int shininess = 0;
         glm::vec3 emission = glm::vec3(0.0f);
         GLfloat materialScatterG = 0.0f;
@@ -33,6 +156,25 @@ namespace RichWerks {
         glm::vec3 color;
     };
 
+    // Handles to the uniforms a prop sets on every draw, resolved when its shader is attached.
+    // The camera and the prop's matrices come from FrameUniforms instead. StaticBatch and
+    // Terrain resolve the same set for their shaders; handles a shader lacks stay invalid.
+    struct PropUniforms {
+        Shader::Uniform<int> objectIndex;
+        Shader::Uniform<glm::vec3> positionOffset;
+        Shader::Uniform<glm::vec3> positionScale;
+        Shader::Uniform<int> materialShininess;
+        Shader::Uniform<glm::vec3> materialEmission;
+        // Procedural and tessellation shaders only
+        Shader::Uniform<int> proceduralShape;
+        Shader::Uniform<glm::vec3> proceduralParameters;
+        Shader::Uniform<int> proceduralSegments;
+        Shader::Uniform<bool> useInstanceTransforms;
+        Shader::Uniform<float> pixelsPerSegment;
+
+        void Resolve(const Shader& t_shader);
+    };
+
     class UGLProp :
         public UGLObject
     {
@@ -50,11 +192,27 @@ namespace RichWerks {
         UGLProp& operator=(const UGLProp& prop);
         UGLProp& operator=(UGLProp&& prop) noexcept;
 
-        // Mesh operations
+        // Mesh operations. Meshes are held through shared pointers, so a mesh shared with other
+        // props (e.g. from a MeshCache) keeps one copy of its CPU data as well as of its buffer.
         void AddMesh(Mesh t_mesh);
+        void AddMesh(std::shared_ptr<const Mesh> t_mesh);
         void BindMesh();
-        std::vector<Mesh>& GetMeshVectorReference();
+        std::vector<std::shared_ptr<const Mesh>>& GetMeshVectorReference();
         void SetMaterial(Material t_material);
+        // Add a coarser copy of the meshes, drawn once the prop covers less than t_screenSize of
+        // the viewport height. Add levels finest first, with decreasing t_screenSize.
+        void AddLOD(std::vector<std::shared_ptr<const Mesh>> t_meshes, GLfloat t_screenSize);
+        // Add one LOD per ratio by simplifying the full-detail meshes to that fraction of their
+        // triangles (see MeshSimplifier.hpp), on the shared thread pool. Call before BindMesh.
+        void GenerateLODs(const std::vector<GLfloat>& t_triangleRatios, const std::vector<GLfloat>& t_screenSizes, GLfloat t_maxError = 0.05f);
+        // Draw a procedural mesh (see ProceduralMesh) instead of the mesh vector. Attach a shader
+        // built from shaders/procedural_shader.vs; the first material is used.
+        void SetProceduralMesh(ProceduralMesh t_mesh);
+        // Tessellate the procedural mesh on the GPU with t_tessellationShader (the shaders/tessellation_shader.*
+        // stages), splitting each patch edge so a segment covers about t_pixelsPerSegment pixels. Without
+        // tessellation support, or if that shader failed to link, the attached procedural shader stays in use
+        // and the segment count (at most the mesh's own) is picked on the CPU each frame by the same rule.
+        void EnableTessellation(Shader& t_tessellationShader, GLfloat t_pixelsPerSegment = 12.0f);
 
         // Shader operations
         void AttachShader(Shader& t_shader);
@@ -70,23 +228,54 @@ namespace RichWerks {
 
         // Information retrieval
         glm::vec3 GetPosition();
-        Mesh GetMesh(int idx);
+        const Mesh& GetMesh(int idx);
         int GetMeshCount();
+        int GetLOD();
+        // World-space bounds of the full-detail meshes under the current model matrix.
+        const BoundingVolume& GetWorldBounds() const;
+        const glm::mat4& GetModelMatrix() const;
+        const glm::mat4& GetNormalMatrix() const;
+        bool IsProcedural() const;
+        const std::vector<std::shared_ptr<const Mesh>>& GetMeshes() const;
+        const std::vector<Material>& GetMaterials() const;
+        Shader* GetShader() const;
 
-        // Rendering
-        void Render(Camera t_camera, glm::mat4 t_projection, int num_lights);
+        // Rendering. Call between t_frame.Begin and t_frame.End.
+        void Render(FrameUniforms& t_frame);
+        // Queue the meshes Render would draw instead of drawing them (see RenderQueue.hpp).
+        void Submit(RenderQueue& t_queue, FrameUniforms& t_frame);
+        // Draw one mesh of this frame's level (nullptr: the procedural mesh) with the prop's
+        // object entry. A null material leaves the material uniforms and texture as they are.
+        void DrawMesh(const Mesh* t_mesh, const Material* t_material, GLint t_objectIndex, const FrameData& t_frame);
+        // Meshes to draw this frame: the level of detail for the prop's projected size, kept
+        // until the size leaves the current level's band by more than LOD_HYSTERESIS.
+        const std::vector<std::shared_ptr<const Mesh>>& SelectLOD(const FrameData& t_frame);
 
     protected:
         // Utility functions
         void DestroyMeshVector();
+        void RenderProcedural(const FrameData& t_frame);
+        const Material* meshMaterial(size_t i) const;
         void Copy(const UGLProp& prop);
         void updateModel();
 
         // Data members
         std::vector<Material> materialVector;
-        std::vector<Mesh> meshVector;
+        std::vector<std::shared_ptr<const Mesh>> meshVector;
+        std::vector<LODLevel> lodVector;
+        ProceduralMesh proceduralMesh;
+        bool tessellated = false;           // Procedural mesh drawn as GL_PATCHES through the tessellation stages
+        GLfloat pixelsPerSegment = 0.0f;    // Screen-space segment target; 0 keeps the fixed segment count
+        BoundingVolume localBounds;     // Union of the mesh bounds, model space
+        BoundingVolume worldBounds;     // localBounds under model, refreshed by updateModel
+        int currentLOD = 0;             // Level drawn last frame: 0 is meshVector, i + 1 is lodVector[i]
+        std::vector<GLsizei> drawCounts;        // Scratch for the visible meshlet ranges of one mesh
+        std::vector<GLuint> drawFirstIndices;
+        std::vector<const void*> drawOffsets;
         Shader* shader;
+        PropUniforms uniforms;
         glm::mat4 model;
+        glm::mat4 normalMatrix = glm::mat4(1.0f);  // FrameUniforms::NormalMatrix(model), refreshed by updateModel
         glm::mat4 scale;
         glm::mat4 rotation;
         glm::mat4 translation;
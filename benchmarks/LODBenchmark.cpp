@@ -0,0 +1,93 @@
+/*
+ * File:          LODBenchmark.cpp
+ * Description:   Benchmark scene for discrete LOD selection. A 20x20 field of
+ *                30-segment candles (with the half and quarter detail levels main.cpp
+ *                uses) is viewed by a Camera that flies in from far away and then
+ *                drifts back and forth around a fixed distance. Reports the average
+ *                triangles submitted per frame with and without LODs, and how many
+ *                level switches (pops) happen with and without hysteresis. No OpenGL
+ *                context is needed.
+ *
+ *                g++ -std=c++17 -O2 -pthread -I../includes -I.. LODBenchmark.cpp ../MeshLOD.cpp ../MeshGenerator.cpp ../ThreadPool.cpp
+ */
+
+#include <iomanip>
+#include "MeshLOD.hpp"
+
+namespace {
+    const int GRID_SIZE = 20;
+    const float GRID_SPACING = 6.0f;
+    const int FRAMES = 2000;
+
+    struct Result {
+        double trianglesPerFrame = 0.0;
+        size_t switches = 0;
+    };
+
+    Result run(const std::vector<RichWerks::LODLevel>& levels, const std::vector<size_t>& triangles, const float boundingRadius, const float hysteresis) {
+        std::vector<int> current(GRID_SIZE * GRID_SIZE, 0);
+        const glm::mat4 projection = glm::perspective(glm::radians(ZOOM), 800.0f / 600.0f, 0.1f, 1000.0f);
+        Result result;
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            // Fly in over the first half, then sway +-2 units around the final distance.
+            const float t = static_cast<float>(frame) / FRAMES;
+            const float distance = t < 0.5f ? glm::mix(400.0f, 40.0f, t * 2.0f) : 40.0f + 2.0f * std::sin(frame * 0.2f);
+            Camera camera(glm::vec3(0.0f, 10.0f, distance));
+            const glm::mat4 view = camera.GetViewMatrix();
+
+            for (int z = 0; z < GRID_SIZE; ++z) {
+                for (int x = 0; x < GRID_SIZE; ++x) {
+                    const glm::vec3 center((x - GRID_SIZE / 2) * GRID_SPACING, 0.0f, -z * GRID_SPACING);
+                    int& level = current[z * GRID_SIZE + x];
+                    const int selected = std::selectLOD(levels, std::projectedScreenSize(center, boundingRadius, view, projection), level, hysteresis);
+                    if (frame > 0 && selected != level) {
+                        ++result.switches;
+                    }
+                    level = selected;
+                    result.trianglesPerFrame += triangles[level];
+                }
+            }
+        }
+        result.trianglesPerFrame /= FRAMES;
+        return result;
+    }
+}
+
+int main() {
+    const float detailScales[] = { 0.5f, 0.25f };
+    const float screenSizes[] = { 0.2f, 0.08f };
+
+    std::vector<RichWerks::Mesh> full = { std::generateCylinder(2.0f, 5.0f, 30) };
+    std::vector<size_t> triangles = { full[0].indexData.size() / 3 };
+    std::vector<RichWerks::LODLevel> levels;
+    for (size_t i = 0; i < 2; ++i) {
+        RichWerks::LODLevel level;
+        level.meshes.push_back(std::make_shared<const RichWerks::Mesh>(std::generateCylinder(2.0f, 5.0f, static_cast<int>(30 * detailScales[i]))));
+        level.screenSize = screenSizes[i];
+        triangles.push_back(level.meshes[0]->indexData.size() / 3);
+        levels.push_back(level);
+    }
+    const float boundingRadius = std::computeBoundingRadius(full);
+
+    const double fullDetail = static_cast<double>(triangles[0]) * GRID_SIZE * GRID_SIZE;
+    const Result noHysteresis = run(levels, triangles, boundingRadius, 0.0f);
+    const Result hysteresis = run(levels, triangles, boundingRadius, RichWerks::LOD_HYSTERESIS);
+
+    std::cout << GRID_SIZE * GRID_SIZE << " candles, " << FRAMES << " frames, triangles per level:";
+    for (const size_t count : triangles) {
+        std::cout << " " << count;
+    }
+    std::cout << std::endl << std::endl;
+    std::cout << std::left << std::setw(24) << "mode" << std::right << std::setw(16) << "tris/frame"
+        << std::setw(12) << "reduction" << std::setw(12) << "switches" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << std::left << std::setw(24) << "full detail" << std::right << std::setw(16) << fullDetail
+        << std::setw(12) << "1.00x" << std::setw(12) << 0 << std::endl;
+    const auto report = [&](const char* name, const Result& result) {
+        std::cout << std::left << std::setw(24) << name << std::right << std::setprecision(0) << std::setw(16) << result.trianglesPerFrame
+            << std::setprecision(2) << std::setw(11) << fullDetail / result.trianglesPerFrame << "x" << std::setw(12) << result.switches << std::endl;
+    };
+    report("LOD, no hysteresis", noHysteresis);
+    report("LOD, hysteresis 0.15", hysteresis);
+    return 0;
+}
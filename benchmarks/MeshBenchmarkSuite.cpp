@@ -0,0 +1,230 @@
+/*
+ * File:          MeshBenchmarkSuite.cpp
+ * Description:   Regression benchmark for MeshGenerator.cpp. Times every generator (the
+ *                Mesh-returning, span and thread pool versions), the transforms
+ *                (transformMesh, rotateMesh, translateMesh) and the bounds/packing helpers
+ *                across a sweep of segment counts, and prints one JSON document with
+ *                vertices/s, bytes/s and heap allocations per call for every case. Bytes
+ *                are the vertex and index bytes a call writes (a transform reads and writes
+ *                its vertices, so those count twice). No OpenGL context is needed.
+ *
+ *                Build with benchmarks/CMakeLists.txt, or:
+ *                g++ -std=c++17 -O2 -pthread -I../includes -I.. MeshBenchmarkSuite.cpp ../MeshGenerator.cpp ../ThreadPool.cpp
+ *                ./MeshBenchmarkSuite [seconds per case] > results.json
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <sstream>
+#include "MeshGenerator.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Every operator new in the process goes through the replacements below.
+    std::atomic<size_t> gAllocations{ 0 };
+
+    struct Result {
+        std::string name;
+        std::string variant;
+        int detail;
+        RichWerks::MeshCounts counts;
+        size_t bytesPerCall;
+        size_t calls;
+        double seconds;
+        size_t allocations;
+    };
+
+    // Run the callback until at least minSeconds have passed, counting the heap allocations
+    // made along the way.
+    Result measure(const std::string& name, const std::string& variant, const int detail, const RichWerks::MeshCounts counts,
+        const size_t bytesPerCall, const double minSeconds, const std::function<void()>& callback) {
+        callback();     // Warm up caches and the shared angle tables
+        Result result{ name, variant, detail, counts, bytesPerCall, 0, 0.0, 0 };
+        const size_t allocationsBefore = gAllocations.load(std::memory_order_relaxed);
+        const Clock::time_point start = Clock::now();
+        do {
+            callback();
+            ++result.calls;
+            result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (result.seconds < minSeconds);
+        result.allocations = gAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+        return result;
+    }
+
+    size_t meshBytes(const RichWerks::MeshCounts counts) {
+        return counts.vertexCount * RichWerks::FLOATS_PER_MESH_VERTEX * sizeof(GLfloat) + counts.indexCount * sizeof(GLuint);
+    }
+
+    size_t vertexBytes(const RichWerks::MeshCounts counts) {
+        return counts.vertexCount * RichWerks::FLOATS_PER_MESH_VERTEX * sizeof(GLfloat);
+    }
+
+    RichWerks::MeshCounts countsOf(const RichWerks::Mesh& mesh) {
+        return { mesh.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX, mesh.indexData.size() };
+    }
+
+    class Suite {
+    public:
+        explicit Suite(const double t_minSeconds) : minSeconds(t_minSeconds), pool(0) {}
+
+        // Time the Mesh-returning version, the span version into reused buffers and, when given,
+        // the thread pool version of one generator at one detail level.
+        void generator(const std::string& name, const int detail, const RichWerks::MeshCounts counts,
+            const std::function<RichWerks::Mesh()>& meshVersion,
+            const std::function<void(GLfloat*, GLuint*)>& spanVersion,
+            const std::function<RichWerks::Mesh(RichWerks::ThreadPool&)>& poolVersion = nullptr) {
+            volatile size_t sink = 0;
+            results.push_back(measure(name, "mesh", detail, counts, meshBytes(counts), minSeconds,
+                [&]() { sink += meshVersion().vertexData.size(); }));
+            if (spanVersion) {
+                std::vector<GLfloat> vertices(counts.vertexCount * RichWerks::FLOATS_PER_MESH_VERTEX);
+                std::vector<GLuint> indices(counts.indexCount);
+                results.push_back(measure(name, "span", detail, counts, meshBytes(counts), minSeconds,
+                    [&]() { spanVersion(vertices.data(), indices.data()); sink += indices.back(); }));
+            }
+            if (poolVersion) {
+                results.push_back(measure(name, "pool", detail, counts, meshBytes(counts), minSeconds,
+                    [&]() { sink += poolVersion(pool).vertexData.size(); }));
+            }
+        }
+
+        // Time an in-place operation on a copy of mesh. Each call works on the result of the
+        // last one, which is fine for timing since the data size never changes.
+        void inPlace(const std::string& name, const int detail, const RichWerks::Mesh& source, const size_t bytesPerCall,
+            const std::function<void(RichWerks::Mesh&)>& operation) {
+            RichWerks::Mesh mesh = source;
+            results.push_back(measure(name, "in-place", detail, countsOf(mesh), bytesPerCall, minSeconds,
+                [&]() { operation(mesh); }));
+        }
+
+        void write(std::ostream& out) const {
+            out << "{\n";
+            out << "  \"suite\": \"MeshGenerator\",\n";
+            out << "  \"compiler\": \"" << compilerName() << "\",\n";
+            out << "  \"threads\": " << pool.GetThreadCount() + 1 << ",\n";
+            out << "  \"min_seconds_per_case\": " << minSeconds << ",\n";
+            out << "  \"results\": [\n";
+            for (size_t i = 0; i < results.size(); ++i) {
+                const Result& result = results[i];
+                const double callsPerSecond = result.calls / result.seconds;
+                out << "    { \"name\": \"" << result.name << "\", \"variant\": \"" << result.variant << "\", \"detail\": " << result.detail
+                    << ", \"vertices\": " << result.counts.vertexCount << ", \"indices\": " << result.counts.indexCount
+                    << ", \"calls\": " << result.calls << ", \"ns_per_call\": " << result.seconds / result.calls * 1.0e9
+                    << ", \"vertices_per_second\": " << callsPerSecond * result.counts.vertexCount
+                    << ", \"bytes_per_second\": " << callsPerSecond * result.bytesPerCall
+                    << ", \"allocations_per_call\": " << static_cast<double>(result.allocations) / result.calls << " }"
+                    << (i + 1 < results.size() ? "," : "") << "\n";
+            }
+            out << "  ]\n";
+            out << "}\n";
+        }
+
+    private:
+        static std::string compilerName() {
+#if defined(__clang__)
+            return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+            return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+            return "msvc " + std::to_string(_MSC_VER);
+#else
+            return "unknown";
+#endif
+        }
+
+        double minSeconds;
+        RichWerks::ThreadPool pool;
+        std::vector<Result> results;
+    };
+}
+
+void* operator new(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size > 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+int main(int argc, char* argv[]) {
+    const double minSeconds = argc > 1 ? std::atof(argv[1]) : 0.2;
+    Suite suite(minSeconds);
+
+    suite.generator("cube", 0, std::countCube(),
+        []() { return std::generateCube(2.0f, 2.0f, 5.0f); },
+        [](GLfloat* v, GLuint* i) { std::generateCube(2.0f, 2.0f, 5.0f, v, i); });
+    suite.generator("plane", 0, std::countPlane(),
+        []() { return std::generatePlane(40.0f, 40.0f); },
+        [](GLfloat* v, GLuint* i) { std::generatePlane(40.0f, 40.0f, v, i); });
+    suite.generator("pyramid", 0, std::countPyramid(),
+        []() { return std::generatePyramid(4.0f, 5.0f); },
+        [](GLfloat* v, GLuint* i) { std::generatePyramid(4.0f, 5.0f, v, i); });
+
+    const int SEGMENT_SWEEP[] = { 8, 32, 128, 512 };
+    for (const int segments : SEGMENT_SWEEP) {
+        suite.generator("cylinder", segments, std::countCylinder(segments),
+            [=]() { return std::generateCylinder(2.0f, 5.0f, segments); },
+            [=](GLfloat* v, GLuint* i) { std::generateCylinder(2.0f, 5.0f, segments, v, i); });
+        suite.generator("cone", segments, std::countCone(segments),
+            [=]() { return std::generateCone(2.0f, 5.0f, segments); },
+            [=](GLfloat* v, GLuint* i) { std::generateCone(2.0f, 5.0f, segments, v, i); });
+        suite.generator("sphere", segments, std::countSphere(segments),
+            [=]() { return std::generateSphere(1.0f, segments); },
+            [=](GLfloat* v, GLuint* i) { std::generateSphere(1.0f, segments, v, i); },
+            [=](RichWerks::ThreadPool& pool) { return std::generateSphere(1.0f, segments, pool); });
+        suite.generator("torus", segments, std::countTorus(segments),
+            [=]() { return std::generateTorus(3.0f, 1.0f, segments); },
+            [=](GLfloat* v, GLuint* i) { std::generateTorus(3.0f, 1.0f, segments, v, i); },
+            [=](RichWerks::ThreadPool& pool) { return std::generateTorus(3.0f, 1.0f, segments, pool); });
+
+        // The lathe revolving the sphere profile (profile built outside the timing).
+        const std::vector<RichWerks::ProfilePoint> profile = std::sphereProfile(1.0f, segments);
+        suite.generator("lathe", segments, std::countLathe(profile, segments),
+            [=]() { return std::generateLathe(profile, segments); },
+            [=](GLfloat* v, GLuint* i) { std::generateLathe(profile, segments, v, i); });
+    }
+
+    // The icosphere has no span version; its detail is the subdivision level.
+    for (const int subdivisions : { 1, 3, 5, 7 }) {
+        const RichWerks::MeshCounts counts = countsOf(std::generateIcosphere(1.0f, subdivisions));
+        suite.generator("icosphere", subdivisions, counts,
+            [=]() { return std::generateIcosphere(1.0f, subdivisions); }, nullptr);
+    }
+
+    // Transforms and helpers on a sphere of each size.
+    for (const int segments : SEGMENT_SWEEP) {
+        const RichWerks::Mesh sphere = std::generateSphere(1.0f, segments);
+        const RichWerks::MeshCounts counts = countsOf(sphere);
+        const size_t vertexCount = counts.vertexCount;
+        const glm::mat4 composed = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 12.0f, 0.0f)) * glm::rotate(glm::mat4(1.0f), 0.01f, glm::vec3(1.0f, 0.0f, 0.0f));
+        suite.inPlace("transformMesh", segments, sphere, 2 * vertexBytes(counts),
+            [&](RichWerks::Mesh& mesh) { std::transformMesh(mesh, composed); });
+        suite.inPlace("rotateMesh", segments, sphere, 2 * vertexBytes(counts),
+            [](RichWerks::Mesh& mesh) { std::rotateMesh(mesh, 0.01f, glm::vec3(0.0f, 1.0f, 0.0f)); });
+        suite.inPlace("translateMesh", segments, sphere, 2 * vertexBytes(counts),
+            [](RichWerks::Mesh& mesh) { std::translateMesh(mesh, glm::vec3(0.0f, 0.001f, 0.0f)); });
+        suite.inPlace("computeMeshBounds", segments, sphere, vertexBytes(counts),
+            [](RichWerks::Mesh& mesh) { std::computeMeshBounds(mesh); });
+
+        std::vector<RichWerks::CompactVertex> compact(vertexCount);
+        suite.inPlace("packCompactVertices", segments, sphere, vertexBytes(counts) + vertexCount * sizeof(RichWerks::CompactVertex),
+            [&](RichWerks::Mesh& mesh) { std::packCompactVertices(mesh.vertexData.data(), vertexCount, glm::vec3(-1.0f), glm::vec3(1.0f), compact.data()); });
+    }
+
+    std::ostringstream json;
+    suite.write(json);
+    std::cout << json.str();
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * File:          ParallelGeneratorBenchmark.cpp
+ * Description:   Thread scaling of sphere and torus generation on multi-million-vertex
+ *                meshes. Each thread count writes into the same pre-sized buffers; one
+ *                thread is the plain span generator, N threads uses a ThreadPool with
+ *                N - 1 workers (the calling thread takes part). Also checks that every
+ *                parallel result is identical to the single-threaded one. A second table
+ *                sweeps the mesh size with every thread, showing where the pool starts
+ *                to pay off; smaller meshes are written on the calling thread. No OpenGL
+ *                context is needed.
+ *
+ *                g++ -std=c++17 -O2 -pthread -I../includes -I.. ParallelGeneratorBenchmark.cpp ../MeshGenerator.cpp ../ThreadPool.cpp
+ *                ./a.out [max threads]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include "MeshGenerator.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const int DIVISIONS = 2000;   // About 4 million vertices and 24 million indices per mesh
+    const int REPEATS = 3;
+    const int SWEEP_DIVISIONS[] = { 8, 16, 32, 64, 128, 256, 512, 1024 };
+    const double SWEEP_SECONDS = 0.2;   // Minimum time per size, so small meshes repeat many times
+
+    // Best of REPEATS runs, in seconds.
+    double bestSeconds(const std::function<void()>& callback) {
+        double best = 0.0;
+        for (int i = 0; i < REPEATS; ++i) {
+            const Clock::time_point start = Clock::now();
+            callback();
+            const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            best = (i == 0 || elapsed < best) ? elapsed : best;
+        }
+        return best;
+    }
+
+    // Average seconds per call over at least SWEEP_SECONDS.
+    double averageSeconds(const std::function<void()>& callback) {
+        const Clock::time_point start = Clock::now();
+        long calls = 0;
+        double elapsed = 0.0;
+        do {
+            callback();
+            ++calls;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (elapsed < SWEEP_SECONDS);
+        return elapsed / calls;
+    }
+
+    // Single-threaded and pool time of one generator at every sweep size.
+    void sweep(const char* name, RichWerks::ThreadPool& pool, const std::function<RichWerks::MeshCounts(int)>& count,
+        const std::function<void(int, GLfloat*, GLuint*, RichWerks::ThreadPool*)>& generate) {
+        for (const int divisions : SWEEP_DIVISIONS) {
+            const RichWerks::MeshCounts counts = count(divisions);
+            std::vector<GLfloat> vertices(counts.vertexCount * RichWerks::FLOATS_PER_MESH_VERTEX);
+            std::vector<GLuint> indices(counts.indexCount);
+            const double serial = averageSeconds([&]() { generate(divisions, vertices.data(), indices.data(), nullptr); });
+            const double parallel = averageSeconds([&]() { generate(divisions, vertices.data(), indices.data(), &pool); });
+            std::cout << std::left << std::setw(10) << name << std::right << std::setw(10) << divisions
+                << std::setw(12) << counts.vertexCount << std::fixed << std::setprecision(1)
+                << std::setw(12) << serial * 1.0e6 << std::setw(12) << parallel * 1.0e6
+                << std::setprecision(2) << std::setw(10) << serial / parallel << "x" << std::endl;
+        }
+    }
+
+    void report(const char* name, const RichWerks::MeshCounts counts, const unsigned int maxThreads,
+        const std::function<void(GLfloat*, GLuint*, RichWerks::ThreadPool*)>& generate) {
+        std::vector<GLfloat> vertices(counts.vertexCount * RichWerks::FLOATS_PER_MESH_VERTEX);
+        std::vector<GLuint> indices(counts.indexCount);
+        generate(vertices.data(), indices.data(), nullptr);
+        const std::vector<GLfloat> referenceVertices = vertices;
+        const std::vector<GLuint> referenceIndices = indices;
+
+        double singleThreaded = 0.0;
+        for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+            double seconds;
+            if (threads == 1) {
+                seconds = bestSeconds([&]() { generate(vertices.data(), indices.data(), nullptr); });
+                singleThreaded = seconds;
+            }
+            else {
+                RichWerks::ThreadPool pool(threads - 1);
+                seconds = bestSeconds([&]() { generate(vertices.data(), indices.data(), &pool); });
+            }
+            const bool identical = vertices == referenceVertices && indices == referenceIndices;
+            std::cout << std::left << std::setw(10) << name << std::right << std::setw(8) << threads
+                << std::fixed << std::setprecision(1) << std::setw(12) << seconds * 1000.0
+                << std::setw(12) << counts.vertexCount / seconds / 1.0e6
+                << std::setprecision(2) << std::setw(10) << singleThreaded / seconds << "x"
+                << std::setw(12) << (identical ? "yes" : "NO") << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned int maxThreads = argc > 1 ? static_cast<unsigned int>(std::atoi(argv[1]))
+        : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << std::left << std::setw(10) << "mesh" << std::right << std::setw(8) << "threads"
+        << std::setw(12) << "ms" << std::setw(12) << "Mvert/s" << std::setw(11) << "speedup" << std::setw(12) << "identical" << std::endl;
+
+    report("sphere", std::countSphere(DIVISIONS), maxThreads, [](GLfloat* vertices, GLuint* indices, RichWerks::ThreadPool* pool) {
+        if (pool) {
+            std::generateSphere(1.0f, DIVISIONS, vertices, indices, 0, *pool);
+        }
+        else {
+            std::generateSphere(1.0f, DIVISIONS, vertices, indices);
+        }
+    });
+    report("torus", std::countTorus(DIVISIONS), maxThreads, [](GLfloat* vertices, GLuint* indices, RichWerks::ThreadPool* pool) {
+        if (pool) {
+            std::generateTorus(3.0f, 1.0f, DIVISIONS, vertices, indices, 0, *pool);
+        }
+        else {
+            std::generateTorus(3.0f, 1.0f, DIVISIONS, vertices, indices);
+        }
+    });
+
+    RichWerks::ThreadPool pool(std::max(1u, maxThreads - 1));
+    std::cout << "\n" << std::left << std::setw(10) << "mesh" << std::right << std::setw(10) << "divisions"
+        << std::setw(12) << "vertices" << std::setw(12) << "serial us" << std::setw(12) << "pool us"
+        << std::setw(11) << "speedup" << "   (" << pool.GetThreadCount() + 1 << " threads)" << std::endl;
+    sweep("sphere", pool, [](int divisions) { return std::countSphere(divisions); },
+        [](int divisions, GLfloat* vertices, GLuint* indices, RichWerks::ThreadPool* pool) {
+            if (pool) {
+                std::generateSphere(1.0f, divisions, vertices, indices, 0, *pool);
+            }
+            else {
+                std::generateSphere(1.0f, divisions, vertices, indices);
+            }
+        });
+    sweep("torus", pool, [](int divisions) { return std::countTorus(divisions); },
+        [](int divisions, GLfloat* vertices, GLuint* indices, RichWerks::ThreadPool* pool) {
+            if (pool) {
+                std::generateTorus(3.0f, 1.0f, divisions, vertices, indices, 0, *pool);
+            }
+            else {
+                std::generateTorus(3.0f, 1.0f, divisions, vertices, indices);
+            }
+        });
+    return 0;
+}
@@ -0,0 +1,277 @@
+/*
+ * File:          RenderQueueBenchmark.cpp
+ * Description:   State changes and fragment work of drawing many props in the order they
+ *                were created versus through RenderQueue. The scene is a field of props in
+ *                front of the camera, created in random order, each one of five meshes with
+ *                one of two phong shaders and one of eight textures. Per frame it reports
+ *                the CPU time to submit, sort and issue the draws, the GL calls GLStateCache
+ *                passed on, the uniform uploads the Shader filter let through, the samples
+ *                that passed the depth test (GL_SAMPLES_PASSED: every one is a shaded
+ *                fragment that was later covered or kept, so fewer means less overdraw) and
+ *                the GPU time, on an offscreen 1280x720 target. The queue runs with one depth
+ *                bucket (state order only) and with 8 and 16 (front to back first). The radix
+ *                sort is also timed against std::stable_sort on the same keys.
+ *
+ *                Needs GLFW and GLEW; benchmarks/CMakeLists.txt builds it when it finds them.
+ *                ./RenderQueueBenchmark [props] [frames]
+ */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define __OPEN_GL_LIBRARY__        // GLEW is loaded; keep shader.h from including glad
+#include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include "GLStateCache.hpp"
+#include "MeshGenerator.hpp"
+#include "RenderQueue.hpp"
+
+#ifndef SHADER_DIR
+#define SHADER_DIR "../shaders/"
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using namespace RichWerks;
+
+    const int TARGET_WIDTH = 1280;
+    const int TARGET_HEIGHT = 720;
+
+    struct Result {
+        double cpuMilliseconds = 0.0;
+        double gpuMilliseconds = 0.0;
+        double stateChanges = 0.0;     // Issued by GLStateCache
+        double uniformUploads = 0.0;
+        double samplesPassed = 0.0;
+        double draws = 0.0;
+    };
+
+    // A 2x2 texture of one color
+    GLuint makeTexture(const glm::vec3 color) {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        GLStateCache::Current().BindTexture(0, GL_TEXTURE_2D, texture);
+        std::vector<GLubyte> pixels;
+        for (int i = 0; i < 4; ++i) {
+            pixels.insert(pixels.end(), { GLubyte(color.r * 255), GLubyte(color.g * 255), GLubyte(color.b * 255), 255 });
+        }
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        return texture;
+    }
+
+    // t_draw issues one frame's props; everything around it is the same for every case.
+    template <class F>
+    Result run(const std::vector<const Shader*>& shaders, FrameUniforms& frameUniforms, const Camera& camera,
+        const glm::mat4& projection, const int frames, F draw) {
+        GLStateCache& state = GLStateCache::Current();
+        GLuint queries[2];
+        glGenQueries(2, queries);
+        Result result;
+        const int warmup = 3;
+        for (int f = 0; f < warmup + frames; ++f) {
+            size_t uploadsBefore = 0;
+            for (const Shader* shader : shaders) {
+                uploadsBefore += shader->getUploadCount();
+            }
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glFinish();
+            state.EndFrame();
+
+            glBeginQuery(GL_SAMPLES_PASSED, queries[0]);
+            glBeginQuery(GL_TIME_ELAPSED, queries[1]);
+            const Clock::time_point start = Clock::now();
+            frameUniforms.Begin(camera, projection, 1, state.GetViewport());
+            const size_t draws = draw();
+            frameUniforms.End();
+            const double cpu = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            glEndQuery(GL_TIME_ELAPSED);
+            glEndQuery(GL_SAMPLES_PASSED);
+            state.EndFrame();
+
+            GLuint64 samples = 0;
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &samples);
+            glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &nanoseconds);
+            size_t uploads = 0;
+            for (const Shader* shader : shaders) {
+                uploads += shader->getUploadCount();
+            }
+            if (f < warmup) {
+                continue;
+            }
+            result.cpuMilliseconds += cpu / frames;
+            result.gpuMilliseconds += nanoseconds * 1.0e-6 / frames;
+            result.stateChanges += static_cast<double>(state.GetFrameCounters().Total().issued) / frames;
+            result.uniformUploads += static_cast<double>(uploads - uploadsBefore) / frames;
+            result.samplesPassed += static_cast<double>(samples) / frames;
+            result.draws += static_cast<double>(draws) / frames;
+        }
+        glDeleteQueries(2, queries);
+        return result;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int propCount = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const int frames = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "RenderQueueBenchmark", NULL, NULL);
+    if (window == NULL) {
+        std::cout << "Failed to create an OpenGL 4.4 context" << std::endl;
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        std::cout << "Failed to initialize GLEW" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Offscreen target, so the fragment load does not depend on the hidden window's size.
+    GLuint framebuffer, renderbuffers[2];
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glGenRenderbuffers(2, renderbuffers);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, TARGET_WIDTH, TARGET_HEIGHT);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, TARGET_WIDTH, TARGET_HEIGHT);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+    GLStateCache& state = GLStateCache::Current();
+    state.Viewport(0, 0, TARGET_WIDTH, TARGET_HEIGHT);
+    state.Enable(GL_DEPTH_TEST);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    Light light{};
+    light.color = glm::vec3(1.0f);
+    light.position = glm::vec3(0.0f, 20.0f, 0.0f);
+    light.type = LightingType::POINT_LIGHT;
+    light.ambientIntensity = 0.2f;
+    light.specularIntensity = 0.5f;
+    light.strength = 10.0f;
+    light.lightConstant = 1.0f;
+    light.lightLinear = 0.01f;
+    GLuint lightBuffer;
+    glGenBuffers(1, &lightBuffer);
+    state.BindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(light), &light, GL_STATIC_DRAW);
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightBuffer);
+
+    Shader phong(SHADER_DIR "phong_shader.vs", SHADER_DIR "phong_shader2.fs");
+    Shader phongAlternate(SHADER_DIR "phong_shader.vs", SHADER_DIR "phong_shader.fs");
+    if (!phong.success || !phongAlternate.success) {
+        return EXIT_FAILURE;
+    }
+    const std::vector<const Shader*> shaders = { &phong, &phongAlternate };
+
+    // Five meshes, uploaded once and shared by every prop that uses them.
+    std::vector<std::shared_ptr<const Mesh>> meshes;
+    for (Mesh mesh : { std::generateCube(1.5f, 1.5f, 1.5f), std::generateCylinder(0.7f, 2.0f, 24), std::generateSphere(1.0f, 24),
+        std::generatePyramid(1.5f, 2.0f), std::generateTorus(1.0f, 0.35f, 24) }) {
+        UploadMesh(mesh);
+        meshes.push_back(std::make_shared<const Mesh>(std::move(mesh)));
+    }
+    std::vector<GLuint> textures;
+    for (int i = 0; i < 8; ++i) {
+        textures.push_back(makeTexture(glm::vec3((i & 1) ? 0.9f : 0.3f, (i & 2) ? 0.9f : 0.3f, (i & 4) ? 0.9f : 0.3f)));
+    }
+
+    // A field of props from 5 to 95 units in front of the camera, created in random order.
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> across(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> ahead(5.0f, 95.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::vector<UGLProp> props(propCount);
+    for (int i = 0; i < propCount; ++i) {
+        UGLProp& prop = props[i];
+        Material material{};
+        material.texture = static_cast<int>(textures[random() % textures.size()]);
+        material.shininess = 1 << (random() % 6);
+        prop.SetMaterial(material);
+        prop.AttachShader(random() % 2 ? phong : phongAlternate);
+        prop.AddMesh(meshes[random() % meshes.size()]);
+        const float distance = ahead(random);
+        prop.Translate(glm::vec3(across(random) * distance / 95.0f, 0.0f, -distance));
+        prop.Rotate(angle(random), glm::vec3(0.0f, 1.0f, 0.0f));
+        prop.Scale(glm::vec3(1.0f + distance / 30.0f));
+    }
+
+    Camera camera(glm::vec3(0.0f, 2.0f, 0.0f));
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), float(TARGET_WIDTH) / TARGET_HEIGHT, 0.1f, 100.0f);
+    FrameUniforms frameUniforms(static_cast<GLuint>(propCount));
+
+    struct Case {
+        const char* name;
+        Result result;
+    };
+    std::vector<Case> cases;
+    cases.push_back({ "creation order", run(shaders, frameUniforms, camera, projection, frames, [&]() {
+        for (UGLProp& prop : props) {
+            prop.Render(frameUniforms);
+        }
+        return props.size(); }) });
+    for (const GLuint buckets : { 1u, 8u, 16u }) {
+        RenderQueue queue(buckets);
+        const char* name = buckets == 1 ? "queue, state only" : buckets == 8 ? "queue, 8 buckets" : "queue, 16 buckets";
+        cases.push_back({ name, run(shaders, frameUniforms, camera, projection, frames, [&]() {
+            queue.Begin(frameUniforms.GetFrameData());
+            for (UGLProp& prop : props) {
+                prop.Submit(queue, frameUniforms);
+            }
+            queue.Execute(frameUniforms.GetFrameData());
+            return static_cast<size_t>(queue.GetItemCount()); }) });
+    }
+
+    std::cout << propCount << " props, " << frames << " frames, " << TARGET_WIDTH << "x" << TARGET_HEIGHT << ", "
+        << glGetString(GL_RENDERER) << std::endl << std::endl;
+    std::cout << std::left << std::setw(20) << "order" << std::right << std::setw(10) << "cpu ms" << std::setw(10) << "gpu ms"
+        << std::setw(14) << "state calls" << std::setw(10) << "uploads" << std::setw(16) << "samples" << std::setw(12) << "vs first" << std::endl;
+    for (const Case& entry : cases) {
+        std::cout << std::left << std::setw(20) << entry.name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(10) << entry.result.cpuMilliseconds << std::setw(10) << entry.result.gpuMilliseconds
+            << std::setprecision(0) << std::setw(14) << entry.result.stateChanges << std::setw(10) << entry.result.uniformUploads
+            << std::setw(16) << entry.result.samplesPassed
+            << std::setprecision(1) << std::setw(11) << 100.0 * entry.result.samplesPassed / cases[0].result.samplesPassed << "%" << std::endl;
+    }
+
+    // The sort alone, on keys spread like a large scene's.
+    const size_t keyCount = 1 << 18;
+    RenderQueue keyMaker(8);
+    std::vector<std::pair<uint64_t, GLuint>> keys(keyCount);
+    for (size_t i = 0; i < keyCount; ++i) {
+        keys[i] = { keyMaker.MakeKey(RenderPass::SOLID, 1 + random() % 16, 1 + random() % 256, 1 + random() % 512, ahead(random)), static_cast<GLuint>(i) };
+    }
+    std::vector<std::pair<uint64_t, GLuint>> radixKeys = keys;
+    std::vector<std::pair<uint64_t, GLuint>> scratch;
+    Clock::time_point start = Clock::now();
+    RenderQueue::RadixSort(radixKeys, scratch);
+    const double radixMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::vector<std::pair<uint64_t, GLuint>> comparisonKeys = keys;
+    start = Clock::now();
+    std::stable_sort(comparisonKeys.begin(), comparisonKeys.end(),
+        [](const std::pair<uint64_t, GLuint>& a, const std::pair<uint64_t, GLuint>& b) { return a.first < b.first; });
+    const double comparisonMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << std::endl << keyCount << " keys: radix sort " << std::setprecision(2) << radixMilliseconds << " ms, std::stable_sort "
+        << comparisonMilliseconds << " ms" << (radixKeys == comparisonKeys ? "" : " (ORDER DIFFERS)") << std::endl;
+
+    props.clear();
+    meshes.clear();
+    glDeleteProgram(phong.ID);
+    glDeleteProgram(phongAlternate.ID);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * File:          SphereErrorBenchmark.cpp
+ * Description:   Triangles against geometric error for generateSphere (UV sphere) and
+ *                generateIcosphere. The error of a mesh is how far its surface sinks
+ *                inside the true sphere at the worst point, as a fraction of the
+ *                radius; this is what shows up on the silhouette. For every icosphere
+ *                level the UV sphere is searched for the fewest divisions that reach
+ *                the same error, and both triangle counts are reported. No OpenGL
+ *                context is needed.
+ *
+ *                g++ -std=c++17 -O2 -pthread -I../includes -I.. SphereErrorBenchmark.cpp ../MeshGenerator.cpp ../ThreadPool.cpp
+ */
+
+#include <iomanip>
+#include "MeshGenerator.hpp"
+
+namespace {
+    const float RADIUS = 1.0f;
+    const int MAX_SUBDIVISIONS = 6;
+
+    // Closest point to p on triangle abc (Ericson, Real-Time Collision Detection 5.1.5).
+    glm::vec3 closestPointOnTriangle(const glm::vec3 p, const glm::vec3 a, const glm::vec3 b, const glm::vec3 c) {
+        const glm::vec3 ab = b - a;
+        const glm::vec3 ac = c - a;
+        const glm::vec3 ap = p - a;
+        const float d1 = glm::dot(ab, ap);
+        const float d2 = glm::dot(ac, ap);
+        if (d1 <= 0.0f && d2 <= 0.0f) {
+            return a;
+        }
+        const glm::vec3 bp = p - b;
+        const float d3 = glm::dot(ab, bp);
+        const float d4 = glm::dot(ac, bp);
+        if (d3 >= 0.0f && d4 <= d3) {
+            return b;
+        }
+        const float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+            return a + ab * (d1 / (d1 - d3));
+        }
+        const glm::vec3 cp = p - c;
+        const float d5 = glm::dot(ab, cp);
+        const float d6 = glm::dot(ac, cp);
+        if (d6 >= 0.0f && d5 <= d6) {
+            return c;
+        }
+        const float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+            return a + ac * (d2 / (d2 - d6));
+        }
+        const float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+        const float denominator = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denominator) + ac * (vc * denominator);
+    }
+
+    // Deepest point of the surface below the sphere, relative to the radius. The vertices sit
+    // on the sphere, so the worst point is the one closest to the center.
+    double maxError(const RichWerks::Mesh& mesh) {
+        const GLfloat* vertices = mesh.vertexData.data();
+        const auto positionAt = [vertices](const GLuint i) {
+            const GLfloat* vertex = vertices + static_cast<size_t>(i) * RichWerks::FLOATS_PER_MESH_VERTEX;
+            return glm::vec3(vertex[0], vertex[1], vertex[2]);
+        };
+        double nearest = RADIUS;
+        for (size_t i = 0; i + 2 < mesh.indexData.size(); i += 3) {
+            const glm::vec3 a = positionAt(mesh.indexData[i]);
+            const glm::vec3 b = positionAt(mesh.indexData[i + 1]);
+            const glm::vec3 c = positionAt(mesh.indexData[i + 2]);
+            nearest = std::min(nearest, static_cast<double>(glm::length(closestPointOnTriangle(glm::vec3(0.0f), a, b, c))));
+        }
+        return (RADIUS - nearest) / RADIUS;
+    }
+
+    // Non-degenerate triangles only: the UV sphere writes zero-area triangles at its poles.
+    size_t triangleCount(const RichWerks::Mesh& mesh) {
+        size_t count = 0;
+        for (size_t i = 0; i + 2 < mesh.indexData.size(); i += 3) {
+            const GLfloat* a = &mesh.vertexData[mesh.indexData[i] * RichWerks::FLOATS_PER_MESH_VERTEX];
+            const GLfloat* b = &mesh.vertexData[mesh.indexData[i + 1] * RichWerks::FLOATS_PER_MESH_VERTEX];
+            const GLfloat* c = &mesh.vertexData[mesh.indexData[i + 2] * RichWerks::FLOATS_PER_MESH_VERTEX];
+            const glm::vec3 normal = glm::cross(glm::vec3(b[0], b[1], b[2]) - glm::vec3(a[0], a[1], a[2]), glm::vec3(c[0], c[1], c[2]) - glm::vec3(a[0], a[1], a[2]));
+            count += glm::dot(normal, normal) > 0.0f ? 1 : 0;
+        }
+        return count;
+    }
+
+    // Fewest UV sphere divisions whose error is at most target. The error falls as the
+    // divisions grow, so a binary search is enough.
+    int uvDivisionsFor(const double target) {
+        int low = 3;
+        int high = 4;
+        while (maxError(std::generateSphere(RADIUS, high)) > target) {
+            low = high;
+            high *= 2;
+        }
+        while (low < high) {
+            const int middle = (low + high) / 2;
+            if (maxError(std::generateSphere(RADIUS, middle)) > target) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+}
+
+int main() {
+    std::cout << std::left << std::setw(8) << "level" << std::right << std::setw(12) << "max error"
+        << std::setw(12) << "ico tris" << std::setw(12) << "ico verts" << std::setw(12) << "uv div"
+        << std::setw(12) << "uv tris" << std::setw(12) << "uv verts" << std::setw(12) << "uv/ico" << std::endl;
+
+    for (int level = 0; level <= MAX_SUBDIVISIONS; ++level) {
+        const RichWerks::Mesh icosphere = std::generateIcosphere(RADIUS, level);
+        const double error = maxError(icosphere);
+        const int divisions = uvDivisionsFor(error);
+        const RichWerks::Mesh sphere = std::generateSphere(RADIUS, divisions);
+
+        const size_t icoTriangles = triangleCount(icosphere);
+        const size_t uvTriangles = triangleCount(sphere);
+        std::cout << std::left << std::setw(8) << level << std::right << std::scientific << std::setprecision(2) << std::setw(12) << error
+            << std::setw(12) << icoTriangles << std::setw(12) << icosphere.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX
+            << std::setw(12) << divisions << std::setw(12) << uvTriangles << std::setw(12) << sphere.vertexData.size() / RichWerks::FLOATS_PER_MESH_VERTEX
+            << std::fixed << std::setw(11) << static_cast<double>(uvTriangles) / icoTriangles << "x" << std::endl;
+    }
+    return 0;
+}
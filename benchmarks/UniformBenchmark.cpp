@@ -0,0 +1,265 @@
+/*
+ * File:          UniformBenchmark.cpp
+ * Description:   CPU cost of the per-draw uniform uploads UGLProp::Render makes, for
+ *                thousands of props sharing the phong shader. Compares the old path
+ *                (a std::string and a glGetUniformLocation per call), the reflected
+ *                by-name setters, typed handles with the redundant-upload filter
+ *                defeated, and typed handles as UGLProp now uses them. Props share the
+ *                view, projection and camera, and pick from a few materials, so most of
+ *                what the filter skips is what a real scene repeats. Those four run on
+ *                benchmarks/shaders/, the phong shader from before FrameUniforms. The last
+ *                case is the current path: the camera written once per frame, and per prop
+ *                only its matrices into the object buffer plus objectIndex and the material.
+ *                Only uniforms and buffer writes are timed (no draws), on a hidden window's
+ *                context.
+ *
+ *                Needs GLFW and GLEW; benchmarks/CMakeLists.txt builds it when it finds them.
+ *                ./UniformBenchmark [props] [frames]
+ */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define __OPEN_GL_LIBRARY__        // GLEW is loaded; keep shader.h from including glad
+#include <glm/gtx/transform.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "shader.h"
+#include "FrameUniforms.hpp"
+
+#ifndef SHADER_DIR
+#define SHADER_DIR "../shaders/"
+#endif
+#ifndef BENCHMARK_SHADER_DIR
+#define BENCHMARK_SHADER_DIR "shaders/"
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct PropState {
+        glm::mat4 model;
+        glm::mat4 normalMatrix;
+        int shininess;
+        glm::vec3 emission;
+    };
+
+    struct Handles {
+        Shader::Uniform<int> numLights;
+        Shader::Uniform<glm::vec3> cameraPosition;
+        Shader::Uniform<glm::mat4> model;
+        Shader::Uniform<glm::mat4> view;
+        Shader::Uniform<glm::mat4> projection;
+        Shader::Uniform<glm::vec3> positionOffset;
+        Shader::Uniform<glm::vec3> positionScale;
+        Shader::Uniform<int> materialShininess;
+        Shader::Uniform<glm::vec3> materialEmission;
+    };
+
+    // What UGLProp::Render still uploads per prop with FrameUniforms.
+    struct ObjectHandles {
+        Shader::Uniform<int> objectIndex;
+        Shader::Uniform<glm::vec3> positionOffset;
+        Shader::Uniform<glm::vec3> positionScale;
+        Shader::Uniform<int> materialShininess;
+        Shader::Uniform<glm::vec3> materialEmission;
+    };
+
+    struct Frame {
+        Camera camera;
+        glm::mat4 view;
+        glm::mat4 projection;
+    };
+
+    // The uploads before reflection: look the location up by name on every call.
+    void setByLocation(GLuint program, const std::string& name, const glm::mat4& value) {
+        glUniformMatrix4fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, &value[0][0]);
+    }
+    void setByLocation(GLuint program, const std::string& name, const glm::vec3 value) {
+        glUniform3f(glGetUniformLocation(program, name.c_str()), value.x, value.y, value.z);
+    }
+    void setByLocation(GLuint program, const std::string& name, const int value) {
+        glUniform1i(glGetUniformLocation(program, name.c_str()), value);
+    }
+
+    const glm::vec3 ZERO(0.0f);
+    const glm::vec3 ONE(1.0f);
+
+    void lookupEachCall(Shader& shader, const Frame& frame, const PropState& prop) {
+        setByLocation(shader.ID, "num_lights", 4);
+        setByLocation(shader.ID, "cameraPosition", frame.camera.Position);
+        setByLocation(shader.ID, "model", prop.model);
+        setByLocation(shader.ID, "view", frame.view);
+        setByLocation(shader.ID, "projection", frame.projection);
+        setByLocation(shader.ID, "positionOffset", ZERO);
+        setByLocation(shader.ID, "positionScale", ONE);
+        setByLocation(shader.ID, "materialShininess", prop.shininess);
+        setByLocation(shader.ID, "materialEmission", prop.emission);
+    }
+
+    void reflectedByName(Shader& shader, const Frame& frame, const PropState& prop) {
+        shader.setInt("num_lights", 4);
+        shader.setVec3("cameraPosition", frame.camera.Position);
+        shader.setMatrix4fv("model", prop.model);
+        shader.setMatrix4fv("view", frame.view);
+        shader.setMatrix4fv("projection", frame.projection);
+        shader.setVec3("positionOffset", ZERO);
+        shader.setVec3("positionScale", ONE);
+        shader.setInt("materialShininess", prop.shininess);
+        shader.setVec3("materialEmission", prop.emission);
+    }
+
+    void throughHandles(Shader& shader, const Handles& handles, const Frame& frame, const PropState& prop) {
+        shader.set(handles.numLights, 4);
+        shader.set(handles.cameraPosition, frame.camera.Position);
+        shader.set(handles.model, prop.model);
+        shader.set(handles.view, frame.view);
+        shader.set(handles.projection, frame.projection);
+        shader.set(handles.positionOffset, ZERO);
+        shader.set(handles.positionScale, ONE);
+        shader.set(handles.materialShininess, prop.shininess);
+        shader.set(handles.materialEmission, prop.emission);
+    }
+
+    void throughObjectBuffer(Shader& shader, const ObjectHandles& handles, RichWerks::FrameUniforms& frameUniforms, const PropState& prop) {
+        shader.set(handles.objectIndex, frameUniforms.AddObject(prop.model, prop.normalMatrix));
+        shader.set(handles.positionOffset, ZERO);
+        shader.set(handles.positionScale, ONE);
+        shader.set(handles.materialShininess, prop.shininess);
+        shader.set(handles.materialEmission, prop.emission);
+    }
+
+    struct Result {
+        double nanosecondsPerProp;
+        double uploadsPerProp;
+    };
+
+    // perFrame runs once before each frame's props, inside the timing.
+    template <class B, class F>
+    Result run(Shader& shader, const std::vector<PropState>& props, const int frames, B perFrame, F perProp) {
+        shader.use();
+        const size_t uploadsBefore = shader.getUploadCount();
+        shader.invalidateUniforms();
+        glFinish();
+        const Clock::time_point start = Clock::now();
+        for (int f = 0; f < frames; ++f) {
+            // The camera moves every frame, so each frame's first prop uploads view and projection.
+            Frame frame;
+            frame.camera.Position = glm::vec3(0.0f, 5.0f, 20.0f + 0.01f * f);
+            frame.view = frame.camera.GetViewMatrix();
+            frame.projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+            perFrame(frame);
+            for (const PropState& prop : props) {
+                perProp(frame, prop);
+            }
+        }
+        glFinish();
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        const double propDraws = static_cast<double>(props.size()) * frames;
+        return { seconds * 1.0e9 / propDraws, (shader.getUploadCount() - uploadsBefore) / propDraws };
+    }
+
+    template <class F>
+    Result run(Shader& shader, const std::vector<PropState>& props, const int frames, F perProp) {
+        return run(shader, props, frames, [](const Frame&) {}, perProp);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int propCount = argc > 1 ? std::atoi(argv[1]) : 4000;
+    const int frames = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "UniformBenchmark", NULL, NULL);
+    if (window == NULL) {
+        std::cout << "Failed to create an OpenGL 4.4 context" << std::endl;
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        std::cout << "Failed to initialize GLEW" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Shader shader(BENCHMARK_SHADER_DIR "legacy_phong_shader.vs", BENCHMARK_SHADER_DIR "legacy_phong_shader.fs");
+    Shader objectShader(SHADER_DIR "phong_shader.vs", SHADER_DIR "phong_shader2.fs");
+    if (!shader.success || !objectShader.success) {
+        return EXIT_FAILURE;
+    }
+    Handles handles;
+    handles.numLights = shader.getUniform<int>("num_lights");
+    handles.cameraPosition = shader.getUniform<glm::vec3>("cameraPosition");
+    handles.model = shader.getUniform<glm::mat4>("model");
+    handles.view = shader.getUniform<glm::mat4>("view");
+    handles.projection = shader.getUniform<glm::mat4>("projection");
+    handles.positionOffset = shader.getUniform<glm::vec3>("positionOffset");
+    handles.positionScale = shader.getUniform<glm::vec3>("positionScale");
+    handles.materialShininess = shader.getUniform<int>("materialShininess");
+    handles.materialEmission = shader.getUniform<glm::vec3>("materialEmission");
+    ObjectHandles objectHandles;
+    objectHandles.objectIndex = objectShader.getUniform<int>("objectIndex");
+    objectHandles.positionOffset = objectShader.getUniform<glm::vec3>("positionOffset");
+    objectHandles.positionScale = objectShader.getUniform<glm::vec3>("positionScale");
+    objectHandles.materialShininess = objectShader.getUniform<int>("materialShininess");
+    objectHandles.materialEmission = objectShader.getUniform<glm::vec3>("materialEmission");
+    // Released before the context goes away.
+    std::unique_ptr<RichWerks::FrameUniforms> frameUniforms(new RichWerks::FrameUniforms(propCount));
+
+    // A grid of props, each with one of four materials.
+    std::vector<PropState> props(propCount);
+    const int SHININESS[] = { 1, 8, 32, 64 };
+    const glm::vec3 EMISSION[] = { glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.81f, 0.73f, 0.43f), glm::vec3(0.0f) };
+    for (int i = 0; i < propCount; ++i) {
+        props[i].model = glm::translate(glm::vec3(i % 64, 0.0f, i / 64) * 3.0f);
+        props[i].normalMatrix = RichWerks::FrameUniforms::NormalMatrix(props[i].model);
+        props[i].shininess = SHININESS[i % 4];
+        props[i].emission = EMISSION[i % 4];
+    }
+
+    struct Case {
+        const char* name;
+        Result result;
+    };
+    const Case cases[] = {
+        { "glGetUniformLocation", run(shader, props, frames, [&](const Frame& frame, const PropState& prop) {
+            lookupEachCall(shader, frame, prop); }) },
+        { "reflected by name", run(shader, props, frames, [&](const Frame& frame, const PropState& prop) {
+            reflectedByName(shader, frame, prop); }) },
+        { "handles, unfiltered", run(shader, props, frames, [&](const Frame& frame, const PropState& prop) {
+            shader.invalidateUniforms(); throughHandles(shader, handles, frame, prop); }) },
+        { "handles, filtered", run(shader, props, frames, [&](const Frame& frame, const PropState& prop) {
+            throughHandles(shader, handles, frame, prop); }) },
+        { "frame/object buffers", run(objectShader, props, frames, [&](const Frame& frame) {
+            frameUniforms->End();
+            frameUniforms->Begin(frame.camera, frame.projection, 4, glm::ivec4(0, 0, 800, 600)); },
+            [&](const Frame&, const PropState& prop) {
+            throughObjectBuffer(objectShader, objectHandles, *frameUniforms, prop); }) },
+    };
+    frameUniforms->End();
+
+    std::cout << propCount << " props, " << frames << " frames, 9 uniforms per prop (5 and a buffer entry with FrameUniforms), " << glGetString(GL_RENDERER) << std::endl << std::endl;
+    std::cout << std::left << std::setw(24) << "path" << std::right << std::setw(14) << "ns/prop" << std::setw(18) << "uploads/prop"
+        << std::setw(12) << "speedup" << std::endl;
+    for (const Case& entry : cases) {
+        // The first case goes around the Shader, so its upload count is the call count.
+        const double uploads = &entry == &cases[0] ? 9.0 : entry.result.uploadsPerProp;
+        std::cout << std::left << std::setw(24) << entry.name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(14) << entry.result.nanosecondsPerProp
+            << std::setprecision(2) << std::setw(18) << uploads
+            << std::setprecision(2) << std::setw(11) << cases[0].result.nanosecondsPerProp / entry.result.nanosecondsPerProp << "x" << std::endl;
+    }
+
+    glDeleteProgram(shader.ID);
+    glDeleteProgram(objectShader.ID);
+    frameUniforms.reset();
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,30 @@
+#version 440 core
+
+// shaders/phong_shader.vs as it was before FrameUniforms, with the camera, light count and
+// matrices as plain uniforms. UniformBenchmark measures the per-prop uploads it needed.
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 aTexCoord;
+
+out vec3 vertexNormal;
+out vec3 vertexFragmentPos;
+out vec2 TexCoord;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// Dequantization of compact meshes (16-bit positions over the mesh bounds).
+// Float meshes use an offset of 0 and a scale of 1.
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+void main()
+{
+    vec3 localPosition = positionOffset + position * positionScale;
+    gl_Position = projection * view * model * vec4(localPosition, 1.0f);
+    vertexFragmentPos = vec3(model * vec4(localPosition, 1.0f));
+    vertexNormal = mat3(transpose(inverse(model))) * normal;
+    TexCoord = aTexCoord;
+}
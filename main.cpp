@@ -3,7 +3,13 @@
 
 #include <vector>
 #include "UGLProp.hpp"
+#include "GLStateCache.hpp"
 #include "MeshGenerator.hpp"
+#include "MeshCache.hpp"
+#include "Terrain.hpp"
+#include "StaticBatch.hpp"
+#include "IndirectRenderer.hpp"
+#include "RenderQueue.hpp"
 
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -46,6 +52,10 @@ namespace
     glm::mat4 ortho = glm::ortho(-5.0f, 5.0f, -5.0f, 5.0f, 0.1f, 100.0f);
     glm::mat4 currentProjection;
     double lastProjectionChange = glfwGetTime();
+    double lastRendererChange = glfwGetTime();
+
+    // State change counters, shown in the window title once a second
+    double lastStateReport = 0.0;
 
     // namespace-scoped variables
 
@@ -55,7 +65,32 @@ namespace
     // Scene Props
     vector<RichWerks::UGLProp> propVector;
 
-    map<const char*, unsigned int> textureCache;
+    // Camera and per-object matrices, written once per frame for every shader
+    RichWerks::FrameUniforms frameUniforms;
+
+    // Draws every mesh prop with one glMultiDrawElementsIndirect; null without context support.
+    // useIndirect switches between it and a draw per prop mesh through renderQueue (M key).
+    unique_ptr<RichWerks::IndirectRenderer> gIndirectRenderer;
+    bool useIndirect = true;
+
+    // Prop meshes drawn one by one, sorted front to back and by shader, texture and mesh
+    RichWerks::RenderQueue renderQueue;
+
+    // Props that never move, merged into one draw per shader and material
+    RichWerks::StaticBatch staticBatch;
+
+    // Ground: flat around the candles, streamed in tiles as the camera moves
+    unique_ptr<RichWerks::Terrain> gTerrain;
+
+    // Generated meshes shared between props
+    RichWerks::MeshCache meshCache;
+
+    // Level of detail chain for props made of parametric meshes: detail scale of each
+    // coarser level and the viewport-height fraction below which it is drawn.
+    const float LOD_DETAIL_SCALES[] = { 0.5f, 0.25f };
+    const float LOD_SCREEN_SIZES[] = { 0.2f, 0.08f };
+
+    map<const char*, pair<unsigned int, glm::ivec2>> textureCache;    // Texture and its size per file
 }
 
 
@@ -75,7 +110,8 @@ void UMousePositionCallback(GLFWwindow* window, double xpos, double ypos);
 void UMouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 void UMouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void USetLighting();
-unsigned int ULoadTexture(const char* texFile);
+unsigned int ULoadTexture(const char* texFile, glm::ivec2& size);
+void UAddMeshesWithLOD(RichWerks::UGLProp& prop, const vector<RichWerks::MeshRecipe>& recipes);
 
 void UGLErrorCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam);
 
@@ -86,7 +122,7 @@ int main(int argc, char* argv[])
     if (!UInitialize(argc, argv, &gWindow))
         return EXIT_FAILURE;
     // Enable debug output
-    glEnable(GL_DEBUG_OUTPUT);
+    RichWerks::GLStateCache::Current().Enable(GL_DEBUG_OUTPUT);
     glDebugMessageCallback(UGLErrorCallback, 0);
     //if (!UCreateShaderProgram(VERTEX_SHADER_SOURCE, FRAGMENT_SHADER_SOURCE, gProgramId))
     //    return EXIT_FAILURE;
@@ -96,28 +132,50 @@ int main(int argc, char* argv[])
     if (!UCreateShaderProgram(phongShader, "shaders/phong_shader.vs", "shaders/phong_shader2.fs")) {
         return EXIT_FAILURE;
     }
+
+    // Same lighting, with the vertices generated in the vertex shader (no vertex buffers).
+    Shader proceduralShader;
+    if (!UCreateShaderProgram(proceduralShader, "shaders/procedural_shader.vs", "shaders/phong_shader2.fs")) {
+        return EXIT_FAILURE;
+    }
+
+    // Procedural meshes refined on the GPU by screen size. Optional: props fall back to
+    // proceduralShader when the context has no tessellation support.
+    Shader tessellationShader;
+    if (RichWerks::TessellationSupported()) {
+        tessellationShader = Shader("shaders/tessellation_shader.vs", "shaders/phong_shader2.fs",
+            "shaders/tessellation_shader.tcs", "shaders/tessellation_shader.tes");
+    }
+
+    // Same lighting, for the multi-draw indirect path: per-draw data is found through gl_DrawID.
+    Shader indirectShader;
+    if (RichWerks::IndirectDrawSupported()
+        && UCreateShaderProgram(indirectShader, "shaders/indirect_shader.vs", "shaders/indirect_shader.fs")) {
+        gIndirectRenderer = make_unique<RichWerks::IndirectRenderer>(indirectShader);
+    }
     
     USetLighting();
-    // Create meshes for the objects that make up our candle holder and candle.
+    // Create meshes for the objects that make up our candle holder and candle. Props baked into
+    // staticBatch are only ever drawn from the batch, so they get CPU meshes and no buffers.
     
     RichWerks::UGLProp woodBase;
     woodBase.AttachShader(phongShader);
     RichWerks::Material woodBaseMaterial;
-    woodBaseMaterial.texture = ULoadTexture("textures/wood1.jpg");
+    woodBaseMaterial.texture = ULoadTexture("textures/wood1.jpg", woodBaseMaterial.textureSize);
     woodBaseMaterial.shininess = 1;
     woodBase.SetMaterial(woodBaseMaterial);
-    woodBase.AddMesh(generateCube(10.0f, 10.0f, 1.0f));
-    woodBase.BindMesh();
+    woodBase.AddMesh(RichWerks::MeshRecipe::Cube(10.0f, 10.0f, 1.0f).Generate());
     woodBase.Rotate(glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    propVector.push_back(woodBase);
+    staticBatch.AddProp(woodBase);
 
     RichWerks::UGLProp glassCandle;
-    glassCandle.AttachShader(phongShader);
+    glassCandle.AttachShader(proceduralShader);
     RichWerks::Material glassCandleMaterial;
-    glassCandleMaterial.texture = ULoadTexture("textures/ceramic.jpg"); // <a href="https://www.freepik.com/free-photo/close-up-white-marble-textured-background_3472368.htm#query=white%20ceramic%20texture&position=28&from_view=keyword&track=ais">Image by rawpixel.com</a> on Freepik
+    glassCandleMaterial.texture = ULoadTexture("textures/ceramic.jpg", glassCandleMaterial.textureSize); // <a href="https://www.freepik.com/free-photo/close-up-white-marble-textured-background_3472368.htm#query=white%20ceramic%20texture&position=28&from_view=keyword&track=ais">Image by rawpixel.com</a> on Freepik
     glassCandleMaterial.shininess = 64;
     glassCandle.SetMaterial(glassCandleMaterial);
-    glassCandle.AddMesh(generateCylinder(2.5f, 5.0f, 30));
+    glassCandle.SetProceduralMesh(RichWerks::ProceduralMesh::Cylinder(2.5f, 5.0f, 30));
+    glassCandle.EnableTessellation(tessellationShader);
     glassCandle.BindMesh();
     glassCandle.Translate(woodBase.GetPosition() + glm::vec3(0.0f, 0.5f, 0.0f));
     propVector.push_back(glassCandle);
@@ -125,28 +183,23 @@ int main(int argc, char* argv[])
     RichWerks::UGLProp candleStick;
     candleStick.AttachShader(phongShader);
     RichWerks::Material candleStickMaterial;
-    candleStickMaterial.texture = ULoadTexture("textures/distressed_wood.jpg");
+    candleStickMaterial.texture = ULoadTexture("textures/distressed_wood.jpg", candleStickMaterial.textureSize);
     candleStickMaterial.shininess = 1;
     candleStick.SetMaterial(candleStickMaterial);
     // Base of candle stick
-    candleStick.AddMesh(generateCube(4.0f, 4.0f, 1.0f));
+    candleStick.AddMesh(RichWerks::MeshRecipe::Cube(4.0f, 4.0f, 1.0f).Generate());
     // Shaft of Candlestick
-    RichWerks::Mesh candleStickShaft = generateCube(2.0f, 2.0f, 5.0f);
-    translateMesh(candleStickShaft, glm::vec3(0.0f, 1.0f, 0.0f) * 1.0f);
-    candleStick.AddMesh(candleStickShaft);
+    candleStick.AddMesh(RichWerks::MeshRecipe::Cube(2.0f, 2.0f, 5.0f).Translate(glm::vec3(0.0f, 1.0f, 0.0f) * 1.0f).Generate());
     // Candlestick Platform
-    RichWerks::Mesh candleStickShaft2 = generateCube(5.0f, 5.0f, 1.0f);
-    translateMesh(candleStickShaft2, glm::vec3(0.0f, 1.0f, 0.0f) * 6.0f);
-    candleStick.AddMesh(candleStickShaft2);
-    candleStick.BindMesh();
+    candleStick.AddMesh(RichWerks::MeshRecipe::Cube(5.0f, 5.0f, 1.0f).Translate(glm::vec3(0.0f, 1.0f, 0.0f) * 6.0f).Generate());
     candleStick.Rotate(glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     candleStick.Translate(glm::vec3(-1.0f, 0.0f, 1.0f) * 5.5f);
-    propVector.push_back(candleStick);
+    staticBatch.AddProp(candleStick);
 
     // Candle
     RichWerks::UGLProp candle;
     RichWerks::Material candleMaterial;
-    candleMaterial.texture = ULoadTexture("textures/candle2.jpg");
+    candleMaterial.texture = ULoadTexture("textures/candle2.jpg", candleMaterial.textureSize);
     candleMaterial.shininess = 8;
     candleMaterial.emission = glm::vec3(0.81f, 0.73f, 0.43f);
     candleMaterial.materialAlpha = 0.3f;
@@ -154,7 +207,7 @@ int main(int argc, char* argv[])
     candle.SetMaterial(candleMaterial);
     candle.AttachShader(phongShader);
     // Base of candle stick
-    candle.AddMesh(generateCylinder(2.0f, 5.0f, 30));
+    UAddMeshesWithLOD(candle, { RichWerks::MeshRecipe::Cylinder(2.0f, 5.0f, 30) });
     candle.BindMesh();
     candle.Translate(glm::vec3(candleStick.GetPosition().x, 7.0f, candleStick.GetPosition().z));
     propVector.push_back(candle);
@@ -162,28 +215,23 @@ int main(int argc, char* argv[])
     RichWerks::UGLProp candleStick2;
     candleStick2.AttachShader(phongShader);
     RichWerks::Material candleStick2Material;
-    candleStick2Material.texture = ULoadTexture("textures/distressed_wood.jpg");
+    candleStick2Material.texture = ULoadTexture("textures/distressed_wood.jpg", candleStick2Material.textureSize);
     candleStick2Material.shininess = 1;
     candleStick2.SetMaterial(candleStick2Material);
     // Base of candle stick
-    candleStick2.AddMesh(generateCube(4.0f, 4.0f, 1.0f));
+    candleStick2.AddMesh(RichWerks::MeshRecipe::Cube(4.0f, 4.0f, 1.0f).Generate());
     // Shaft of Candlestick
-    RichWerks::Mesh candleStick2Shaft = generateCube(2.0f, 2.0f, 5.0f);
-    translateMesh(candleStick2Shaft, glm::vec3(0.0f, 1.0f, 0.0f) * 1.0f);
-    candleStick2.AddMesh(candleStick2Shaft);
+    candleStick2.AddMesh(RichWerks::MeshRecipe::Cube(2.0f, 2.0f, 5.0f).Translate(glm::vec3(0.0f, 1.0f, 0.0f) * 1.0f).Generate());
     // Candlestick Platform
-    RichWerks::Mesh candleStick2Shaft2 = generateCube(5.0f, 5.0f, 1.0f);
-    translateMesh(candleStick2Shaft2, glm::vec3(0.0f, 1.0f, 0.0f) * 6.0f);
-    candleStick2.AddMesh(candleStick2Shaft2);
-    candleStick2.BindMesh();
+    candleStick2.AddMesh(RichWerks::MeshRecipe::Cube(5.0f, 5.0f, 1.0f).Translate(glm::vec3(0.0f, 1.0f, 0.0f) * 6.0f).Generate());
     candleStick2.Rotate(glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     candleStick2.Translate(glm::vec3(1.0f, 0.0f, 1.0f) * 5.5f);
-    propVector.push_back(candleStick2);
+    staticBatch.AddProp(candleStick2);
 
     // Candle2
     RichWerks::UGLProp candle2;
     RichWerks::Material candle2Material;
-    candle2Material.texture = ULoadTexture("textures/candle2.jpg");
+    candle2Material.texture = ULoadTexture("textures/candle2.jpg", candle2Material.textureSize);
     candle2Material.shininess = 8;
     candle2Material.emission = glm::vec3(0.81f, 0.73f, 0.43f);
     candleMaterial.materialAlpha = 0.3f;
@@ -191,55 +239,54 @@ int main(int argc, char* argv[])
     candle2.SetMaterial(candle2Material);
     candle2.AttachShader(phongShader);
     // Base of candle stick
-    candle2.AddMesh(generateCylinder(2.0f, 5.0f, 30));
+    UAddMeshesWithLOD(candle2, { RichWerks::MeshRecipe::Cylinder(2.0f, 5.0f, 30) });
     candle2.BindMesh();
     candle2.Translate(glm::vec3(candleStick2.GetPosition().x, 7.0f, candleStick2.GetPosition().z));
     propVector.push_back(candle2);
 
-    // Floor
-    RichWerks::UGLProp floor;
+    // Floor: level within 25 units of the origin, rolling hills further out. The granite
+    // repeats every 40 units, like the 40 x 40 floor plane this replaces.
+    gTerrain = make_unique<RichWerks::Terrain>([](GLfloat x, GLfloat z) {
+        const GLfloat blend = glm::smoothstep(25.0f, 60.0f, glm::length(glm::vec2(x, z)));
+        return blend * (8.0f * sin(x * 0.05f) * cos(z * 0.07f) + 3.0f * sin(x * 0.13f + z * 0.11f) + 3.0f);
+    });
     RichWerks::Material floorMaterial;
-    floorMaterial.texture = ULoadTexture("textures/granite.jpg");
+    floorMaterial.texture = ULoadTexture("textures/granite.jpg", floorMaterial.textureSize);
     floorMaterial.shininess = 16;
-    floor.SetMaterial(floorMaterial);
-    floor.AttachShader(phongShader);
-    // Base of candle stick
-    floor.AddMesh(generatePlane(40.0f, 40.0f));
-    floor.BindMesh();
-    propVector.push_back(floor);
+    gTerrain->SetMaterial(floorMaterial);
+    gTerrain->AttachShader(phongShader);
+    gTerrain->BindMesh();
 
     RichWerks::UGLProp lampPost;
     RichWerks::Material lampPostMaterial;
-    lampPostMaterial.texture = ULoadTexture("textures/brass.jpg");
+    lampPostMaterial.texture = ULoadTexture("textures/brass.jpg", lampPostMaterial.textureSize);
     lampPostMaterial.shininess = 32;
     lampPost.SetMaterial(lampPostMaterial);
     lampPost.AttachShader(phongShader);
-    lampPost.AddMesh(generateCylinder(0.5f, 12.0f, 20));
-    RichWerks::Mesh lampMesh2 = generateCylinder(0.5f, 3.5f, 20);
-    rotateMesh(lampMesh2, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-    translateMesh(lampMesh2, glm::vec3(0.0f, 12.0f, 0.0f));
-    lampPost.AddMesh(lampMesh2);
-    RichWerks::Mesh lampMesh3 = generateCylinder(0.5f, 3.0f, 20);
-    translateMesh(lampMesh3, glm::vec3(0.0f, 12.0f - 3.0f, 3.5f));
-    lampPost.AddMesh(lampMesh3);
+    UAddMeshesWithLOD(lampPost, {
+        RichWerks::MeshRecipe::Cylinder(0.5f, 12.0f, 20),
+        RichWerks::MeshRecipe::Cylinder(0.5f, 3.5f, 20)
+            .Rotate(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f))
+            .Translate(glm::vec3(0.0f, 12.0f, 0.0f)),
+        RichWerks::MeshRecipe::Cylinder(0.5f, 3.0f, 20).Translate(glm::vec3(0.0f, 12.0f - 3.0f, 3.5f)) });
     lampPost.BindMesh();
     lampPost.Translate(glm::vec3(0.0f, 0.0f, -3.5f));
     propVector.push_back(lampPost);
 
     RichWerks::UGLProp lampHead;
     RichWerks::Material lampHeadMaterial;
-    lampHeadMaterial.texture = ULoadTexture("textures/pink_glass.jpg");
+    lampHeadMaterial.texture = ULoadTexture("textures/pink_glass.jpg", lampHeadMaterial.textureSize);
     lampHeadMaterial.shininess = 64;
     candleMaterial.emission = glm::vec3(1.0f, 0.34f, 0.2f);
     candleMaterial.materialAlpha = 0.01f;
     candleMaterial.materialScatterG = -0.5;
     lampHead.SetMaterial(lampHeadMaterial);
     lampHead.AttachShader(phongShader);
-    RichWerks::Mesh lampHeadMesh = generatePyramid(4.0f, 5.0f);
-    translateMesh(lampHeadMesh, glm::vec3(0.0f, 12.0f - 3.0f - 2.0f, 0.0f));
-    lampHead.AddMesh(lampHeadMesh);
-    lampHead.BindMesh();
-    propVector.push_back(lampHead);
+    lampHead.AddMesh(RichWerks::MeshRecipe::Pyramid(4.0f, 5.0f).Translate(glm::vec3(0.0f, 12.0f - 3.0f - 2.0f, 0.0f)).Generate());
+    staticBatch.AddProp(lampHead);
+
+    // The wood base, both candlesticks (one material) and the lamp head: three draws instead of eight.
+    staticBatch.BindMesh();
 
 
     // Sets the background color of the window to black (it will be implicitely used by glClear)
@@ -262,7 +309,16 @@ int main(int argc, char* argv[])
         glfwPollEvents();
     }
     
+    gTerrain.reset();
+    gIndirectRenderer.reset();
     UDestroyShaderProgram(phongShader.ID);
+    UDestroyShaderProgram(proceduralShader.ID);
+    if (tessellationShader.success) {
+        UDestroyShaderProgram(tessellationShader.ID);
+    }
+    if (indirectShader.success) {
+        UDestroyShaderProgram(indirectShader.ID);
+    }
 
     exit(EXIT_SUCCESS); // Terminates the program successfully
 }
@@ -314,6 +370,11 @@ bool UInitialize(int argc, char* argv[], GLFWwindow** window)
         return false;
     }
 
+    // The cache never queries GL, so it is told the viewport the context starts with.
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(*window, &framebufferWidth, &framebufferHeight);
+    RichWerks::GLStateCache::Current().Viewport(0, 0, framebufferWidth, framebufferHeight);
+
     // Displays GPU OpenGL version
     cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << endl;
 
@@ -343,13 +404,18 @@ void UProcessInput(GLFWwindow* window)
         currentProjection = currentProjection == perspective ? ortho : perspective;
         lastProjectionChange = glfwGetTime();
     }
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS && (glfwGetTime() - lastRendererChange) > 0.5)
+    {
+        useIndirect = !useIndirect;
+        lastRendererChange = glfwGetTime();
+    }
 }
 
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 void UResizeWindow(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    RichWerks::GLStateCache::Current().Viewport(0, 0, width, height);
 }
 
 bool UCreateShaderProgram(const char* vtxShaderSource, const char* fragShaderSource, GLuint& programId) {
@@ -406,7 +472,7 @@ bool UCreateShaderProgram(const char* vtxShaderSource, const char* fragShaderSou
         return false;
     }
 
-    glUseProgram(programId);    // Uses the shader program
+    RichWerks::GLStateCache::Current().UseProgram(programId);    // Uses the shader program
 
     return true;
 }
@@ -419,23 +485,50 @@ bool UCreateShaderProgram(Shader& t_shader,const char* t_vsPath, const char* t_f
 }
 
 void UDestroyShaderProgram(GLuint programId) {
-    glDeleteProgram(programId);
+    RichWerks::GLStateCache::Current().DeleteProgram(programId);
 }
 
 void URender() {
     
-    glEnable(GL_DEPTH_TEST);
+    RichWerks::GLStateCache& state = RichWerks::GLStateCache::Current();
+    state.Enable(GL_DEPTH_TEST);
 
     // Clear the background
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    for (RichWerks::UGLProp& prop : propVector) {
-        prop.Render(gCamera, currentProjection, lightingVector.size());
+    frameUniforms.Begin(gCamera, currentProjection, static_cast<GLint>(lightingVector.size()), state.GetViewport());
+    if (gIndirectRenderer && useIndirect) {
+        gIndirectRenderer->Render(frameUniforms, propVector);
+    }
+    else {
+        renderQueue.Begin(frameUniforms.GetFrameData());
+        for (RichWerks::UGLProp& prop : propVector) {
+            prop.Submit(renderQueue, frameUniforms);
+        }
+        renderQueue.Execute(frameUniforms.GetFrameData());
+    }
+    staticBatch.Render(frameUniforms);
+    if (gTerrain) {
+        gTerrain->Render(frameUniforms);
     }
+    frameUniforms.End();
         
     // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
     glfwSwapBuffers(gWindow);    // Flips the the back buffer with the front buffer every frame.
+
+    state.EndFrame();
+    if (glfwGetTime() - lastStateReport > 1.0) {
+        const RichWerks::GLStateCounter total = state.GetFrameCounters().Total();
+        string title = string(WINDOW_TITLE) + " - state changes per frame: " + to_string(total.issued)
+            + " issued, " + to_string(total.filtered) + " filtered";
+        if (gIndirectRenderer && useIndirect) {
+            title += " - indirect: " + to_string(gIndirectRenderer->GetCommandCount()) + " draws in "
+                + to_string(gIndirectRenderer->GetCallCount()) + " calls";
+        }
+        glfwSetWindowTitle(gWindow, title.c_str());
+        lastStateReport = glfwGetTime();
+    }
 }
 
 // Bind camera movement to mouse cursor.
@@ -469,14 +562,15 @@ void UMouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
     }
 }
 
-unsigned int ULoadTexture(const char* texFile) {
+unsigned int ULoadTexture(const char* texFile, glm::ivec2& size) {
     if (textureCache.find(texFile) != textureCache.end()) {
-        return textureCache.find(texFile)->second;
+        size = textureCache.find(texFile)->second.second;
+        return textureCache.find(texFile)->second.first;
     }
     
     unsigned int texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    RichWerks::GLStateCache::Current().BindTexture(0, GL_TEXTURE_2D, texture);
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -490,15 +584,31 @@ unsigned int ULoadTexture(const char* texFile) {
     if (data) {
         glTexImage2D(GL_TEXTURE_2D, 0, format[nrChannels - 1], width, height, 0, format[nrChannels - 1], GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
+        size = glm::ivec2(width, height);
     }
     else {
         cout << "Failed to load texture" << endl;
+        size = glm::ivec2(0);
     }
     stbi_image_free(data);
-    textureCache.insert({ texFile, texture });
+    textureCache.insert({ texFile, { texture, size } });
     return texture;
 }
 
+// Add the meshes for a list of recipes to a prop, plus a coarser LOD level per LOD_DETAIL_SCALES entry.
+void UAddMeshesWithLOD(RichWerks::UGLProp& prop, const vector<RichWerks::MeshRecipe>& recipes) {
+    for (const RichWerks::MeshRecipe& recipe : recipes) {
+        prop.AddMesh(meshCache.Get(recipe));
+    }
+    for (size_t level = 0; level < size(LOD_DETAIL_SCALES); ++level) {
+        vector<shared_ptr<const RichWerks::Mesh>> meshes;
+        for (const RichWerks::MeshRecipe& recipe : recipes) {
+            meshes.push_back(meshCache.Get(recipe.Reduced(LOD_DETAIL_SCALES[level])));
+        }
+        prop.AddLOD(meshes, LOD_SCREEN_SIZES[level]);
+    }
+}
+
 void USetLighting() {
     // create and add lighting for scene
     
@@ -559,10 +669,10 @@ void USetLighting() {
     GLuint buffer;
     GLuint sharedBindingPoint = 0;
     glGenBuffers(1, &buffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    RichWerks::GLStateCache& state = RichWerks::GLStateCache::Current();
+    state.BindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
     glBufferData(GL_SHADER_STORAGE_BUFFER, lightingVector.size() * sizeof(lightingVector[0]), lightingVector.data(), GL_DYNAMIC_COPY);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, sharedBindingPoint, buffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, sharedBindingPoint, buffer);
 }
 
 // Prints GLSL operation error to the screen.
@@ -5,7 +5,11 @@
 #include <glad/glad.h>
 #endif
 
+#include <cstring>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -14,6 +18,15 @@
 class Shader
 {
 public:
+    // Pre-resolved handle to an active uniform of GLSL type T (bool, int or sampler, float,
+    // vec2/3/4, mat4), from getUniform. An invalid handle is ignored by set.
+    template <class T>
+    struct Uniform
+    {
+        int slot = -1;
+        bool valid() const { return slot >= 0; }
+    };
+
     unsigned int ID;
     int success = 0;
     // constructor generates the shader on the fly
@@ -22,95 +35,306 @@ public:
     Shader(const char* vertexPath, const char* fragmentPath)
     {
         // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
+        const std::string vertexCode = readFile(vertexPath);
+        const std::string fragmentCode = readFile(fragmentPath);
+        // 2. compile shaders
+        unsigned int vertex = compileStage(GL_VERTEX_SHADER, vertexCode, "VERTEX");
+        unsigned int fragment = compileStage(GL_FRAGMENT_SHADER, fragmentCode, "FRAGMENT");
+        // shader Program
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        glAttachShader(ID, fragment);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+        reflectUniforms();
+        // delete the shaders as they're linked into our program now and no longer necessary
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+    }
+    // constructor with tessellation control and evaluation stages (OpenGL 4.0+)
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const char* fragmentPath, const char* tessControlPath, const char* tessEvaluationPath)
+    {
+        // 1. retrieve the source code of every stage
+        const std::string vertexCode = readFile(vertexPath);
+        const std::string fragmentCode = readFile(fragmentPath);
+        const std::string tessControlCode = readFile(tessControlPath);
+        const std::string tessEvaluationCode = readFile(tessEvaluationPath);
         // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+        unsigned int vertex = compileStage(GL_VERTEX_SHADER, vertexCode, "VERTEX");
+        unsigned int tessControl = compileStage(GL_TESS_CONTROL_SHADER, tessControlCode, "TESS_CONTROL");
+        unsigned int tessEvaluation = compileStage(GL_TESS_EVALUATION_SHADER, tessEvaluationCode, "TESS_EVALUATION");
+        unsigned int fragment = compileStage(GL_FRAGMENT_SHADER, fragmentCode, "FRAGMENT");
         // shader Program
         ID = glCreateProgram();
         glAttachShader(ID, vertex);
+        glAttachShader(ID, tessControl);
+        glAttachShader(ID, tessEvaluation);
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
+        reflectUniforms();
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
+        glDeleteShader(tessControl);
+        glDeleteShader(tessEvaluation);
         glDeleteShader(fragment);
     }
-    // activate the shader
+    // activate the shader. The renderer binds programs through RichWerks::GLStateCache
+    // instead, so that its shadow of the current program stays right.
     // ------------------------------------------------------------------------
     void use()
     {
         glUseProgram(ID);
     }
-    // utility uniform functions
+    // typed uniform handles
+    // ------------------------------------------------------------------------
+    // Look up an active uniform once (e.g. when a shader is attached) and keep the handle. The
+    // handle is invalid if the program has no such active uniform or its type does not match T.
+    template <class T>
+    Uniform<T> getUniform(const std::string& name) const
+    {
+        Uniform<T> handle;
+        const int slot = findUniform(name);
+        if (slot >= 0 && typeMatches<T>(uniformSlots[slot].type))
+        {
+            handle.slot = slot;
+        }
+        return handle;
+    }
+    // Upload a value to the program in use, unless it is the value last uploaded through this
+    // Shader. Call invalidateUniforms after setting uniforms of this program any other way.
+    template <class T>
+    void set(Uniform<T> handle, const T& value) const
+    {
+        if (handle.valid())
+        {
+            upload(handle.slot, value);
+        }
+    }
+    // ------------------------------------------------------------------------
+    void invalidateUniforms() const
+    {
+        for (UniformSlot& slot : uniformSlots)
+        {
+            slot.hasValue = false;
+        }
+    }
+    // uploads issued and skipped as redundant since construction
+    // ------------------------------------------------------------------------
+    size_t getUploadCount() const { return uploadCount; }
+    size_t getSkippedUploadCount() const { return skippedUploadCount; }
+    // utility uniform functions; same filtering as set, found by name in the reflected table
     // ------------------------------------------------------------------------
     void setBool(const std::string& name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        upload(findUniform(name), value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string& name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
-       
+        upload(findUniform(name), value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string& name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        upload(findUniform(name), value);
+    }
+    void setVec2(const std::string& name, glm::vec2 value) const {
+        upload(findUniform(name), value);
     }
     void setVec3(const std::string& name, glm::vec3 value) const {
-        GLint loc = glGetUniformLocation(ID, name.c_str());
-        glUniform3f(loc,value.x, value.y, value.z);
+        upload(findUniform(name), value);
     }
     void setVec4(const std::string& name, glm::vec4 value) const {
-        GLint loc = glGetUniformLocation(ID, name.c_str());
-        glUniform4f(loc, value.x, value.y, value.z, value.w);
+        upload(findUniform(name), value);
     }
     void setMatrix4fv(const std::string& name, const glm::mat4 value) const{
-        GLint loc = glGetUniformLocation(ID, name.c_str());
-        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
-        
+        upload(findUniform(name), value);
     }
 
 private:
+    // One active uniform of the linked program, with the last value uploaded to it.
+    struct UniformSlot
+    {
+        GLenum type = 0;
+        GLint location = -1;
+        bool hasValue = false;
+        const void* valueType = nullptr;    // Which upload function wrote value (see valueTypeOf)
+        unsigned char value[sizeof(glm::mat4)];
+    };
+
+    mutable std::vector<UniformSlot> uniformSlots;
+    std::unordered_map<std::string, int> uniformIndex;
+    mutable size_t uploadCount = 0;
+    mutable size_t skippedUploadCount = 0;
+
+    // utility function for listing the active uniforms after linking.
+    // Uniforms in blocks have no location and are left out. Each element of an array of a
+    // basic type gets its own slot as name[i], at consecutive locations; the base name is
+    // the first element.
+    // ------------------------------------------------------------------------
+    void reflectUniforms()
+    {
+        uniformSlots.clear();
+        uniformIndex.clear();
+        if (!success)
+        {
+            return;
+        }
+        GLint count = 0;
+        GLint maxNameLength = 0;
+        glGetProgramInterfaceiv(ID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+        glGetProgramInterfaceiv(ID, GL_UNIFORM, GL_MAX_NAME_LENGTH, &maxNameLength);
+        std::vector<char> name(maxNameLength + 1);
+        const GLenum properties[] = { GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE };
+        for (GLint i = 0; i < count; ++i)
+        {
+            GLint values[3];
+            glGetProgramResourceiv(ID, GL_UNIFORM, i, 3, properties, 3, NULL, values);
+            if (values[1] < 0)
+            {
+                continue;
+            }
+            glGetProgramResourceName(ID, GL_UNIFORM, i, static_cast<GLsizei>(name.size()), NULL, name.data());
+            std::string uniformName(name.data());
+            const size_t bracket = uniformName.find("[0]");
+            const bool isArray = bracket != std::string::npos && bracket + 3 == uniformName.size();
+            if (isArray)
+            {
+                uniformName.erase(bracket);
+            }
+            UniformSlot slot;
+            slot.type = static_cast<GLenum>(values[0]);
+            slot.location = values[1];
+            uniformIndex[uniformName] = static_cast<int>(uniformSlots.size());
+            uniformSlots.push_back(slot);
+            for (GLint element = 0; isArray && element < values[2]; ++element)
+            {
+                if (element > 0)
+                {
+                    slot.location = values[1] + element;
+                    uniformSlots.push_back(slot);
+                }
+                uniformIndex[uniformName + "[" + std::to_string(element) + "]"] = static_cast<int>(uniformSlots.size() - 1);
+            }
+        }
+    }
+    // ------------------------------------------------------------------------
+    int findUniform(const std::string& name) const
+    {
+        const auto found = uniformIndex.find(name);
+        return found == uniformIndex.end() ? -1 : found->second;
+    }
+    // GLSL types a C++ type can be uploaded to through a handle.
+    // ------------------------------------------------------------------------
+    template <class T>
+    static bool typeMatches(GLenum type)
+    {
+        if constexpr (std::is_same_v<T, bool>) return type == GL_BOOL;
+        else if constexpr (std::is_same_v<T, int>) return type == GL_INT || type == GL_BOOL || type == GL_SAMPLER_2D || type == GL_SAMPLER_3D
+            || type == GL_SAMPLER_CUBE || type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_2D_SHADOW;
+        else if constexpr (std::is_same_v<T, float>) return type == GL_FLOAT;
+        else if constexpr (std::is_same_v<T, glm::vec2>) return type == GL_FLOAT_VEC2;
+        else if constexpr (std::is_same_v<T, glm::vec3>) return type == GL_FLOAT_VEC3;
+        else if constexpr (std::is_same_v<T, glm::vec4>) return type == GL_FLOAT_VEC4;
+        else if constexpr (std::is_same_v<T, glm::mat4>) return type == GL_FLOAT_MAT4;
+        else return false;
+    }
+    // A distinct address per C++ type, so a value set as a float never matches one set as an int.
+    // ------------------------------------------------------------------------
+    template <class T>
+    static const void* valueTypeOf()
+    {
+        static const char tag = 0;
+        return &tag;
+    }
+    // utility function for uploading a value unless the slot already holds it.
+    // ------------------------------------------------------------------------
+    template <class T>
+    void upload(int index, const T& value) const
+    {
+        static_assert(sizeof(T) <= sizeof(glm::mat4), "uniform value does not fit the cache");
+        if (index < 0)
+        {
+            return;
+        }
+        UniformSlot& slot = uniformSlots[index];
+        if (slot.hasValue && slot.valueType == valueTypeOf<T>() && std::memcmp(slot.value, &value, sizeof(T)) == 0)
+        {
+            ++skippedUploadCount;
+            return;
+        }
+        std::memcpy(slot.value, &value, sizeof(T));
+        slot.hasValue = true;
+        slot.valueType = valueTypeOf<T>();
+        ++uploadCount;
+        if constexpr (std::is_same_v<T, bool>) glUniform1i(slot.location, (int)value);
+        else if constexpr (std::is_same_v<T, int>) glUniform1i(slot.location, value);
+        else if constexpr (std::is_same_v<T, float>) glUniform1f(slot.location, value);
+        else if constexpr (std::is_same_v<T, glm::vec2>) glUniform2f(slot.location, value.x, value.y);
+        else if constexpr (std::is_same_v<T, glm::vec3>) glUniform3f(slot.location, value.x, value.y, value.z);
+        else if constexpr (std::is_same_v<T, glm::vec4>) glUniform4f(slot.location, value.x, value.y, value.z, value.w);
+        else glUniformMatrix4fv(slot.location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+    // utility function for reading a shader file into a string.
+    // ------------------------------------------------------------------------
+    std::string readFile(const char* path)
+    {
+        std::ifstream file;
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+            return resolveIncludes(stream.str(), path);
+        }
+        catch (std::ifstream::failure& e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << " " << e.what() << std::endl;
+        }
+        return std::string();
+    }
+    // utility function replacing each line #include "file" with the contents of file, read
+    // from the directory of the including file. GLSL has no include of its own.
+    // ------------------------------------------------------------------------
+    std::string resolveIncludes(const std::string& code, const std::string& path)
+    {
+        const std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+        std::istringstream lines(code);
+        std::string resolved;
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            const size_t start = line.find_first_not_of(" \t");
+            if (start != std::string::npos && line.compare(start, 8, "#include") == 0)
+            {
+                const size_t open = line.find('"', start);
+                const size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+                if (close != std::string::npos)
+                {
+                    resolved += readFile((directory + line.substr(open + 1, close - open - 1)).c_str());
+                    continue;
+                }
+            }
+            resolved += line;
+            resolved += '\n';
+        }
+        return resolved;
+    }
+    // utility function for compiling one shader stage.
+    // ------------------------------------------------------------------------
+    unsigned int compileStage(GLenum type, const std::string& code, const std::string& name)
+    {
+        const char* source = code.c_str();
+        unsigned int stage = glCreateShader(type);
+        glShaderSource(stage, 1, &source, NULL);
+        glCompileShader(stage);
+        checkCompileErrors(stage, name);
+        return stage;
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(unsigned int shader, std::string type)
@@ -0,0 +1,42 @@
+#version 440 core
+
+flat in int drawIndex;
+
+// Output color of the fragment shader
+out vec4 fragmentColor;
+
+// Per-draw entries written by RichWerks::IndirectRenderer (DrawData, MaterialData).
+struct DrawData {
+    int objectIndex;
+    int materialIndex;
+    int textureLayer;
+    int padding;
+};
+layout(std430, binding = 3) readonly buffer DrawBuffer {
+    DrawData draws[];
+};
+struct MaterialData {
+    vec3 emission;
+    int shininess;
+};
+layout(std430, binding = 4) readonly buffer MaterialBuffer {
+    MaterialData materials[];
+};
+
+// Every prop texture, one layer each; a draw picks its layer, so the index may vary freely.
+uniform sampler2DArray textures;
+uniform float materialScatterG;
+uniform float materialAlpha;
+
+// This draw's material, read once in main.
+int materialShininess;
+vec3 materialEmission;
+
+#include "phong_lighting.glsl"
+
+void main(){
+    DrawData draw = draws[drawIndex];
+    materialShininess = materials[draw.materialIndex].shininess;
+    materialEmission = materials[draw.materialIndex].emission;
+    fragmentColor = phongColor(texture(textures, vec3(TexCoord, draw.textureLayer)));
+}
@@ -0,0 +1,42 @@
+#version 440 core
+#extension GL_ARB_shader_draw_parameters : require
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 aTexCoord;
+
+out vec3 vertexNormal;
+out vec3 vertexFragmentPos;
+out vec2 TexCoord;
+flat out int drawIndex;
+
+// Matrices of every object drawn this frame (RichWerks::ObjectData).
+struct ObjectData {
+    mat4 model;
+    mat4 modelViewProjection;
+    mat4 normalMatrix;
+};
+layout(std430, binding = 2) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
+
+// One entry per indirect command (RichWerks::DrawData).
+struct DrawData {
+    int objectIndex;
+    int materialIndex;
+    int textureLayer;
+    int padding;
+};
+layout(std430, binding = 3) readonly buffer DrawBuffer {
+    DrawData draws[];
+};
+
+void main()
+{
+    drawIndex = gl_DrawIDARB;
+    ObjectData object = objects[draws[drawIndex].objectIndex];
+    gl_Position = object.modelViewProjection * vec4(position, 1.0f);
+    vertexFragmentPos = vec3(object.model * vec4(position, 1.0f));
+    vertexNormal = mat3(object.normalMatrix) * normal;
+    TexCoord = aTexCoord;
+}
@@ -31,13 +31,21 @@ in vec2 TexCoord;
 // Output color of the fragment shader
 out vec4 fragmentColor;
 
+// Camera and frame values, written once per frame (RichWerks::FrameData).
+layout(std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 cameraPosition;
+    int num_lights;
+    vec2 viewportSize;
+};
+
 // Uniform variables
 uniform vec3 v3color;
 uniform float strength;
 uniform sampler2D texSample;
-uniform vec3 cameraPosition;
 uniform int materialShininess;
-uniform int num_lights;
 
 // Function to calculate attenuation for light
 float calcAttenuation(vec3 position, int type, float intensity){
@@ -8,14 +8,28 @@ out vec3 vertexNormal;
 out vec3 vertexFragmentPos;
 out vec2 TexCoord;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Matrices of every object drawn this frame (RichWerks::ObjectData); objectIndex picks this draw's.
+struct ObjectData {
+    mat4 model;
+    mat4 modelViewProjection;
+    mat4 normalMatrix;
+};
+layout(std430, binding = 2) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
+uniform int objectIndex;
+
+// Dequantization of compact meshes (16-bit positions over the mesh bounds).
+// Float meshes use an offset of 0 and a scale of 1.
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(position, 1.0f);
-    vertexFragmentPos = vec3(model * vec4(position, 1.0f));
-    vertexNormal = mat3(transpose(inverse(model))) * normal;
+    vec3 localPosition = positionOffset + position * positionScale;
+    ObjectData object = objects[objectIndex];
+    gl_Position = object.modelViewProjection * vec4(localPosition, 1.0f);
+    vertexFragmentPos = vec3(object.model * vec4(localPosition, 1.0f));
+    vertexNormal = mat3(object.normalMatrix) * normal;
     TexCoord = aTexCoord;
-}
\ No newline at end of file
+}
@@ -0,0 +1,151 @@
+#version 440 core
+
+// Variant of phong_shader.vs for vertex-buffer-less draws (RichWerks::ProceduralMesh).
+// Position, normal and texture coordinate are rebuilt from gl_VertexID with the same
+// formulas as MeshGenerator.cpp; every shape is a list of non-indexed triangles.
+
+out vec3 vertexNormal;
+out vec3 vertexFragmentPos;
+out vec2 TexCoord;
+
+// Matrices of every object drawn this frame (RichWerks::ObjectData); objectIndex picks this draw's.
+struct ObjectData {
+    mat4 model;
+    mat4 modelViewProjection;
+    mat4 normalMatrix;
+};
+layout(std430, binding = 2) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
+uniform int objectIndex;
+
+// Values of RichWerks::ProceduralShape
+const int PLANE = 1;
+const int CYLINDER = 2;
+const int SPHERE = 3;
+const int TORUS = 4;
+
+uniform int proceduralShape;
+uniform vec3 proceduralParameters;  // Generator arguments in declaration order
+uniform int proceduralSegments;
+
+// Optional per-instance transforms, with their normal matrices (binding 0 holds the lights).
+uniform bool useInstanceTransforms;
+struct InstanceData {
+    mat4 transform;
+    mat4 normalMatrix;
+};
+layout(std430, binding = 1) readonly buffer InstanceBuffer {
+    InstanceData instances[];
+};
+
+const float PI = 3.14159265358979323846;
+
+// (column, row) offset of each of the 6 vertices of a quad, as two triangles.
+const ivec2 QUAD_CORNERS[6] = ivec2[](ivec2(0, 0), ivec2(0, 1), ivec2(1, 0), ivec2(1, 0), ivec2(0, 1), ivec2(1, 1));
+
+void plane(int id, out vec3 position, out vec3 normal, out vec2 texCoord)
+{
+    // Matches UNIT_PLANE_VERTICES scaled by (width, 0, length).
+    vec2 corner = vec2(QUAD_CORNERS[id]);
+    position = vec3((corner.x - 0.5f) * proceduralParameters.y, 0.0f, (0.5f - corner.y) * proceduralParameters.x);
+    normal = vec3(0.0f, 1.0f, 0.0f);
+    texCoord = corner;
+}
+
+void cylinder(int id, out vec3 position, out vec3 normal, out vec2 texCoord)
+{
+    float radius = proceduralParameters.x;
+    float height = proceduralParameters.y;
+    int segments = proceduralSegments;
+
+    // Body: one quad per segment, u around the axis and v up it.
+    if (id < 6 * segments) {
+        ivec2 corner = QUAD_CORNERS[id % 6];
+        int column = id / 6 + corner.x;
+        float angle = column * 2.0f * PI / segments;
+        normal = vec3(cos(angle), 0.0f, sin(angle));
+        position = vec3(normal.x * radius, corner.y * height, normal.z * radius);
+        texCoord = vec2(float(column) / segments, corner.y);
+        return;
+    }
+
+    // Caps: a fan triangle per segment, bottom cap first, UVs mapped across the disc.
+    id -= 6 * segments;
+    int triangle = id / 3;
+    int corner = id % 3;
+    float y = triangle < segments ? 0.0f : height;
+    normal = vec3(0.0f, triangle < segments ? -1.0f : 1.0f, 0.0f);
+    if (corner == 0) {
+        position = vec3(0.0f, y, 0.0f);
+        texCoord = vec2(0.5f);
+        return;
+    }
+    float angle = (triangle % segments + corner - 1) * 2.0f * PI / segments;
+    position = vec3(cos(angle) * radius, y, sin(angle) * radius);
+    texCoord = vec2(cos(angle), sin(angle)) * 0.5f + 0.5f;
+}
+
+void sphere(int id, out vec3 position, out vec3 normal, out vec2 texCoord)
+{
+    int divisions = proceduralSegments;
+    ivec2 corner = QUAD_CORNERS[id % 6];
+    int quad = id / 6;
+    int sector = quad % divisions + corner.x;
+    int ring = quad / divisions + corner.y;
+
+    float theta = ring * PI / divisions;
+    float phi = sector * 2.0f * PI / divisions;
+    normal = vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+    position = normal * proceduralParameters.x;
+    texCoord = vec2(float(sector) / divisions, float(ring) / divisions);
+}
+
+void torus(int id, out vec3 position, out vec3 normal, out vec2 texCoord)
+{
+    float outerRadius = proceduralParameters.x;
+    float innerRadius = proceduralParameters.y;
+    int segments = proceduralSegments;
+    ivec2 corner = QUAD_CORNERS[id % 6];
+    int quad = id / 6;
+    int major = quad / segments + corner.x;
+    int minor = quad % segments + corner.y;
+
+    float majorAngle = major * 2.0f * PI / segments;
+    float minorAngle = minor * 2.0f * PI / segments;
+    float ringRadius = outerRadius + innerRadius * cos(minorAngle);
+    position = vec3(ringRadius * cos(majorAngle), innerRadius * sin(minorAngle), ringRadius * sin(majorAngle));
+    normal = vec3(cos(majorAngle) * cos(minorAngle), sin(minorAngle), sin(majorAngle) * cos(minorAngle));
+    texCoord = vec2(float(major) / segments, float(minor) / segments);
+}
+
+void main()
+{
+    vec3 localPosition = vec3(0.0f);
+    vec3 normal = vec3(0.0f, 1.0f, 0.0f);
+    vec2 texCoord = vec2(0.0f);
+    if (proceduralShape == PLANE) {
+        plane(gl_VertexID, localPosition, normal, texCoord);
+    }
+    else if (proceduralShape == CYLINDER) {
+        cylinder(gl_VertexID, localPosition, normal, texCoord);
+    }
+    else if (proceduralShape == SPHERE) {
+        sphere(gl_VertexID, localPosition, normal, texCoord);
+    }
+    else if (proceduralShape == TORUS) {
+        torus(gl_VertexID, localPosition, normal, texCoord);
+    }
+
+    ObjectData object = objects[objectIndex];
+    vec4 instancePosition = vec4(localPosition, 1.0f);
+    vec3 instanceNormal = normal;
+    if (useInstanceTransforms) {
+        instancePosition = instances[gl_InstanceID].transform * instancePosition;
+        instanceNormal = mat3(instances[gl_InstanceID].normalMatrix) * instanceNormal;
+    }
+    gl_Position = object.modelViewProjection * instancePosition;
+    vertexFragmentPos = vec3(object.model * instancePosition);
+    vertexNormal = mat3(object.normalMatrix) * instanceNormal;
+    TexCoord = texCoord;
+}
@@ -0,0 +1,106 @@
+#version 440 core
+
+// Hardware-tessellated procedural meshes (RichWerks::ProceduralMesh with
+// UGLProp::EnableTessellation). Like procedural_shader.vs there are no vertex buffers:
+// gl_VertexID picks a corner of one of a few coarse quad patches, and the tessellation
+// control shader splits each patch edge by its size on screen.
+//
+// Patches cover the shape's (s, t) parameter domain in a patchesU x patchesV grid per
+// part; the cylinder has three parts (body, bottom cap, top cap). Keep the grid in sync
+// with ProceduralMesh::GetPatchCount and surfacePosition with evaluate() in
+// tessellation_shader.tes.
+
+out vec2 controlDomain;
+flat out int controlPart;
+flat out int controlInstance;
+out vec4 controlClipPosition;
+
+// Matrices of every object drawn this frame (RichWerks::ObjectData); objectIndex picks this draw's.
+struct ObjectData {
+    mat4 model;
+    mat4 modelViewProjection;
+    mat4 normalMatrix;
+};
+layout(std430, binding = 2) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
+uniform int objectIndex;
+
+// Values of RichWerks::ProceduralShape
+const int PLANE = 1;
+const int CYLINDER = 2;
+const int SPHERE = 3;
+const int TORUS = 4;
+
+uniform int proceduralShape;
+uniform vec3 proceduralParameters;  // Generator arguments in declaration order
+
+uniform bool useInstanceTransforms;
+struct InstanceData {
+    mat4 transform;
+    mat4 normalMatrix;
+};
+layout(std430, binding = 1) readonly buffer InstanceBuffer {
+    InstanceData instances[];
+};
+
+const float PI = 3.14159265358979323846;
+
+// Patch corners in the order the tessellation stages expect: (0,0), (1,0), (1,1), (0,1).
+const vec2 PATCH_CORNERS[4] = vec2[](vec2(0.0f, 0.0f), vec2(1.0f, 0.0f), vec2(1.0f, 1.0f), vec2(0.0f, 1.0f));
+
+// Angle of a periodic parameter. The seam (s = 1) maps to exactly the same point as
+// s = 0 so neighbouring patches agree on it bit for bit.
+float periodicAngle(float s)
+{
+    return 2.0f * PI * (s >= 1.0f ? 0.0f : s);
+}
+
+vec3 surfacePosition(int part, vec2 domain)
+{
+    vec3 parameters = proceduralParameters;
+    if (proceduralShape == PLANE) {
+        return vec3((domain.x - 0.5f) * parameters.y, 0.0f, (0.5f - domain.y) * parameters.x);
+    }
+    if (proceduralShape == CYLINDER) {
+        float angle = periodicAngle(domain.x);
+        if (part == 0) {
+            return vec3(cos(angle) * parameters.x, domain.y * parameters.y, sin(angle) * parameters.x);
+        }
+        // Caps: t runs from the center out to the rim.
+        return vec3(cos(angle) * (parameters.x * domain.y), part == 1 ? 0.0f : parameters.y, sin(angle) * (parameters.x * domain.y));
+    }
+    if (proceduralShape == SPHERE) {
+        float theta = domain.y * PI;
+        float phi = periodicAngle(domain.x);
+        return vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi)) * parameters.x;
+    }
+    float majorAngle = periodicAngle(domain.x);
+    float minorAngle = periodicAngle(domain.y);
+    float ringRadius = parameters.x + parameters.y * cos(minorAngle);
+    return vec3(ringRadius * cos(majorAngle), parameters.y * sin(minorAngle), ringRadius * sin(majorAngle));
+}
+
+void main()
+{
+    ivec2 patches = ivec2(1, 1);
+    if (proceduralShape == CYLINDER) {
+        patches = ivec2(4, 1);
+    }
+    else if (proceduralShape == SPHERE || proceduralShape == TORUS) {
+        patches = ivec2(8, 4);
+    }
+
+    int patchIndex = gl_VertexID / 4;
+    int partPatches = patches.x * patches.y;
+    int local = patchIndex % partPatches;
+    controlPart = patchIndex / partPatches;
+    controlDomain = (vec2(local % patches.x, local / patches.x) + PATCH_CORNERS[gl_VertexID % 4]) / vec2(patches);
+    controlInstance = gl_InstanceID;
+
+    vec4 instancePosition = vec4(surfacePosition(controlPart, controlDomain), 1.0f);
+    if (useInstanceTransforms) {
+        instancePosition = instances[gl_InstanceID].transform * instancePosition;
+    }
+    controlClipPosition = objects[objectIndex].modelViewProjection * instancePosition;
+}